@@ -0,0 +1,77 @@
+#include <chipset.h>
+#include <interrupt.h>
+#include <klog.h>
+#include <semihosting.h>
+#include <stdio.h>
+#include <vm2.h>
+
+// Stand-ins for the parts of the kernel the host build doesn't compile. This file is compiled
+// against the kernel headers, the functions that need Linux are in linux.c.
+
+// From linux.c
+void host_write(const char * data, size_t length);
+void * host_map_page(size_t address);
+void host_unmap_page(size_t address);
+void host_exit(int code) __attribute__((noreturn));
+bool host_get_cmdline(char * buffer, size_t size);
+
+struct L1PageTable * kernell1PageTable = NULL;
+
+// Kernel virtual addresses are used as they are, the heap is mapped at KERNEL_HEAP_BASE.
+void * vm2_allocate_page(struct L1PageTable * l1pt,
+                         size_t virtual,
+                         bool remap,
+                         struct PagePermission perms,
+                         struct L2PageTable ** created_l2pt) {
+    if (created_l2pt != NULL) { *created_l2pt = NULL; }
+    return host_map_page(virtual & ~(size_t)(PAGE_SIZE - 1));
+}
+
+void vm2_free_page(struct L1PageTable * l1pt, size_t virtual) {
+    host_unmap_page(virtual & ~(size_t)(PAGE_SIZE - 1));
+}
+
+static void host_uart_putc(char c, int uartchannel) {
+    host_write(&c, 1);
+}
+
+static void host_uart_write(const char * data, size_t length, int uartchannel) {
+    host_write(data, length);
+}
+
+static void host_uart_flush() {}
+
+ChipsetInterface chipset = {
+    .uart_putc = host_uart_putc,
+    .uart_write = host_uart_write,
+    .uart_flush = host_uart_flush,
+};
+
+// There is no binary log, everything is printed right away
+void klog_drain() {}
+
+// Nothing interrupts the host build
+void enable_interrupt(InterruptType type) {}
+
+void disable_interrupt(InterruptType type) {}
+
+int enable_interrupt_save(InterruptType type) {
+    return 0;
+}
+
+int disable_interrupt_save(InterruptType type) {
+    return 0;
+}
+
+void SemihostingCall(enum SemihostingSWI mode) {
+    host_exit(mode == ApplicationExit ? 0 : 1);
+}
+
+void SemihostingOSExit(uint8_t code) {
+    host_exit(code);
+}
+
+// The command line of the test program, see bootargs.h
+bool semihosting_get_cmdline(char * buffer, size_t size) {
+    return host_get_cmdline(buffer, size);
+}
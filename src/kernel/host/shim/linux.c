@@ -0,0 +1,93 @@
+#define _GNU_SOURCE
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// The Linux side of the host build. Compiled against the C library instead of klibc, so it only
+// talks to kernel code through the prototypes below.
+
+#define HOST_PAGE_SIZE 0x1000
+
+// From the kernel
+void init_heap();
+void bootargs_init(const uint32_t * atags);
+void test_main();
+
+static int host_argc;
+static char ** host_argv;
+
+void host_write(const char * data, size_t length) {
+    while (length > 0) {
+        const ssize_t written = write(STDOUT_FILENO, data, length);
+        if (written <= 0) { return; }
+        data += written;
+        length -= written;
+    }
+}
+
+// Maps a page at exactly this address, or returns NULL if that isn't possible (for instance
+// because something is mapped there already).
+void * host_map_page(size_t address) {
+    void * page = mmap((void *)address,
+                       HOST_PAGE_SIZE,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+                       -1,
+                       0);
+    if (page == MAP_FAILED) { return NULL; }
+    if (page != (void *)address) {
+        // Older kernels treat MAP_FIXED_NOREPLACE as a hint
+        munmap(page, HOST_PAGE_SIZE);
+        return NULL;
+    }
+    return page;
+}
+
+void host_unmap_page(size_t address) {
+    munmap((void *)address, HOST_PAGE_SIZE);
+}
+
+// The arguments of the program separated by spaces, like qemu's semihosting command line
+bool host_get_cmdline(char * buffer, size_t size) {
+    size_t length = 0;
+    for (int i = 0; i < host_argc; i++) {
+        const size_t argument_length = strlen(host_argv[i]);
+        if (length + argument_length + 1 > size) { return false; }
+        if (i > 0) { buffer[length - 1] = ' '; }
+        memcpy(buffer + length, host_argv[i], argument_length + 1);
+        length += argument_length + 1;
+    }
+    if (length == 0 && size > 0) { buffer[0] = '\0'; }
+    return true;
+}
+
+void host_exit(int code) {
+    exit(code);
+}
+
+// Nanoseconds, see bench.h
+uint64_t bench_counter() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+uint32_t bench_counter_frequency() {
+    return 1000000000u;
+}
+
+int main(int argc, char ** argv) {
+    host_argc = argc;
+    host_argv = argv;
+
+    init_heap();
+    // For the tests= parameter
+    bootargs_init(NULL);
+    // Exits through SemihostingCall once every test passed, returns if one failed
+    test_main();
+    return 1;
+}
@@ -20,7 +20,7 @@ uint32_t overhead = sizeof(footer_t) + sizeof(node_t);
 void create_heap(heap_t * heap, uint32_t start) {
     // first we create the initial region, this is the "wilderness" chunk
     // the heap starts as just one big chunk of allocatable memory
-    node_t * init_region = (node_t *)start;
+    node_t * init_region = (node_t *)(uintptr_t)start;
     init_region->hole = 1;
     init_region->size = (HEAP_INIT_SIZE) - sizeof(node_t) - sizeof(footer_t);
 
@@ -34,6 +34,7 @@ void create_heap(heap_t * heap, uint32_t start) {
 
 #ifdef MEM_DEBUG
     heap->bytes_allocated = 0;
+    heap->bytes_allocated_peak = 0;
 #endif
 }
 
@@ -45,6 +46,8 @@ void create_heap(heap_t * heap, uint32_t start) {
 // if neccesary and return the start of the chunk
 // ========================================================
 void * heap_alloc(heap_t * heap, uint32_t size) {
+    size = (size + ALLOC_ALIGNMENT - 1) & ~(ALLOC_ALIGNMENT - 1);
+
     // first get the bin index that this chunk size should be in
     int index = get_bin_index(size);
     // now use this bin to try and find a good fitting chunk!
@@ -106,6 +109,9 @@ void * heap_alloc(heap_t * heap, uint32_t size) {
 
 #ifdef MEM_DEBUG
     heap->bytes_allocated += found->size;
+    if (heap->bytes_allocated > heap->bytes_allocated_peak) {
+        heap->bytes_allocated_peak = heap->bytes_allocated;
+    }
     TRACE("[MEM DEBUG] ALLOC %i bytes at 0x%x", found->size, &found->next);
 #endif
 
@@ -239,7 +245,7 @@ footer_t * get_foot(node_t * node) {
 // heap because that is always the wilderness
 // ========================================================
 node_t * get_wilderness(heap_t * heap) {
-    footer_t * wild_foot = (footer_t *)((char *)heap->end - sizeof(footer_t));
+    footer_t * wild_foot = (footer_t *)((uintptr_t)heap->end - sizeof(footer_t));
     return wild_foot->header;
 }
 
@@ -10,6 +10,8 @@
 #define HEAP_MIN_SIZE  0x10000
 
 #define MIN_ALLOC_SZ 4
+/// Allocation sizes are rounded up to a multiple of this, so every node stays aligned.
+#define ALLOC_ALIGNMENT sizeof(struct node_t *)
 
 #define MIN_WILDERNESS 0x2000
 #define MAX_WILDERNESS 0x1000000
@@ -41,6 +43,8 @@ typedef struct {
 
 #ifdef MEM_DEBUG
     size_t bytes_allocated;
+    /// Highest bytes_allocated since the last reset (the test runner resets it for every test)
+    size_t bytes_allocated_peak;
 #endif
 } heap_t;
 
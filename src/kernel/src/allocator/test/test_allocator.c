@@ -40,7 +40,7 @@ TEST_CREATE(test_expand_heap, {
 
     ASSERT_EQ(heap->end, initial_end + 0x1000);
 
-    uint8_t * yolo = (void *)(heap->end - 300);
+    uint8_t * yolo = (void *)(uintptr_t)(heap->end - 300);
     uint8_t prev = *yolo;
     *yolo = 42;
     ASSERT_EQ(*yolo, 42);
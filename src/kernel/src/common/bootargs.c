@@ -0,0 +1,68 @@
+#include <bootargs.h>
+#include <semihosting.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// Each tag starts with its size in words (including this header) and its type
+#define ATAG_SIZE(tag) ((tag)[0])
+#define ATAG_TYPE(tag) ((tag)[1])
+// More tags than the bootloader ever passes, so a bogus list can't make us walk forever
+#define ATAG_MAX_TAGS 64
+
+static char cmdline[BOOTARGS_MAX_LENGTH];
+
+static void set_cmdline(const char * s) {
+    const size_t length = strnlen(s, BOOTARGS_MAX_LENGTH - 1);
+    memcpy(cmdline, s, length);
+    cmdline[length] = '\0';
+}
+
+// Returns whether the list had a command line
+static bool read_atags(const uint32_t * tag) {
+    // Anything else, like a device tree, isn't supported
+    if (tag == NULL || ATAG_TYPE(tag) != ATAG_CORE) { return false; }
+
+    for (uint32_t i = 0; i < ATAG_MAX_TAGS && ATAG_SIZE(tag) != 0; i++) {
+        if (ATAG_TYPE(tag) == ATAG_NONE) { break; }
+        if (ATAG_TYPE(tag) == ATAG_CMDLINE) {
+            set_cmdline((const char *)&tag[2]);
+            return true;
+        }
+        tag += ATAG_SIZE(tag);
+    }
+    return false;
+}
+
+void bootargs_init(const uint32_t * atags) {
+    cmdline[0] = '\0';
+    if (read_atags(atags)) { return; }
+
+#ifdef ENABLE_TESTS
+    // Tests always run in qemu with semihosting
+    if (!semihosting_get_cmdline(cmdline, sizeof(cmdline))) { cmdline[0] = '\0'; }
+#endif
+}
+
+const char * bootargs_cmdline() {
+    return cmdline;
+}
+
+const char * bootargs_get(const char * key, size_t * length) {
+    const size_t key_length = strlen((char *)key);
+
+    for (const char * word = cmdline; *word != '\0';) {
+        size_t word_length = 0;
+        while (word[word_length] != '\0' && word[word_length] != ' ') { word_length++; }
+
+        if (word_length > key_length && word[key_length] == '=' &&
+            memcmp(word, key, key_length) == 0) {
+            *length = word_length - key_length - 1;
+            return word + key_length + 1;
+        }
+
+        word += word_length;
+        while (*word == ' ') { word++; }
+    }
+    return NULL;
+}
@@ -31,8 +31,11 @@ void init_hardwareinfo() {
     BoardType boardType = detect_boardtype();
     size_t peripheral_base_address;
     size_t peripheral_region_size;
+    CpuType cpuType;
     switch (boardType) {
         case RaspBerryPiTwo:
+            // Part number 0xC07
+            cpuType = CortexA7;
             peripheral_base_address = BCM2836_PERIPHERALS_PHYSICAL_BASE;
             peripheral_region_size = 21 * Mebibyte;
             break;
@@ -40,7 +43,7 @@ void init_hardwareinfo() {
             FATAL("Peripheral address for board type not implemented");
     }
     hardware_info = (HardwareInfo){
-        .cpuType = ARM1176,
+        .cpuType = cpuType,
         .boardType = boardType,
         .peripheral_base_address = peripheral_base_address,
 	.peripheral_region_size = peripheral_region_size,
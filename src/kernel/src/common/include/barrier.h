@@ -0,0 +1,26 @@
+#ifndef BARRIER_H
+#define BARRIER_H
+
+/// Memory and instruction barriers.
+///
+/// C code is compiled for ARMv6, which doesn't have the DMB, DSB and ISB instructions yet. These
+/// use the equivalent CP15 operations instead, which the Cortex-A7 still implements. All of them
+/// are compiler barriers as well.
+
+/// Data memory barrier: memory accesses before it are observed before the ones after it.
+static inline void dmb() {
+    asm volatile("mcr p15, 0, %0, c7, c10, 5" ::"r"(0) : "memory");
+}
+
+/// Data synchronization barrier: waits until all memory accesses before it have completed.
+static inline void dsb() {
+    asm volatile("mcr p15, 0, %0, c7, c10, 4" ::"r"(0) : "memory");
+}
+
+/// Instruction synchronization barrier: instructions after it are fetched again, so they see the
+/// effect of earlier system register writes.
+static inline void isb() {
+    asm volatile("mcr p15, 0, %0, c7, c5, 4" ::"r"(0) : "memory");
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef BOOTARGS_H
+#define BOOTARGS_H
+
+#include <stdint.h>
+
+/// The kernel command line, a list of words separated by spaces. Words of the form `key=value` are
+/// parameters, for example `tests=path_,hashmap` (see test.h).
+///
+/// The command line comes from the ATAG list the bootloader passes. When the kernel runs its tests
+/// in qemu, which passes no ATAGs to an ELF kernel, it is asked for through semihosting instead.
+
+/// Types of the ATAGs that are read. The list starts with ATAG_CORE and ends with ATAG_NONE.
+#define ATAG_NONE    0x00000000
+#define ATAG_CORE    0x54410001
+#define ATAG_CMDLINE 0x54410009
+
+/// The longest command line that is kept, longer ones are cut off.
+#define BOOTARGS_MAX_LENGTH 256
+
+/// Reads the command line. atags is the (virtual) address of the ATAG list, or NULL.
+void bootargs_init(const uint32_t * atags);
+
+/// The whole command line. Empty if there was none.
+const char * bootargs_cmdline();
+
+/// Finds parameter `key=value`. Returns the start of its value, which ends at the next space or
+/// the end of the command line, and stores its length in *length. Returns NULL if there is no such
+/// parameter.
+const char * bootargs_get(const char * key, size_t * length);
+
+#endif
@@ -67,13 +67,37 @@ extern void _Reset();
 
 void reset_handler(void);
 
-void __attribute__((interrupt("UNDEF"))) undef_instruction_handler();  // 0x04
-long __attribute__((interrupt("SWI"))) software_interrupt_handler();   // 0x08
-void __attribute__((interrupt("ABORT"))) prefetch_abort_handler();     // 0x0c
-void __attribute__((interrupt("ABORT"))) data_abort_handler();         // 0x10
-void reserved_handler();                                               // 0x14
-void __attribute__((interrupt("IRQ"))) irq_handler();                  // 0x18
-void __attribute__((interrupt("FIQ"))) fiq_handler();                  // 0x1c
+// The ARM interrupt attribute, which the host build (see host/README.md) doesn't have
+#ifdef __arm__
+    #define ARM_INTERRUPT(type) __attribute__((interrupt(type)))
+#else
+    #define ARM_INTERRUPT(type)
+#endif
+
+void ARM_INTERRUPT("UNDEF") undef_instruction_handler();  // 0x04
+void software_interrupt_entry();                          // 0x08
+void ARM_INTERRUPT("ABORT") prefetch_abort_handler();     // 0x0c
+void data_abort_entry();                                  // 0x10
+void reserved_handler();                                  // 0x14
+void irq_entry();                                         // 0x18
+void ARM_INTERRUPT("FIQ") fiq_handler();                  // 0x1c
+
+/// The registers saved by data_abort_entry (see vectors.s) before it calls data_abort_handler.
+/// pc is the address of the faulting instruction. Changing it changes where execution resumes
+/// once the handler returns.
+struct AbortFrame {
+    uint32_t r0;
+    uint32_t r1;
+    uint32_t r2;
+    uint32_t r3;
+    uint32_t r12;
+    uint32_t pc;
+};
+
+void data_abort_handler(struct AbortFrame * frame);
+
+/// Called by irq_entry (see vectors.s) in SVC mode with interrupts disabled.
+void irq_handler();
 
 /**
  * Semihosting calls
@@ -106,5 +130,7 @@ void enable_interrupt(InterruptType);
 int enable_interrupt_save(InterruptType);
 void disable_interrupt(InterruptType);
 int disable_interrupt_save(InterruptType);
+size_t get_proc_status();
+void restore_proc_status(size_t cpsr);
 
 #endif
@@ -0,0 +1,72 @@
+#ifndef KTIME_H
+#define KTIME_H
+
+#include <barrier.h>
+#include <stdint.h>
+
+/// Monotonic time from the physical counter of the ARM generic timer (CNTPCT).
+///
+/// Counts are converted to nanoseconds and back with a multiplication and a shift, the factors are
+/// computed once in [ktime_init], so no division is needed. The factors are published in a read
+/// only page which is mapped into every process at KTIME_PAGE_USER_ADDRESS. User mode is allowed
+/// to read the counter (CNTKCTL.PL0PCTEN), so it can compute the time the same way as
+/// [ktime_get_ns] without a syscall.
+
+/// The last page of user space
+#define KTIME_PAGE_USER_ADDRESS 0x7ffff000
+
+#define KTIME_PAGE_VERSION 1
+
+/// Contents of the time page. Never changes after boot.
+struct KtimePage {
+    uint32_t version;
+    /// Counter frequency in Hz
+    uint32_t frequency;
+    /// ns = (counts * ns_mult) >> ns_shift
+    uint32_t ns_mult;
+    uint32_t ns_shift;
+    /// counts = (ns * counts_mult) >> counts_shift
+    uint32_t counts_mult;
+    uint32_t counts_shift;
+};
+
+/// The time page in the kernel, NULL before ktime_init.
+extern struct KtimePage * ktime_page;
+
+/// Computes the conversion factors, allows user mode to read the counter and sets up the time page.
+/// Needs the physical memory manager.
+void ktime_init();
+
+/// (value * mult) >> shift with a 96 bit intermediate result, shift must be at most 32.
+static inline uint64_t ktime_mul_shift(uint64_t value, uint32_t mult, uint32_t shift) {
+    const uint64_t low = (uint64_t)(uint32_t)value * mult;
+    const uint64_t high = (value >> 32u) * mult;
+    return (high << (32u - shift)) + (low >> shift);
+}
+
+/// Reads CNTPCT
+static inline uint64_t ktime_get_counts() {
+    uint32_t low, high;
+    isb();
+    asm volatile("mrrc p15, 0, %0, %1, c14" : "=r"(low), "=r"(high));
+    return ((uint64_t)high << 32u) | low;
+}
+
+static inline uint64_t ktime_counts_to_ns(uint64_t counts) {
+    return ktime_mul_shift(counts, ktime_page->ns_mult, ktime_page->ns_shift);
+}
+
+static inline uint64_t ktime_to_counts(uint64_t ns) {
+    return ktime_mul_shift(ns, ktime_page->counts_mult, ktime_page->counts_shift);
+}
+
+static inline uint64_t ktime_ms_to_counts(uint32_t ms) {
+    return ktime_to_counts((uint64_t)ms * 1000000u);
+}
+
+/// Nanoseconds since the counter started
+static inline uint64_t ktime_get_ns() {
+    return ktime_counts_to_ns(ktime_get_counts());
+}
+
+#endif
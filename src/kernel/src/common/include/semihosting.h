@@ -0,0 +1,57 @@
+#ifndef SEMIHOSTING_H
+#define SEMIHOSTING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Semihosting I/O. Lets the kernel use the console and files of the host when it runs in qemu
+/// with -semihosting (the make run and test rules pass it). Every call is one trap into qemu, so
+/// writing a whole buffer is much faster than writing it to the emulated uart byte by byte.
+/// ARM Docs: https://developer.arm.com/documentation/dui0471/m/what-is-semihosting-
+///
+/// When the kernel is built with SEMIHOSTING_CONSOLE, console output (uart channel 0) goes through
+/// semihosting. Input still comes from the uart.
+
+enum SemihostingOperation {
+    SEMIHOSTING_SYS_OPEN = 0x01,
+    SEMIHOSTING_SYS_CLOSE = 0x02,
+    SEMIHOSTING_SYS_WRITEC = 0x03,
+    SEMIHOSTING_SYS_WRITE0 = 0x04,
+    SEMIHOSTING_SYS_WRITE = 0x05,
+    SEMIHOSTING_SYS_GET_CMDLINE = 0x15,
+};
+
+/// The fopen modes, in the encoding SYS_OPEN uses
+enum SemihostingOpenMode {
+    SEMIHOSTING_OPEN_READ = 0,    // "r"
+    SEMIHOSTING_OPEN_WRITE = 4,   // "w"
+    SEMIHOSTING_OPEN_APPEND = 8,  // "a"
+};
+
+/// The file name that opens the console of the host
+#define SEMIHOSTING_CONSOLE_NAME ":tt"
+
+/// Opens a file on the host, relative to the directory qemu was started in. Returns a handle, or
+/// -1 on failure.
+int semihosting_open(const char * path, enum SemihostingOpenMode mode);
+
+void semihosting_close(int handle);
+
+/// Writes a whole buffer to a file. Returns false if not everything could be written.
+bool semihosting_write(int handle, const void * data, size_t length);
+
+/// Opens a file, appends data to it and closes it again. Returns false on failure.
+bool semihosting_append(const char * path, const void * data, size_t length);
+
+/// Writes a null terminated string to the console of the host.
+void semihosting_write0(const char * s);
+
+/// Copies the command line qemu was given for the kernel into buffer, null terminated. Without
+/// `-semihosting-config arg=...` that is the kernel's file name followed by the -append string.
+/// Returns false if it doesn't fit.
+bool semihosting_get_cmdline(char * buffer, size_t size);
+
+/// Sends console output through semihosting from now on.
+void semihosting_console_init();
+
+#endif
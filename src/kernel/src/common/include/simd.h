@@ -0,0 +1,48 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Kernel mode use of the VFP/NEON unit.
+///
+/// The kernel is compiled for soft float, so C code never touches the VFP/NEON registers. Only
+/// kernel mode may use the unit: user mode has no access to it, so a VFP or NEON instruction in a
+/// user process is undefined. The kernel doesn't save or restore VFP registers on context
+/// switches, which has to change before user mode may use the unit.
+///
+/// Kernel code that wants to use NEON brackets it with [kernel_simd_begin] and [kernel_simd_end],
+/// which turn the unit on and off again. The bracketed section must not be interrupted by another
+/// user of the unit. Code that may run in an interrupt handler checks [kernel_simd_usable] and uses
+/// a scalar version otherwise, which is what the page and checksum routines below do.
+
+/// Gives kernel mode access to the VFP/NEON unit and detects whether NEON is present.
+void simd_init();
+
+/// Whether the cpu has NEON. Without it every routine here takes its scalar path.
+bool simd_present();
+
+/// Whether kernel_simd_begin may be called here: NEON is present and not already in use by the
+/// code this interrupted.
+bool kernel_simd_usable();
+
+/// Turns the unit on for the kernel. Sections don't nest.
+void kernel_simd_begin();
+
+/// Turns the unit off again. The kernel's register contents are lost.
+void kernel_simd_end();
+
+/// Fills a page (PAGE_SIZE bytes, page aligned) with zeros.
+void page_clear(void * page);
+
+/// Copies a page to another page.
+void page_copy(void * dest, const void * src);
+
+/// Internet checksum (RFC 1071) of length bytes: the ones' complement of the ones' complement sum
+/// of the 16 bit words, in the byte order of the cpu. An odd last byte is padded with a zero.
+uint16_t checksum(const void * data, size_t length);
+
+/// Checksum of a page.
+uint16_t page_checksum(const void * page);
+
+#endif
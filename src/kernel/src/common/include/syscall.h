@@ -0,0 +1,53 @@
+#ifndef SYSCALL_H
+#define SYSCALL_H
+
+#include <interrupt.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/// System call dispatch.
+///
+/// software_interrupt_entry (see [vectors.s](../vectors.s)) saves the registers of the caller as a
+/// [TrapFrame] on the SVC stack and passes it to [syscall_dispatch]. The syscall number is taken
+/// from r7 and looked up in a constant table, the arguments are r0-r3 and the return value is
+/// written back to the saved r0. Nothing is printed on this path.
+///
+/// When the kernel is built with the SYSCALL_TRACE definition every syscall is also recorded in a
+/// small ring buffer which can be printed with [syscall_trace_dump].
+
+/// One more than the highest syscall number
+#define NR_SYSCALLS (SYSCALL_PAUSE + 1)
+
+/// The registers saved by software_interrupt_entry. pc is the address the syscall returns to.
+struct TrapFrame {
+    uint32_t r[13];
+    uint32_t pc;
+};
+
+typedef long (*SyscallHandler)(uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+
+struct SyscallEntry {
+    /// NULL for syscalls that are known but not implemented (yet)
+    SyscallHandler handler;
+    const char * name;
+};
+
+/// Called by software_interrupt_entry
+void syscall_dispatch(struct TrapFrame * frame);
+
+#define SYSCALL_TRACE_SIZE 64
+
+struct SyscallTraceEntry {
+    uint32_t number;
+    uint32_t args[4];
+    long result;
+};
+
+/// Prints the most recent syscalls (oldest first). Does nothing without SYSCALL_TRACE.
+void syscall_trace_dump();
+
+/// Copies up to n of the most recent trace entries (oldest first) into out and returns how many
+/// were copied. Always 0 without SYSCALL_TRACE.
+size_t syscall_trace_read(struct SyscallTraceEntry * out, size_t n);
+
+#endif
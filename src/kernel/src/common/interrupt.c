@@ -1,17 +1,15 @@
 #include <chipset.h>
 #include <interrupt.h>
+#include <irq.h>
 #include <mmio.h>
 #include <stdio.h>
+#include <uaccess.h>
 #include <vm2.h>
 
 /* copy vector table from wherever QEMU loads the kernel to 0x00 */
 void init_vector_table() {
-    // allocate space for the IVR at the high vector location.
-    vm2_allocate_page(kernell1PageTable,
-                      HIGH_VECTOR_LOCATION,
-                      false,
-                      (struct PagePermission){.access = KernelRW, .executable = true},
-                      NULL);
+    // The page at the high vector location is already mapped by the generated kernel pagetable
+    // (see boot_pagetable.s).
 
     /* Primary Vector Table */
     mmio_write(HIGH_VECTOR_LOCATION + 0x00, BRANCH_INSTRUCTION);
@@ -26,18 +24,18 @@ void init_vector_table() {
     /* Secondary Vector Table */
     mmio_write(HIGH_VECTOR_LOCATION + 0x20, &reset_handler);
     mmio_write(HIGH_VECTOR_LOCATION + 0x24, &undef_instruction_handler);
-    mmio_write(HIGH_VECTOR_LOCATION + 0x28, &software_interrupt_handler);
+    mmio_write(HIGH_VECTOR_LOCATION + 0x28, &software_interrupt_entry);
     mmio_write(HIGH_VECTOR_LOCATION + 0x2C, &prefetch_abort_handler);
-    mmio_write(HIGH_VECTOR_LOCATION + 0x30, &data_abort_handler);
+    mmio_write(HIGH_VECTOR_LOCATION + 0x30, &data_abort_entry);
     mmio_write(HIGH_VECTOR_LOCATION + 0x34, &reserved_handler);
-    mmio_write(HIGH_VECTOR_LOCATION + 0x38, &irq_handler);
+    mmio_write(HIGH_VECTOR_LOCATION + 0x38, &irq_entry);
     mmio_write(HIGH_VECTOR_LOCATION + 0x3C, &fiq_handler);
 
     /// Enable high vectors (Vectors located at HIGH_VECTOR_LOCATION).
-    asm volatile("mrc p15, 0, r1, c1, c0, 0 \n"  // Read p15
-                 "orr r1, %0\n"                  // Enable High Vector bit
-                 "mcr p15, 0, r1, c1, c0, 0\n"   // Set p15
-                 ::"r"(1u << 13u));
+    uint32_t sctlr;
+    asm volatile("mrc p15, 0, %0, c1, c0, 0" : "=r"(sctlr));  // Read p15
+    sctlr |= 1u << 13u;                                      // Enable High Vector bit
+    asm volatile("mcr p15, 0, %0, c1, c0, 0" ::"r"(sctlr));   // Set p15
 }
 
 /* handlers */
@@ -50,7 +48,7 @@ void __attribute__((interrupt("UNDEF"))) undef_instruction_handler() {
     size_t spsr, lr;
 
     asm volatile("mrs %0, spsr" : "=r"(spsr));
-    asm volatile("mov %0, lr" : "=r"(lr));
+    lr = (size_t)__builtin_return_address(0);
 
     size_t thumb = spsr & 0x20u;
     size_t pc = thumb ? lr - 0x2u : lr - 0x4u;
@@ -76,169 +74,78 @@ void __attribute__((interrupt("UNDEF"))) undef_instruction_handler() {
     FATAL("UNDEFINED INSTRUCTION HANDLER");
 }
 
-long __attribute__((interrupt("SWI"))) software_interrupt_handler(void) {
-    int callNumber = 0, r0 = 0, r1 = 0, r2 = 0, r3 = 0;
-
-    asm volatile("MOV %0, r7" : "=r"(callNumber)::);
-    asm volatile("MOV %0, r0" : "=r"(r0)::);
-    asm volatile("MOV %0, r1" : "=r"(r1)::);
-    asm volatile("MOV %0, r2" : "=r"(r2)::);
-    asm volatile("MOV %0, r3" : "=r"(r3)::);
-
-    kprintf("SOFTWARE INTERRUPT HANDLER\n");
-
-    // Print out syscall # for debug purposes
-    kprintf("Syscall #: ");
-    kprintf("%d\n", callNumber);
-    kprintf("arg0=%d\n", r0);
-    kprintf("arg1=%d\n", r1);
-    kprintf("arg2=%d\n", r2);
-    kprintf("arg3=%d\n", r3);
-    kprintf("\n");
-
-    // System Call Handler
-    switch (callNumber) {
-        case SYSCALL_EXIT:
-            // TODO: remove current process from scheduler
-            for (;;)
-                ;
-            break;
-        case SYSCALL_DUMMY:
-            return 0L;
-            break;
-
-        // NOTE: All FS syscalls have been *DISABLED* until the filesystem works again.
-        case SYSCALL_CREATE:
-            kprintf("Create system call called!\n");
-            return -1;
-
-            //		return (long) kcreate((char*) r0, r1, 0);
-        case SYSCALL_DELETE:
-            kprintf("Delete system call called!\n");
-            return -1;
-
-            //		return (long) kdelete((char*) r0, 1);
-        case SYSCALL_OPEN:
-            kprintf("Open system call called!\n");
-            return -1;
-
-            //		return (long) kopen((char*) r0, r1);
-        case SYSCALL_MKDIR:
-            kprintf("Mkdir system call called!\n");
-            return -1;
-
-            //		return (long) kcreate((char*) r0, 'w', 1);
-        case SYSCALL_READ:
-            kprintf("Read system call called!\n");
-            return -1;
-
-            //		return (long) kread(r0, (void*) r1, r2);
-        case SYSCALL_WRITE:
-            kprintf("Write system call called!\n");
-            return -1;
-
-            //		return (long) kwrite(r0, (void*) r1, r2);
-        case SYSCALL_CLOSE:
-            kprintf("Close system call called!\n");
-            return -1;
-
-            //		return (long) kclose(r0);
-        case SYSCALL_SEEK:
-            kprintf("Seek system call called!\n");
-            return -1;
-
-            //		return (long) kseek(r0, r1);
-        case SYSCALL_COPY:
-            kprintf("Copy system call called!\n");
-            return -1;
-
-            //		return (long) kcopy((char*) r0, (char*) r1, r2);
-        case SYSCALL_LS:
-            kprintf("Ls system call called!\n");
-            return -1;
-            //		return (long) kls((char*) r0);
-        case SYSCALL_SET_PERM:
-            kprintf("Set permission system call called!\n");
-            kprintf("Yet to be implemented\n");
-            return -1;
-        case SYSCALL_MEM_MAP:
-            kprintf("Memory map system call called!\n");
-            kprintf("Yet to be implemented\n");
-            return -1;
-
-        case SYSCALL_PRINTF:
-            kprintf("Printf system call called!\n");
-
-            kprintf((const char *)r0);
-            return 0L;
-        default:
-            kprintf("That wasn't a syscall you knob!\n");
-            return -1L;
-    }
-}
-
 void __attribute__((interrupt("ABORT"))) prefetch_abort_handler(void) {
-    size_t lr;
-    asm volatile("mov %0, lr" : "=r"(lr));
+    // With optimizations lr may already be reused when an asm statement reads it
+    const size_t lr = (size_t)__builtin_return_address(0);
+
+    // Instruction fetches from a page that was aged also fault on the access flag.
+    // The handler returns to the faulting instruction, so fixing the flag is enough.
+    uint32_t ifsr, ifar;
+    asm volatile("mrc p15, 0, %0, c5, c0, 1" : "=r"(ifsr));
+    asm volatile("mrc p15, 0, %0, c6, c0, 2" : "=r"(ifar));
+    if (FSR_STATUS(ifsr) == FSR_ACCESS_FLAG_SECTION || FSR_STATUS(ifsr) == FSR_ACCESS_FLAG_PAGE) {
+        if (vm2_handle_access_flag_fault(ifar)) { return; }
+    }
 
     FATAL("PREFETCH ABORT HANDLER, violating address: 0x%x", (lr - 4u));
 }
 
-void __attribute__((interrupt("ABORT"))) data_abort_handler(void) {
+void data_abort_handler(struct AbortFrame * frame) {
     // TODO Check if the address is valid according to the kernel and add it to the currently loaded
     // pagetables if so.
 
-    int lr;
-    asm volatile("mov %0, lr" : "=r"(lr));
-    int pc = lr - 8;
-
     uint32_t far;
     asm volatile("mrc p15, 0, %0, c6, c0, 0" : "=r"(far));
 
+    // Get the Data Fault Status Register
+    int dfsr;
+    asm volatile("MRC p15, 0, %0, c5, c0, 0" : "=r"(dfsr));
+
+    // An access flag fault means the page was aged since it was last used. Mark it accessed again
+    // and retry the instruction.
+    if (FSR_STATUS(dfsr) == FSR_ACCESS_FLAG_SECTION || FSR_STATUS(dfsr) == FSR_ACCESS_FLAG_PAGE) {
+        if (vm2_handle_access_flag_fault(far)) { return; }
+    }
+
+    // Faults in the user access routines are expected, they turn into an error return.
+    size_t fixup = search_exception_table(frame->pc);
+    if (fixup != 0) {
+        frame->pc = fixup;
+        return;
+    }
+
+    size_t pc = frame->pc;
+
     WARN("DATA ABORT HANDLER (Page Fault)");
     WARN("faulting address: 0x%x", far);
     if (far >= KERNEL_VIRTUAL_OFFSET) { DEBUG("(address is in kernel address range)"); }
     WARN("violating instruction (at 0x%x): 0x%x", pc, *((int *)pc));
 
-    // Get the Data Fault Status Register
-    int dfsr;
-    asm volatile("MRC p15, 0, %0, c5, c0, 0" : "=r"(dfsr));
     WARN("DFSR: 0x%x", dfsr);
 
 
 #ifdef ENABLE_TESTS
     FATAL("Data abort is disallowed in tests");
 #endif
+
+    // Skip the violating instruction.
+    frame->pc += 4;
 }
 
 void reserved_handler(void) {
     INFO("RESERVED HANDLER\n");
 }
 
-// the attribute automatically saves and restores state
-// TODO: We might not want that! (context switches etc)
-void __attribute__((interrupt("IRQ"))) irq_handler(void) {
-    DEBUG("IRQ HANDLER");
-    return chipset.handle_irq();
-
-    //    int * pendingregister = (int *) 0x40000060;
-    //	int cpsr = disable_interrupt_save(IRQ);
-
-    // os_printf("disabled CSPR:%X\n",cpsr);
-    // Discover source of interrupt
-    // do a straight run through the VIC_INT_STATUS to determine
-    // which interrupt lines need to be tended to
-    //	for (int i = 0; i < MAX_NUM_INTERRUPTS; i++) {
-    //		// is the line active?
-    //		if ((1 << i) & mmio_read(&interrupt_registers->irq_basic_pending)) {
-    //			// activate that specific handler
-    //			handle_irq_interrupt(i);
-    //		}
-    //	}
-    // we've gone through the VIC and handled all active interrupts
-    // restore_proc_status(cpsr);
-
-    //	enable_interrupt(IRQ_MASK);
+void irq_handler(void) {
+    irq_enter();
+
+    // Top half: the chipset acknowledges the devices and runs their irq handlers.
+    chipset.handle_irq();
+
+    irq_exit();
+
+    // Bottom half: deferred work, with interrupts enabled again.
+    softirq_run();
 }
 
 void __attribute__((interrupt("FIQ"))) fiq_handler(void) {
@@ -253,12 +160,12 @@ void __attribute__((interrupt("FIQ"))) fiq_handler(void) {
 }
 
 void __attribute__((always_inline)) inline SemihostingCall(enum SemihostingSWI mode) {
-    int a = mode;
-    asm volatile("MOV r0, #0x18\n"
-                 "LDR r1, %[in0]\n"
-                 "svc 0x00123456\n"
-                 :
-                 : [in0] "m"(a));
+    // Buffered console output would be lost otherwise
+    chipset.uart_flush();
+
+    register uint32_t r0 asm("r0") = 0x18;
+    register uint32_t r1 asm("r1") = mode;
+    asm volatile("svc 0x00123456" : "+r"(r0) : "r"(r1) : "memory");
 }
 
 
@@ -271,9 +178,11 @@ void __attribute__((always_inline)) inline SemihostingOSExit(uint8_t code) {
         uint32_t f2;
     } parameters = {ApplicationExit, code};
 
-    asm volatile("MOV r0, #0x20\n"
-                 "mov r1, %[in0]\n"
-                 "svc 0x00123456\n" ::[in0] "r"(&parameters));
+    chipset.uart_flush();
+
+    register uint32_t r0 asm("r0") = 0x20;
+    register void * r1 asm("r1") = &parameters;
+    asm volatile("svc 0x00123456" : "+r"(r0) : "r"(r1) : "memory");
 
     __builtin_unreachable();
 }
@@ -285,13 +194,13 @@ void enable_interrupt(InterruptType mask) {
     // enable interrupt on the core
     switch (mask) {
         case IRQ:
-            asm volatile("cpsie i");
+            asm volatile("cpsie i" ::: "memory");
             break;
         case FIQ:
-            asm volatile("cpsie f");
+            asm volatile("cpsie f" ::: "memory");
             break;
         case BOTH:
-            asm volatile("cpsie if");
+            asm volatile("cpsie if" ::: "memory");
             break;
         default:
             /** should never happen **/
@@ -306,13 +215,13 @@ void disable_interrupt(InterruptType mask) {
     // disable interrupts on the core
     switch (mask) {
         case IRQ:
-            asm volatile("cpsid i");
+            asm volatile("cpsid i" ::: "memory");
             break;
         case FIQ:
-            asm volatile("cpsid f");
+            asm volatile("cpsid f" ::: "memory");
             break;
         case BOTH:
-            asm volatile("cpsid if");
+            asm volatile("cpsid if" ::: "memory");
             break;
         default:
             /** should never happen **/
@@ -330,13 +239,13 @@ int disable_interrupt_save(InterruptType mask) {
     // disable interrupts on the core
     switch (mask) {
         case IRQ:
-            asm volatile("cpsid i");
+            asm volatile("cpsid i" ::: "memory");
             break;
         case FIQ:
-            asm volatile("cpsid f");
+            asm volatile("cpsid f" ::: "memory");
             break;
         case BOTH:
-            asm volatile("cpsid if");
+            asm volatile("cpsid if" ::: "memory");
             break;
         default:
             /** should never happen **/
@@ -356,5 +265,5 @@ size_t get_proc_status() {
 /* (e.g. when we return from a handler, restore value from
  disable_interrupt_save				     */
 void restore_proc_status(size_t cpsr) {
-    asm volatile("msr cpsr_c, %0" : : "r"(cpsr));
+    asm volatile("msr cpsr_c, %0" : : "r"(cpsr) : "memory");
 }
@@ -0,0 +1,55 @@
+#include <barrier.h>
+#include <ktime.h>
+#include <pmm.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NS_PER_SECOND 1000000000u
+
+// CNTKCTL bits
+#define PL0PCTEN (1u << 0u)  // PL0 may read CNTPCT (and CNTFRQ)
+#define PL0VCTEN (1u << 1u)  // PL0 may read CNTVCT (and CNTFRQ)
+
+struct KtimePage * ktime_page = NULL;
+
+// Finds the largest shift (at most 32) for which to * 2^shift / from still fits in 32 bits, so
+// value * to / from == (value * mult) >> shift is as precise as possible.
+static void compute_factors(uint32_t from, uint32_t to, uint32_t * mult, uint32_t * shift) {
+    for (uint32_t s = 32; s > 0; s--) {
+        // Rounded to nearest. Runs once at boot, so the 64 bit divisions don't matter.
+        const uint64_t m = (((uint64_t)to << s) + from / 2) / from;
+        if (m <= UINT32_MAX) {
+            *mult = (uint32_t)m;
+            *shift = s;
+            return;
+        }
+    }
+
+    *mult = to / from;
+    *shift = 0;
+}
+
+void ktime_init() {
+    uint32_t frequency;
+    asm volatile("mrc p15, 0, %0, c14, c0, 0" : "=r"(frequency));
+
+    ktime_page = (struct KtimePage *)pmm_allocate_page();
+    memset(ktime_page, 0, PAGE_SIZE);
+
+    ktime_page->version = KTIME_PAGE_VERSION;
+    ktime_page->frequency = frequency;
+    compute_factors(frequency, NS_PER_SECOND, &ktime_page->ns_mult, &ktime_page->ns_shift);
+    compute_factors(NS_PER_SECOND, frequency, &ktime_page->counts_mult, &ktime_page->counts_shift);
+
+    // Let user mode read the counters, but not touch the timers
+    uint32_t cntkctl;
+    asm volatile("mrc p15, 0, %0, c14, c1, 0" : "=r"(cntkctl));
+    cntkctl |= PL0PCTEN | PL0VCTEN;
+    asm volatile("mcr p15, 0, %0, c14, c1, 0" ::"r"(cntkctl));
+    isb();
+
+    INFO("Clock: %u Hz, ns = counts * %u >> %u",
+         frequency,
+         ktime_page->ns_mult,
+         ktime_page->ns_shift);
+}
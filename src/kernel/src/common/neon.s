@@ -0,0 +1,105 @@
+// VFP/NEON control and the NEON loops behind simd.c. See simd.h for the C interface.
+//
+// The rest of the kernel is assembled for the arm1176, these need the Cortex-A7 and its NEON unit.
+// The NEON loops are only called between kernel_simd_begin and kernel_simd_end, and only use
+// d0-d7 and d16-d19, which the calling convention doesn't require to be preserved.
+
+.cpu cortex-a7
+.fpu neon-vfpv4
+
+.text
+
+.equ PAGE_SIZE, 4096
+.equ PREFETCH_DISTANCE, 192
+
+// void vfp_enable_access()
+// Allows kernel mode, but not user mode, to access coprocessors 10 and 11 (VFP and NEON) in CPACR
+.global vfp_enable_access
+vfp_enable_access:
+    mrc p15, 0, r0, c1, c0, 2
+    bic r0, r0, #(0xf << 20)
+    orr r0, r0, #(0x5 << 20)
+    mcr p15, 0, r0, c1, c0, 2
+    isb
+    bx lr
+
+// uint32_t vfp_read_mvfr0()
+.global vfp_read_mvfr0
+vfp_read_mvfr0:
+    vmrs r0, mvfr0
+    bx lr
+
+// uint32_t vfp_read_mvfr1()
+.global vfp_read_mvfr1
+vfp_read_mvfr1:
+    vmrs r0, mvfr1
+    bx lr
+
+// uint32_t vfp_read_fpexc()
+.global vfp_read_fpexc
+vfp_read_fpexc:
+    vmrs r0, fpexc
+    bx lr
+
+// void vfp_write_fpexc(uint32_t fpexc)
+.global vfp_write_fpexc
+vfp_write_fpexc:
+    vmsr fpexc, r0
+    isb
+    bx lr
+
+// void neon_clear_page(void * page)
+// 64 bytes per iteration, with 128 bit aligned stores
+.global neon_clear_page
+neon_clear_page:
+    vmov.i8 q0, #0
+    vmov.i8 q1, #0
+    mov r1, #(PAGE_SIZE / 64)
+neon_clear_page_loop:
+    vst1.8 {d0-d3}, [r0:128]!
+    vst1.8 {d0-d3}, [r0:128]!
+    subs r1, r1, #1
+    bne neon_clear_page_loop
+    bx lr
+
+// void neon_copy_page(void * dest, const void * src)
+.global neon_copy_page
+neon_copy_page:
+    mov r2, #(PAGE_SIZE / 64)
+neon_copy_page_loop:
+    pld [r1, #PREFETCH_DISTANCE]
+    vld1.8 {d0-d3}, [r1:128]!
+    vld1.8 {d4-d7}, [r1:128]!
+    vst1.8 {d0-d3}, [r0:128]!
+    vst1.8 {d4-d7}, [r0:128]!
+    subs r2, r2, #1
+    bne neon_copy_page_loop
+    bx lr
+
+// uint64_t neon_checksum_blocks(const void * data, size_t blocks)
+// Sum of the 16 bit words of blocks * 64 bytes, not folded. Every 32 bit lane of the two
+// accumulators gains at most 4 * 0xffff per block, so blocks must be below 16384. Unaligned data
+// is fine, as long as unaligned accesses are allowed (SCTLR.A clear).
+.global neon_checksum_blocks
+neon_checksum_blocks:
+    vmov.i32 q8, #0
+    vmov.i32 q9, #0
+    cmp r1, #0
+    beq neon_checksum_blocks_done
+neon_checksum_blocks_loop:
+    pld [r0, #PREFETCH_DISTANCE]
+    vld1.16 {d0-d3}, [r0]!
+    vld1.16 {d4-d7}, [r0]!
+    vpadal.u16 q8, q0
+    vpadal.u16 q9, q1
+    vpadal.u16 q8, q2
+    vpadal.u16 q9, q3
+    subs r1, r1, #1
+    bne neon_checksum_blocks_loop
+neon_checksum_blocks_done:
+    // Widen to 64 bit before adding the lanes up, they can be close to 2^32 each
+    vpaddl.u32 q8, q8
+    vpadal.u32 q8, q9
+    vadd.i64 d16, d16, d17
+    vmov r0, r1, d16
+    bx lr
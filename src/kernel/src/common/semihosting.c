@@ -0,0 +1,84 @@
+#include <chipset.h>
+#include <semihosting.h>
+#include <stdio.h>
+#include <string.h>
+
+static int console_handle = -1;
+// Where output for the other uart channels still goes
+static void (*uart_write)(const char * data, size_t length, int uartchannel);
+
+static inline uint32_t semihosting_call(enum SemihostingOperation operation, const void * arg) {
+    register uint32_t r0 asm("r0") = operation;
+    register const void * r1 asm("r1") = arg;
+    asm volatile("svc 0x00123456" : "+r"(r0) : "r"(r1) : "memory");
+    return r0;
+}
+
+int semihosting_open(const char * path, enum SemihostingOpenMode mode) {
+    const uint32_t parameters[3] = {(uint32_t)path, mode, strlen((char *)path)};
+    return (int)semihosting_call(SEMIHOSTING_SYS_OPEN, parameters);
+}
+
+void semihosting_close(int handle) {
+    const uint32_t parameters[1] = {handle};
+    semihosting_call(SEMIHOSTING_SYS_CLOSE, parameters);
+}
+
+bool semihosting_write(int handle, const void * data, size_t length) {
+    const uint32_t parameters[3] = {handle, (uint32_t)data, length};
+    // Returns the number of bytes that were *not* written
+    return semihosting_call(SEMIHOSTING_SYS_WRITE, parameters) == 0;
+}
+
+bool semihosting_append(const char * path, const void * data, size_t length) {
+    const int handle = semihosting_open(path, SEMIHOSTING_OPEN_APPEND);
+    if (handle < 0) { return false; }
+
+    const bool written = semihosting_write(handle, data, length);
+    semihosting_close(handle);
+    return written;
+}
+
+void semihosting_write0(const char * s) {
+    semihosting_call(SEMIHOSTING_SYS_WRITE0, s);
+}
+
+bool semihosting_get_cmdline(char * buffer, size_t size) {
+    uint32_t parameters[2] = {(uint32_t)buffer, size};
+    return semihosting_call(SEMIHOSTING_SYS_GET_CMDLINE, parameters) == 0;
+}
+
+static void semihosting_console_write(const char * data, size_t length, int uartchannel) {
+    if (uartchannel != 0) {
+        uart_write(data, length, uartchannel);
+        return;
+    }
+
+    if (console_handle >= 0) {
+        semihosting_write(console_handle, data, length);
+        return;
+    }
+
+    // Without a handle, only terminated strings can be written
+    char chunk[128];
+    while (length > 0) {
+        const size_t n = length < sizeof(chunk) - 1 ? length : sizeof(chunk) - 1;
+        memcpy(chunk, (char *)data, n);
+        chunk[n] = '\0';
+        semihosting_write0(chunk);
+        data += n;
+        length -= n;
+    }
+}
+
+static void semihosting_console_putc(char c, int uartchannel) {
+    semihosting_console_write(&c, 1, uartchannel);
+}
+
+void semihosting_console_init() {
+    console_handle = semihosting_open(SEMIHOSTING_CONSOLE_NAME, SEMIHOSTING_OPEN_WRITE);
+
+    uart_write = chipset.uart_write;
+    chipset.uart_write = semihosting_console_write;
+    chipset.uart_putc = semihosting_console_putc;
+}
@@ -0,0 +1,128 @@
+#include <hardwareinfo.h>
+#include <klibc.h>
+#include <simd.h>
+#include <string.h>
+#include <vm2.h>
+
+// FPEXC.EN turns the VFP/NEON unit on
+#define FPEXC_EN (1u << 30)
+// MVFR1 fields that are non-zero when NEON loads/stores, integer and float instructions exist
+#define MVFR1_NEON_MASK 0x000fff00u
+// MVFR0 field with the number of registers, 2 for 32 registers
+#define MVFR0_REGISTERS(mvfr0) ((mvfr0)&0xf)
+
+// The largest number of 64 byte blocks neon_checksum_blocks can add without overflowing
+#define CHECKSUM_MAX_BLOCKS 8192
+
+// Implemented in neon.s
+void vfp_enable_access();
+uint32_t vfp_read_mvfr0();
+uint32_t vfp_read_mvfr1();
+uint32_t vfp_read_fpexc();
+void vfp_write_fpexc(uint32_t fpexc);
+void neon_clear_page(void * page);
+void neon_copy_page(void * dest, const void * src);
+uint64_t neon_checksum_blocks(const void * data, size_t blocks);
+
+static bool neon_present = false;
+static volatile bool simd_in_use = false;
+
+void simd_init() {
+    // The arm1176 only has VFPv2, the NEON code can't run there
+    if (get_hardwareinfo()->cpuType != CortexA7) {
+        INFO("No NEON unit, using scalar page and checksum routines");
+        return;
+    }
+
+    vfp_enable_access();
+    const uint32_t mvfr0 = vfp_read_mvfr0();
+    const uint32_t mvfr1 = vfp_read_mvfr1();
+    neon_present = (mvfr1 & MVFR1_NEON_MASK) == MVFR1_NEON_MASK && MVFR0_REGISTERS(mvfr0) == 2;
+
+    // Off until someone uses it
+    vfp_write_fpexc(vfp_read_fpexc() & ~FPEXC_EN);
+
+    INFO("NEON %s (MVFR0 0x%x, MVFR1 0x%x)",
+         neon_present ? "enabled" : "not present",
+         mvfr0,
+         mvfr1);
+}
+
+bool simd_present() {
+    return neon_present;
+}
+
+bool kernel_simd_usable() {
+    return neon_present && !simd_in_use;
+}
+
+void kernel_simd_begin() {
+    if (simd_in_use) { FATAL("kernel_simd_begin called while the SIMD unit is in use"); }
+    // Claimed before touching the unit, so an interrupt from here on takes the scalar path
+    simd_in_use = true;
+
+    vfp_write_fpexc(FPEXC_EN);
+}
+
+void kernel_simd_end() {
+    vfp_write_fpexc(0);
+    simd_in_use = false;
+}
+
+void page_clear(void * page) {
+    if (!kernel_simd_usable()) {
+        memset(page, 0, PAGE_SIZE);
+        return;
+    }
+
+    kernel_simd_begin();
+    neon_clear_page(page);
+    kernel_simd_end();
+}
+
+void page_copy(void * dest, const void * src) {
+    if (!kernel_simd_usable()) {
+        memcpy(dest, src, PAGE_SIZE);
+        return;
+    }
+
+    kernel_simd_begin();
+    neon_copy_page(dest, src);
+    kernel_simd_end();
+}
+
+// Ones' complement sum of the 16 bit words, not folded yet
+static uint64_t checksum_scalar(const uint8_t * data, size_t length) {
+    uint64_t sum = 0;
+    for (; length >= 2; data += 2, length -= 2) { sum += data[0] | (data[1] << 8u); }
+    if (length != 0) { sum += data[0]; }
+    return sum;
+}
+
+static uint16_t checksum_fold(uint64_t sum) {
+    while (sum >> 16u) { sum = (sum & 0xffff) + (sum >> 16u); }
+    return (uint16_t)~sum;
+}
+
+uint16_t checksum(const void * data, size_t length) {
+    const uint8_t * bytes = data;
+    uint64_t sum = 0;
+
+    if (length >= 64 && kernel_simd_usable()) {
+        kernel_simd_begin();
+        while (length >= 64) {
+            size_t blocks = length / 64;
+            if (blocks > CHECKSUM_MAX_BLOCKS) { blocks = CHECKSUM_MAX_BLOCKS; }
+            sum += neon_checksum_blocks(bytes, blocks);
+            bytes += blocks * 64;
+            length -= blocks * 64;
+        }
+        kernel_simd_end();
+    }
+
+    return checksum_fold(sum + checksum_scalar(bytes, length));
+}
+
+uint16_t page_checksum(const void * page) {
+    return checksum(page, PAGE_SIZE);
+}
@@ -1,8 +1,14 @@
+#include <bootargs.h>
 #include <chipset.h>
 #include <hardwareinfo.h>
 #include <interrupt.h>
 #include <klibc.h>
+#include <klog.h>
+#include <ktime.h>
 #include <mem_alloc.h>
+#include <page_age.h>
+#include <semihosting.h>
+#include <simd.h>
 #include <stdint.h>
 #include <test.h>
 #include <vm2.h>
@@ -10,6 +16,7 @@
 /// Entrypoint for the C part of the kernel.
 /// This function is called by the assembly located in [startup.s].
 /// The MMU has already been initialized here but only the first MiB of the kernel has been mapped.
+/// p_bootargs is the physical address of the ATAG list, if the bootloader passed one.
 void start(uint32_t * p_bootargs, size_t memory_size) {
     // Before this point, all code has to be hardware independent.
     // After this point, code can request the hardware info struct to find out what
@@ -19,6 +26,14 @@ void start(uint32_t * p_bootargs, size_t memory_size) {
     // Initialize the chipset and enable uart
     init_chipset();
 
+#ifdef SEMIHOSTING_CONSOLE
+    // Console output goes to the host directly instead of through the emulated uart
+    semihosting_console_init();
+#endif
+
+    // Prints TRACE, DEBUG and INFO messages in the background
+    klog_init();
+
     INFO("Detected memory size: 0x%x Bytes", memory_size);
     INFO("Started chipset specific handlers");
 
@@ -26,6 +41,9 @@ void start(uint32_t * p_bootargs, size_t memory_size) {
     print_hardwareinfo();
     detect_boardtype();
 
+    // Lets the kernel use NEON, the page allocator already clears pages with it
+    simd_init();
+
     // start proper virtual and physical memory management.
     // Even though we already enabled the mmu in startup.s to
     // create a higher half kernel. The pagetable created there
@@ -34,6 +52,11 @@ void start(uint32_t * p_bootargs, size_t memory_size) {
     INFO("Initializing the physical and virtual memory managers.");
     vm2_start(memory_size);
 
+    // The ATAGs are read through the linear map of physical memory
+    const bool atags_mapped = p_bootargs != NULL && (size_t)p_bootargs < KERNEL_LINEAR_MAP_SIZE;
+    bootargs_init(atags_mapped ? (uint32_t *)PHYS2VIRT(p_bootargs) : NULL);
+    INFO("Command line: %s", bootargs_cmdline());
+
     INFO("Setting up interrupt vector tables");
     // Set up the exception handlers.
     init_vector_table();
@@ -42,6 +65,9 @@ void start(uint32_t * p_bootargs, size_t memory_size) {
     // After this point kmalloc and kfree can be used for dynamic memory management.
     init_heap();
 
+    // Conversion between counter ticks and time, used by the timers
+    ktime_init();
+
     // Splash screen
     splash();
 
@@ -53,6 +79,10 @@ void start(uint32_t * p_bootargs, size_t memory_size) {
 
 
 #ifndef ENABLE_TESTS
+    // Periodically sample which pages processes use. Not started in tests, so tests that look at
+    // page ages don't race with the scanner.
+    page_aging_init();
+
 //    argparse_process(p_bootargs);
 //
 // TODO: Start init process
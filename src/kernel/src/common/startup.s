@@ -17,24 +17,8 @@ _Reset:
     push {r0-r11}
 
 
-    // Identity map 0x00000000 (the kernel)
-    ldr r0, =0x4000
-    mov r1, #0
-    orr r1, #0x02
-    orr r1, #0x400
-    str r1, [r0]
-
-    // Map the lowest 1Mb to 0x8000000
-    ldr r0, =__KERNEL_BASE
-    lsr r0, #20
-    lsl r0, #2
-    ldr r1, =0x4000
-    add r0, r1, r0
-
-    mov r1, #0
-    orr r1, #0x02
-    orr r1, #0x400
-    str r1, [r0]
+    // The pagetable itself is generated at build time (see boot_pagetable.s). It already
+    // identity maps the first MiB we're running from and maps all memory to 0x80000000.
 
     mov r0, #0
     // invalidate caches
@@ -48,7 +32,7 @@ _Reset:
     mov r2, #0x01
     mcr p15, 0, r2, c3, c0, 0
 
-    ldr r0, =0x4000
+    ldr r0, =__BOOT_L1_PAGETABLE
     // Give the pagetable addr to the MMU
     mcr p15, 0, r0, c2, c0, 0 // Table 0
     mcr p15, 0, r0, c2, c0, 1 // Table 1
@@ -73,7 +57,10 @@ _Reset:
 
     // Pop everything except r1, which will hold the memory size.
     pop {r0}
+    add sp, sp, #4
     pop {r2-r11}
+    // The bootloader passes the address of the ATAG list in r2, it's the first argument of start
+    mov r0, r2
 
     // Jumpt to the start of the kernel
     bl start
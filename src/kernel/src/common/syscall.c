@@ -0,0 +1,188 @@
+#include <chipset.h>
+#include <fs.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include <uaccess.h>
+
+#define STDOUT_FILENO 1
+#define STDERR_FILENO 2
+
+// Number of iovecs that writev handles without allocating, and the maximum it accepts at all.
+#define UIO_FASTIOV 8
+#define UIO_MAXIOV  1024
+
+// Size of the kernel buffer user data is copied through on its way to the console.
+#define CONSOLE_CHUNK_SIZE 128
+
+static long sys_exit(uint32_t code, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    // TODO: remove current process from scheduler
+    for (;;)
+        ;
+    return 0L;
+}
+
+static long sys_dummy(uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    return 0L;
+}
+
+static long sys_printf(uint32_t str, uint32_t arg1, uint32_t arg2, uint32_t arg3) {
+    char buf[256];
+    long len = strncpy_from_user(buf, (const char *)str, sizeof(buf) - 1);
+    if (len < 0) { return -1L; }
+    buf[len] = '\0';
+
+    kprintf("%s", buf);
+    return 0L;
+}
+
+// Writes the (user space) buffers to the console. Returns the number of bytes written, or -1 if
+// the first buffer was not readable at all.
+static long console_writev(const IoVec * iov, size_t iovcnt) {
+    uint8_t chunk[CONSOLE_CHUNK_SIZE];
+    long written = 0;
+
+    for (size_t i = 0; i < iovcnt; i++) {
+        size_t offset = 0;
+        while (offset < iov[i].length) {
+            size_t n = min(iov[i].length - offset, sizeof(chunk));
+            size_t missing = copy_from_user(chunk, iov[i].base + offset, n);
+
+            chipset.uart_write((const char *)chunk, n - missing, 0);
+            written += n - missing;
+
+            if (missing != 0) { return written > 0 ? written : -1L; }
+            offset += n;
+        }
+    }
+
+    return written;
+}
+
+// There is no file descriptor table yet, so only stdout and stderr (the console) are supported.
+// The iovec array is copied from user space once, the buffers it points to are copied in chunks.
+static long sys_writev(uint32_t fd, uint32_t user_iov, uint32_t iovcnt, uint32_t arg3) {
+    if (fd != STDOUT_FILENO && fd != STDERR_FILENO) { return -1L; }
+    if (iovcnt > UIO_MAXIOV) { return -1L; }
+
+    IoVec fast_iov[UIO_FASTIOV];
+    IoVec * iov = iovcnt <= UIO_FASTIOV ? fast_iov : kmalloc(iovcnt * sizeof(IoVec));
+    if (iov == NULL) { return -1L; }
+
+    long result = -1L;
+    if (copy_from_user(iov, (const void *)user_iov, iovcnt * sizeof(IoVec)) == 0) {
+        result = console_writev(iov, iovcnt);
+    }
+
+    if (iov != fast_iov) { kfree(iov); }
+    return result;
+}
+
+// NOTE: All FS syscalls have been *DISABLED* until the filesystem works again.
+// They were implemented as:
+//      create: kcreate((char*) r0, r1, 0)
+//      delete: kdelete((char*) r0, 1)
+//      open:   kopen((char*) r0, r1)
+//      mkdir:  kcreate((char*) r0, 'w', 1)
+//      read:   kread(r0, (void*) r1, r2)
+//      write:  kwrite(r0, (void*) r1, r2)
+//      close:  kclose(r0)
+//      seek:   kseek(r0, r1)
+//      copy:   kcopy((char*) r0, (char*) r1, r2)
+//      ls:     kls((char*) r0)
+static const struct SyscallEntry syscall_table[NR_SYSCALLS] = {
+    [SYSCALL_CREATE] = {NULL, "create"},
+    [SYSCALL_SWITCH] = {NULL, "switch"},
+    [SYSCALL_DELETE] = {NULL, "delete"},
+    [SYSCALL_OPEN] = {NULL, "open"},
+    [SYSCALL_READ] = {NULL, "read"},
+    [SYSCALL_WRITE] = {NULL, "write"},
+    [SYSCALL_CLOSE] = {NULL, "close"},
+    [SYSCALL_SET_PERM] = {NULL, "set_perm"},
+    [SYSCALL_MEM_MAP] = {NULL, "mem_map"},
+    [SYSCALL_SEEK] = {NULL, "seek"},
+    [SYSCALL_MKDIR] = {NULL, "mkdir"},
+    [SYSCALL_COPY] = {NULL, "copy"},
+    [SYSCALL_LS] = {NULL, "ls"},
+    [SYSCALL_MALLOC] = {NULL, "malloc"},
+    [SYSCALL_ALIGNED_ALLOC] = {NULL, "aligned_alloc"},
+    [SYSCALL_FREE] = {NULL, "free"},
+    [SYSCALL_PRINTF] = {sys_printf, "printf"},
+    [SYSCALL_DUMMY] = {sys_dummy, "dummy"},
+    [SYSCALL_EXIT] = {sys_exit, "exit"},
+    [SYSCALL_WRITEV] = {sys_writev, "writev"},
+    [SYSCALL_PAUSE] = {NULL, "pause"},
+};
+
+#ifdef SYSCALL_TRACE
+static struct SyscallTraceEntry syscall_trace[SYSCALL_TRACE_SIZE];
+// Total number of recorded syscalls. The ring index is this modulo the size.
+static size_t syscall_trace_count = 0;
+
+static inline void syscall_trace_record(struct TrapFrame * frame, long result) {
+    struct SyscallTraceEntry * entry = &syscall_trace[syscall_trace_count % SYSCALL_TRACE_SIZE];
+    entry->number = frame->r[7];
+    entry->args[0] = frame->r[0];
+    entry->args[1] = frame->r[1];
+    entry->args[2] = frame->r[2];
+    entry->args[3] = frame->r[3];
+    entry->result = result;
+    syscall_trace_count++;
+}
+#endif
+
+void syscall_dispatch(struct TrapFrame * frame) {
+    const uint32_t number = frame->r[7];
+    long result = -1L;
+
+    if (number < NR_SYSCALLS && syscall_table[number].handler != NULL) {
+        result = syscall_table[number].handler(frame->r[0], frame->r[1], frame->r[2], frame->r[3]);
+    } else if (number < NR_SYSCALLS && syscall_table[number].name != NULL) {
+        DEBUG("%s system call called, but it is not implemented", syscall_table[number].name);
+    } else {
+        DEBUG("That wasn't a syscall you knob! (%u)", number);
+    }
+
+#ifdef SYSCALL_TRACE
+    syscall_trace_record(frame, result);
+#endif
+
+    frame->r[0] = (uint32_t)result;
+}
+
+size_t syscall_trace_read(struct SyscallTraceEntry * out, size_t n) {
+#ifdef SYSCALL_TRACE
+    size_t available =
+        syscall_trace_count < SYSCALL_TRACE_SIZE ? syscall_trace_count : SYSCALL_TRACE_SIZE;
+    if (n > available) { n = available; }
+
+    for (size_t i = 0; i < n; i++) {
+        out[i] = syscall_trace[(syscall_trace_count - n + i) % SYSCALL_TRACE_SIZE];
+    }
+    return n;
+#else
+    return 0;
+#endif
+}
+
+void syscall_trace_dump() {
+#ifdef SYSCALL_TRACE
+    size_t n = syscall_trace_count < SYSCALL_TRACE_SIZE ? syscall_trace_count : SYSCALL_TRACE_SIZE;
+
+    kprintf("Last %u syscalls:\n", n);
+    for (size_t i = syscall_trace_count - n; i < syscall_trace_count; i++) {
+        const struct SyscallTraceEntry * entry = &syscall_trace[i % SYSCALL_TRACE_SIZE];
+        const char * name = entry->number < NR_SYSCALLS ? syscall_table[entry->number].name : NULL;
+
+        kprintf("  %s(%u) (0x%x, 0x%x, 0x%x, 0x%x) = %d\n",
+                name != NULL ? name : "?",
+                entry->number,
+                entry->args[0],
+                entry->args[1],
+                entry->args[2],
+                entry->args[3],
+                entry->result);
+    }
+#endif
+}
@@ -0,0 +1,53 @@
+#include <bootargs.h>
+#include <string.h>
+#include <test.h>
+
+#define BOOTARGS_TEST_CMDLINE "kernel.elf  -load 0x10 tests=path_,hm empty= x=1"
+
+static uint32_t bootargs_atags[8 + BOOTARGS_MAX_LENGTH / 4];
+static char bootargs_saved[BOOTARGS_MAX_LENGTH];
+
+// An ATAG list like the bootloader makes, with only a core tag and a command line
+static const uint32_t * bootargs_make_atags(const char * cmdline) {
+    const uint32_t cmdline_words = (strlen((char *)cmdline) + 1 + 3) / 4;
+
+    memset(bootargs_atags, 0, sizeof(bootargs_atags));
+    bootargs_atags[0] = 2;
+    bootargs_atags[1] = ATAG_CORE;
+    bootargs_atags[2] = 2 + cmdline_words;
+    bootargs_atags[3] = ATAG_CMDLINE;
+    memcpy(&bootargs_atags[4], cmdline, strlen((char *)cmdline) + 1);
+    // Followed by ATAG_NONE, which is all zeros
+    return bootargs_atags;
+}
+
+TEST_CREATE(test_bootargs_atags, {
+    size_t length = 0;
+    memcpy(bootargs_saved, bootargs_cmdline(), strlen((char *)bootargs_cmdline()) + 1);
+
+    bootargs_init(bootargs_make_atags(BOOTARGS_TEST_CMDLINE));
+    ASSERT_EQ(strcmp((char *)bootargs_cmdline(), BOOTARGS_TEST_CMDLINE), 0);
+
+    const char * tests = bootargs_get("tests", &length);
+    ASSERT_NOT_NULL(tests);
+    ASSERT_EQ(length, 8);
+    ASSERT_EQ(memcmp(tests, "path_,hm", 8), 0);
+
+    const char * empty = bootargs_get("empty", &length);
+    ASSERT_NOT_NULL(empty);
+    ASSERT_EQ(length, 0);
+
+    const char * x = bootargs_get("x", &length);
+    ASSERT_NOT_NULL(x);
+    ASSERT_EQ(length, 1);
+    ASSERT_EQ(*x, '1');
+
+    // Only whole keys followed by '=' count
+    ASSERT_NULL(bootargs_get("test", &length));
+    ASSERT_NULL(bootargs_get("-load", &length));
+    ASSERT_NULL(bootargs_get("path_", &length));
+
+    // Put the real command line back, so the test selection doesn't change
+    bootargs_init(bootargs_make_atags(bootargs_saved));
+    ASSERT_EQ(strcmp((char *)bootargs_cmdline(), bootargs_saved), 0);
+})
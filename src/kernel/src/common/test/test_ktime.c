@@ -0,0 +1,70 @@
+#include <bench.h>
+#include <ktime.h>
+#include <test.h>
+#include <uaccess.h>
+#include <vas2.h>
+
+#define BENCH_ITERATIONS 10000
+
+TEST_CREATE(test_ktime_conversion, {
+    const uint32_t frequency = ktime_page->frequency;
+    ASSERT_EQ(frequency, bench_counter_frequency());
+
+    // A second in counts is a second in ns, give or take rounding
+    ASSERT_GTEQ(ktime_counts_to_ns(frequency), 1000000000ull - 1);
+    ASSERT_LTEQ(ktime_counts_to_ns(frequency), 1000000000ull + 1);
+    ASSERT_GTEQ(ktime_to_counts(1000000000ull), frequency - 1);
+    ASSERT_LTEQ(ktime_to_counts(1000000000ull), frequency);
+
+    // Stays correct when the counts don't fit in 32 bits anymore (an hour, within a millisecond)
+    const uint64_t hour = ktime_counts_to_ns((uint64_t)frequency * 3600u);
+    ASSERT_GTEQ(hour, 3600000000000ull - 1000000u);
+    ASSERT_LTEQ(hour, 3600000000000ull + 1000000u);
+
+    ASSERT_EQ(ktime_ms_to_counts(1000), ktime_to_counts(1000000000ull));
+})
+
+TEST_CREATE(test_ktime_monotonic, {
+    uint64_t previous = ktime_get_ns();
+    for (uint32_t i = 0; i < 100; i++) {
+        const uint64_t now = ktime_get_ns();
+        ASSERT_GTEQ(now, previous);
+        previous = now;
+    }
+})
+
+TEST_CREATE(test_ktime_user_page, {
+    uint32_t cntkctl;
+    asm volatile("mrc p15, 0, %0, c14, c1, 0" : "=r"(cntkctl));
+    // PL0PCTEN
+    ASSERT(cntkctl & 1u);
+
+    struct vas2 * vas = create_vas();
+    switch_to_vas(vas);
+
+    // Read it like user mode would (copy_from_user uses unprivileged loads)
+    struct KtimePage page;
+    ASSERT_EQ(copy_from_user(&page, (void *)KTIME_PAGE_USER_ADDRESS, sizeof(page)), 0);
+    ASSERT_EQ(page.version, KTIME_PAGE_VERSION);
+    ASSERT_EQ(page.frequency, ktime_page->frequency);
+    ASSERT_EQ(page.ns_mult, ktime_page->ns_mult);
+    ASSERT_EQ(page.ns_shift, ktime_page->ns_shift);
+
+    // But not write it
+    ASSERT_GT(copy_to_user((void *)KTIME_PAGE_USER_ADDRESS, &page, sizeof(page)), 0);
+
+    vm2_set_user_pagetable(NULL);
+    vm2_flush_caches();
+    free_vas(vas);
+
+    // The page is shared, so freeing a process leaves it alone
+    ASSERT_EQ(ktime_page->version, KTIME_PAGE_VERSION);
+})
+
+TEST_CREATE(bench_ktime_get_ns, {
+    volatile uint64_t sink = 0;
+
+    const uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) { sink += ktime_get_ns(); }
+    bench_report("ktime_get_ns", bench_counter() - start, BENCH_ITERATIONS);
+})
@@ -0,0 +1,29 @@
+#include <klog.h>
+#include <semihosting.h>
+#include <string.h>
+#include <test.h>
+
+// The test rule runs qemu with -semihosting, so these files end up in the build directory.
+#define SEMIHOSTING_TEST_FILE "build/semihosting_test.txt"
+#define KLOG_TEST_DUMP_FILE   "build/klog_dump.txt"
+
+TEST_CREATE(test_semihosting_file_write, {
+    const int handle = semihosting_open(SEMIHOSTING_TEST_FILE, SEMIHOSTING_OPEN_WRITE);
+    ASSERT_GTEQ(handle, 0);
+
+    const char * line = "written through semihosting\n";
+    ASSERT(semihosting_write(handle, line, strlen((char *)line)));
+    semihosting_close(handle);
+
+    ASSERT(semihosting_append(SEMIHOSTING_TEST_FILE, line, strlen((char *)line)));
+})
+
+TEST_CREATE(test_semihosting_open_fails, {
+    // A directory that doesn't exist
+    ASSERT_EQ(semihosting_open("build/does/not/exist.txt", SEMIHOSTING_OPEN_READ), -1);
+})
+
+TEST_CREATE(test_klog_dump_to_host, {
+    INFO("This message ends up in " KLOG_TEST_DUMP_FILE);
+    ASSERT(klog_dump_to_host(KLOG_TEST_DUMP_FILE));
+})
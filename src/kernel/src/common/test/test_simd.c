@@ -0,0 +1,135 @@
+#include <bench.h>
+#include <simd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <test.h>
+#include <vm2.h>
+
+#define BENCH_PAGE_REPEATS 256
+
+// Two page aligned pages inside an allocation
+static uint8_t * simd_pages_alloc(void ** allocation) {
+    *allocation = kmalloc(3 * PAGE_SIZE);
+    return (uint8_t *)(((uintptr_t)*allocation + PAGE_SIZE - 1) & ~(uintptr_t)(PAGE_SIZE - 1));
+}
+
+static void simd_fill(uint8_t * buf, size_t n, uint32_t seed) {
+    for (size_t i = 0; i < n; i++) { buf[i] = (uint8_t)(seed + i * 13 + (i >> 5)); }
+}
+
+// Straightforward RFC 1071 checksum to compare with
+static uint16_t checksum_reference(const uint8_t * data, size_t length) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < length; i += 2) {
+        sum += data[i] | (data[i + 1] << 8u);
+        sum = (sum & 0xffff) + (sum >> 16u);
+    }
+    if (length & 1u) { sum += data[length - 1]; }
+    while (sum >> 16u) { sum = (sum & 0xffff) + (sum >> 16u); }
+    return (uint16_t)~sum;
+}
+
+TEST_CREATE(test_simd_begin_end, {
+    if (!simd_present()) { PASS(); }
+
+    ASSERT(kernel_simd_usable());
+    kernel_simd_begin();
+    // Interrupt handlers see that the unit is taken
+    ASSERT(!kernel_simd_usable());
+    kernel_simd_end();
+    ASSERT(kernel_simd_usable());
+})
+
+TEST_CREATE(test_page_clear_copy, {
+    void * allocation;
+    uint8_t * pages = simd_pages_alloc(&allocation);
+    uint8_t * second = pages + PAGE_SIZE;
+
+    simd_fill(pages, 2 * PAGE_SIZE, 3);
+    page_clear(pages);
+    for (size_t i = 0; i < PAGE_SIZE; i++) { ASSERT_EQ(pages[i], 0); }
+    // Nothing after the page
+    ASSERT_EQ(second[0], (uint8_t)(3 + PAGE_SIZE * 13 + (PAGE_SIZE >> 5)));
+
+    simd_fill(pages, PAGE_SIZE, 7);
+    page_copy(second, pages);
+    for (size_t i = 0; i < PAGE_SIZE; i++) { ASSERT_EQ(second[i], pages[i]); }
+
+    kfree(allocation);
+})
+
+TEST_CREATE(test_checksum, {
+    void * allocation;
+    uint8_t * pages = simd_pages_alloc(&allocation);
+    simd_fill(pages, 2 * PAGE_SIZE, 11);
+
+    // Lengths and alignments around the 64 byte blocks, with the scalar tail
+    for (size_t offset = 0; offset < 4; offset++) {
+        for (size_t length = 0; length < 200; length++) {
+            ASSERT_EQ(checksum(pages + offset, length), checksum_reference(pages + offset, length));
+        }
+    }
+    ASSERT_EQ(page_checksum(pages), checksum_reference(pages, PAGE_SIZE));
+
+    // All ones makes every lane as large as possible
+    memset(pages, 0xff, 2 * PAGE_SIZE);
+    ASSERT_EQ(checksum(pages, 2 * PAGE_SIZE), checksum_reference(pages, 2 * PAGE_SIZE));
+
+    // The checksum of data with its checksum appended is 0
+    simd_fill(pages, 100, 5);
+    const uint16_t sum = checksum(pages, 100);
+    pages[100] = sum & 0xff;
+    pages[101] = sum >> 8u;
+    ASSERT_EQ(checksum(pages, 102), 0);
+
+    kfree(allocation);
+})
+
+static void bench_page_report(const char * name, uint64_t ticks) {
+    bench_report(name, ticks, BENCH_PAGE_REPEATS);
+
+    const uint64_t bytes = (uint64_t)PAGE_SIZE * BENCH_PAGE_REPEATS;
+    const uint32_t mib_per_s = ticks == 0 ? 0 : (bytes * bench_counter_frequency() / ticks) >> 20u;
+    kprintf("[BENCH] %s: %u MiB/s\n", name, mib_per_s);
+}
+
+TEST_CREATE(bench_simd_pages, {
+    void * allocation;
+    uint8_t * pages = simd_pages_alloc(&allocation);
+    uint8_t * second = pages + PAGE_SIZE;
+    volatile uint32_t sink = 0;
+
+    uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PAGE_REPEATS; i++) {
+        for (size_t j = 0; j < PAGE_SIZE / 4; j++) { ((uint32_t *)pages)[j] = 0; }
+    }
+    bench_page_report("word loop clear page", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PAGE_REPEATS; i++) { memset(pages, 0, PAGE_SIZE); }
+    bench_page_report("memset page", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PAGE_REPEATS; i++) { page_clear(pages); }
+    bench_page_report("page_clear", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PAGE_REPEATS; i++) { memcpy(second, pages, PAGE_SIZE); }
+    bench_page_report("memcpy page", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PAGE_REPEATS; i++) { page_copy(second, pages); }
+    bench_page_report("page_copy", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PAGE_REPEATS; i++) {
+        sink += checksum_reference(pages, PAGE_SIZE);
+    }
+    bench_page_report("scalar checksum page", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PAGE_REPEATS; i++) { sink += page_checksum(pages); }
+    bench_page_report("page_checksum", bench_counter() - start);
+
+    kfree(allocation);
+})
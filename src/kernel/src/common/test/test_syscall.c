@@ -0,0 +1,109 @@
+#include <bench.h>
+#include <fs.h>
+#include <string.h>
+#include <syscall.h>
+#include <test.h>
+#include <uaccess.h>
+#include <vas2.h>
+
+#define SYSCALL_BENCH_ITERATIONS 10000
+
+#define SYSCALL_TEST_PAGE 0x10000
+
+// Syscalls from kernel mode work the same as from user mode, except that the swi overwrites lr.
+static inline long test_syscall3(uint32_t number, uint32_t arg0, uint32_t arg1, uint32_t arg2) {
+    register uint32_t r7 asm("r7") = number;
+    register uint32_t r0 asm("r0") = arg0;
+    register uint32_t r1 asm("r1") = arg1;
+    register uint32_t r2 asm("r2") = arg2;
+
+    asm volatile("swi #0" : "+r"(r0) : "r"(r7), "r"(r1), "r"(r2) : "lr", "memory");
+    return (long)r0;
+}
+
+static inline long test_syscall(uint32_t number, uint32_t arg0, uint32_t arg1) {
+    return test_syscall3(number, arg0, arg1, 0);
+}
+
+TEST_CREATE(test_syscall_dispatch, {
+    ASSERT_EQ(test_syscall(SYSCALL_DUMMY, 1, 2), 0);
+
+    // Unknown and unimplemented syscalls fail
+    ASSERT_EQ(test_syscall(NR_SYSCALLS, 0, 0), -1);
+    ASSERT_EQ(test_syscall(0xffffffff, 0, 0), -1);
+    ASSERT_EQ(test_syscall(SYSCALL_CREATE, 0, 0), -1);
+
+    // Kernel pointers are not accepted as user strings
+    ASSERT_EQ(test_syscall(SYSCALL_PRINTF, (uint32_t) "kernel string", 0), -1);
+})
+
+TEST_CREATE(test_syscall_preserves_registers, {
+    register uint32_t r4 asm("r4") = 0x4444;
+    register uint32_t r5 asm("r5") = 0x5555;
+    register uint32_t r7 asm("r7") = SYSCALL_DUMMY;
+    register uint32_t r0 asm("r0") = 7;
+    register uint32_t r1 asm("r1") = 0x1111;
+
+    asm volatile("swi #0" : "+r"(r0), "+r"(r1), "+r"(r4), "+r"(r5) : "r"(r7) : "lr", "memory");
+
+    ASSERT_EQ(r0, 0);
+    ASSERT_EQ(r1, 0x1111);
+    ASSERT_EQ(r4, 0x4444);
+    ASSERT_EQ(r5, 0x5555);
+})
+
+TEST_CREATE(test_syscall_trace, {
+#ifdef SYSCALL_TRACE
+    test_syscall(SYSCALL_DUMMY, 0x1234, 0x5678);
+
+    struct SyscallTraceEntry entry;
+    ASSERT_EQ(syscall_trace_read(&entry, 1), 1);
+    ASSERT_EQ(entry.number, SYSCALL_DUMMY);
+    ASSERT_EQ(entry.args[0], 0x1234);
+    ASSERT_EQ(entry.args[1], 0x5678);
+    ASSERT_EQ(entry.result, 0);
+#else
+    struct SyscallTraceEntry entry;
+    ASSERT_EQ(syscall_trace_read(&entry, 1), 0);
+#endif
+})
+
+static IoVec user_iovec(char * base, size_t length) {
+    return (IoVec){(uint8_t *)base, length};
+}
+
+TEST_CREATE(test_syscall_writev, {
+    struct vas2 * vas = create_vas();
+    allocate_page(vas, SYSCALL_TEST_PAGE, false);
+    switch_to_vas(vas);
+
+    // Put two strings and the iovec array pointing to them in user memory
+    char * strings = (char *)SYSCALL_TEST_PAGE;
+    IoVec * user_iov = (IoVec *)(SYSCALL_TEST_PAGE + 64);
+    IoVec iov[2];
+    iov[0] = user_iovec(strings, 7);
+    iov[1] = user_iovec(strings + 7, 7);
+    ASSERT_EQ(copy_to_user(strings, "writev works\n", 14), 0);
+    ASSERT_EQ(copy_to_user(user_iov, iov, sizeof(iov)), 0);
+
+    ASSERT_EQ(test_syscall3(SYSCALL_WRITEV, 1, (uint32_t)user_iov, 2), 14);
+    ASSERT_EQ(test_syscall3(SYSCALL_WRITEV, 1, (uint32_t)user_iov, 0), 0);
+
+    // No file descriptors besides the console, and kernel memory is refused
+    ASSERT_EQ(test_syscall3(SYSCALL_WRITEV, 5, (uint32_t)user_iov, 2), -1);
+    ASSERT_EQ(test_syscall3(SYSCALL_WRITEV, 1, (uint32_t)iov, 2), -1);
+
+    vm2_set_user_pagetable(NULL);
+    vm2_flush_caches();
+    free_vas(vas);
+})
+
+TEST_CREATE(bench_syscall_dummy, {
+    uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < SYSCALL_BENCH_ITERATIONS; i++) {
+        test_syscall(SYSCALL_DUMMY, 0, 0);
+    }
+    uint64_t end = bench_counter();
+
+    bench_report("syscall dummy round trip", end - start, SYSCALL_BENCH_ITERATIONS);
+})
@@ -0,0 +1,53 @@
+// Assembly entry points for exceptions which need more control over the saved registers than the
+// gcc interrupt attributes give us. The handlers themselves are written in C (see interrupt.c and syscall.c).
+
+.text
+
+// Builds a struct AbortFrame on the abort stack and calls data_abort_handler with it.
+// The handler may change the saved pc to resume somewhere else (exception table fixups).
+.global data_abort_entry
+data_abort_entry:
+    // lr_abt points 8 bytes past the instruction that caused the abort
+    sub lr, lr, #8
+    push {r0-r3, r12, lr}
+    mov r0, sp
+    bl data_abort_handler
+    pop {r0-r3, r12, lr}
+    // Return to the saved pc and restore the cpsr from the spsr
+    movs pc, lr
+
+// Builds a struct TrapFrame on the SVC stack and calls syscall_dispatch with it.
+// syscall_dispatch writes the return value into the saved r0.
+.global software_interrupt_entry
+software_interrupt_entry:
+    // lr_svc already points to the instruction after the swi. 14 words keep sp 8 byte aligned.
+    push {r0-r12, lr}
+    // r4 is callee saved, so the spsr survives the call (and nested syscalls from the kernel)
+    mrs r4, spsr
+    mov r0, sp
+    bl syscall_dispatch
+    msr spsr_cxsf, r4
+    // Restore all registers (r0 now holds the result) and return, restoring the cpsr from the spsr
+    ldm sp!, {r0-r12, pc}^
+
+// Runs interrupts on the SVC stack instead of the (tiny) IRQ stack. That way softirqs can run with
+// interrupts enabled: a nested interrupt doesn't overwrite lr_irq/spsr_irq of the interrupted one
+// because those are saved on the SVC stack first.
+.global irq_entry
+irq_entry:
+    // lr_irq points 4 bytes past the instruction to return to
+    sub lr, lr, #4
+    // Save the return address and spsr on the SVC stack and switch to SVC mode (interrupts stay off)
+    srsdb sp!, #0x13
+    cps #0x13
+    push {r0-r3, r12, lr}
+    // The interrupted code may have had an unaligned stack, align it for the C code
+    and r1, sp, #4
+    sub sp, sp, r1
+    push {r1, r2}
+    bl irq_handler
+    pop {r1, r2}
+    add sp, sp, r1
+    pop {r0-r3, r12, lr}
+    // Return and restore the cpsr
+    rfeia sp!
@@ -0,0 +1,55 @@
+#include <bcm2835.h>
+#include <irq.h>
+#include <stdio.h>
+
+static BCM2835InterruptRegisters * armctrl;
+
+void bcm2835_armctrl_init(size_t peripheral_base) {
+    armctrl = (BCM2835InterruptRegisters *)(peripheral_base + BCM2835_ARMCTRL_OFFSET);
+
+    // Start with everything disabled, drivers enable their sources with irq_register
+    armctrl->DisableIRQs1 = 0xffffffff;
+    armctrl->DisableIRQs2 = 0xffffffff;
+    armctrl->DisableBasicIRQs = 0xff;
+}
+
+void bcm2835_armctrl_handle_irq() {
+    // Bits 8 and up of the basic register summarize the other two registers, but not completely
+    // (some GPU interrupts are only shown as "shortcut" bits), so just read both.
+    irq_dispatch_pending(BCM2835_IRQ_BASIC(0), armctrl->IRQBasicPending & 0xffu);
+    irq_dispatch_pending(BCM2835_IRQ_GPU(0), armctrl->IRQPending1);
+    irq_dispatch_pending(BCM2835_IRQ_GPU(32), armctrl->IRQPending2);
+}
+
+void bcm2835_armctrl_enable_irq(uint32_t irq) {
+    if (irq >= BCM2835_IRQ_BASIC(0)) {
+        armctrl->EnableBasicIRQs = 1u << (irq - BCM2835_IRQ_BASIC(0));
+    } else if (irq >= BCM2835_IRQ_GPU(32)) {
+        armctrl->EnableIRQs2 = 1u << (irq - BCM2835_IRQ_GPU(32));
+    } else {
+        armctrl->EnableIRQs1 = 1u << (irq - BCM2835_IRQ_GPU(0));
+    }
+}
+
+void bcm2835_armctrl_disable_irq(uint32_t irq) {
+    if (irq >= BCM2835_IRQ_BASIC(0)) {
+        armctrl->DisableBasicIRQs = 1u << (irq - BCM2835_IRQ_BASIC(0));
+    } else if (irq >= BCM2835_IRQ_GPU(32)) {
+        armctrl->DisableIRQs2 = 1u << (irq - BCM2835_IRQ_GPU(32));
+    } else {
+        armctrl->DisableIRQs1 = 1u << (irq - BCM2835_IRQ_GPU(0));
+    }
+}
+
+// FIQControl selects the source with bits 0-6 (the GPU interrupts, then the basic ones, just like
+// our numbering) and enables it with bit 7.
+#define FIQ_ENABLE (1u << 7)
+
+void bcm2835_armctrl_route_fiq(uint32_t irq) {
+    bcm2835_armctrl_disable_irq(irq);
+    armctrl->FIQControl = FIQ_ENABLE | (irq - BCM2835_IRQ_BASE);
+}
+
+void bcm2835_armctrl_unroute_fiq() {
+    armctrl->FIQControl = 0;
+}
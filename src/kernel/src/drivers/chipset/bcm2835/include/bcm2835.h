@@ -2,3 +2,56 @@
 // We want to have bcm2835 for being able to boot on an actual Pi Zero/B+
 // TODO: new pis (raspberry pi zero w) may have an entirely different chipset again (not bcm2835 or 36).
 //       to boot it another implementation must exist.
+
+#ifndef BCM2835_H
+#define BCM2835_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * The ARMCTRL interrupt controller of the BCM2835 peripherals. The BCM2836 still has it, and
+ * routes all of its interrupts to the GPU bit of the local interrupt controller.
+ * https://www.raspberrypi.org/app/uploads/2012/02/BCM2835-ARM-Peripherals.pdf (section 7)
+ */
+
+// Offset from the start of the peripherals
+#define BCM2835_ARMCTRL_OFFSET 0xB200
+
+typedef volatile struct BCM2835InterruptRegisters {
+    const uint32_t IRQBasicPending;
+    const uint32_t IRQPending1;
+    const uint32_t IRQPending2;
+    uint32_t FIQControl;
+    uint32_t EnableIRQs1;
+    uint32_t EnableIRQs2;
+    uint32_t EnableBasicIRQs;
+    uint32_t DisableIRQs1;
+    uint32_t DisableIRQs2;
+    uint32_t DisableBasicIRQs;
+} BCM2835InterruptRegisters;
+
+// Interrupt numbers (see irq.h) of the ARMCTRL sources. The 64 GPU interrupts come first, followed
+// by the 8 ARM specific ones of the basic pending register.
+#define BCM2835_IRQ_BASE        32
+#define BCM2835_IRQ_GPU(n)      (BCM2835_IRQ_BASE + (n))
+#define BCM2835_IRQ_BASIC(n)    (BCM2835_IRQ_BASE + 64 + (n))
+#define BCM2835_IRQ_END         BCM2835_IRQ_BASIC(8)
+
+#define BCM2835_IRQ_ARM_TIMER BCM2835_IRQ_BASIC(0)
+#define BCM2835_IRQ_UART      BCM2835_IRQ_GPU(57)
+
+void bcm2835_armctrl_init(size_t peripheral_base);
+
+/// Dispatches every pending ARMCTRL interrupt.
+void bcm2835_armctrl_handle_irq();
+
+/// Enable or disable one of the BCM2835_IRQ_* sources.
+void bcm2835_armctrl_enable_irq(uint32_t irq);
+void bcm2835_armctrl_disable_irq(uint32_t irq);
+
+/// Delivers one of the BCM2835_IRQ_* sources as FIQ instead of IRQ. Only one source can be the FIQ.
+void bcm2835_armctrl_route_fiq(uint32_t irq);
+void bcm2835_armctrl_unroute_fiq();
+
+#endif
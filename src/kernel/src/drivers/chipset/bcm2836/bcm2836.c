@@ -1,40 +1,109 @@
 // https://www.raspberrypi.org/documentation/hardware/raspberrypi/bcm2836/QA7_rev3.4.pdf
+#include <bcm2835.h>
 #include <bcm2836.h>
 #include <chipset.h>
+#include <irq.h>
 #include <timer.h>
 #include <uart.h>
 #include <vm2.h>
 
 void bcm2836_irq_handler() {
-    volatile const uint32_t pending = bcm2836_registers_base->Core0IRQSource;
+    const uint32_t pending = bcm2836_registers_base->Core0IRQSource;
 
-    switch (pending) {
-        // Generic timers
-        case PHYSICAL_SECURE_TIMER:
-            timer_handle_interrupt();
-            break;
+    // Every pending source is handled, not just one
+    irq_dispatch_pending(0, pending & 0xfffu & ~GPU);
+
+    if (pending & GPU) { bcm2835_armctrl_handle_irq(); }
+}
+
+void bcm2836_enable_irq(uint32_t irq) {
+    if (irq >= BCM2835_IRQ_END) {
+        return;
+    } else if (irq >= BCM2835_IRQ_BASE) {
+        bcm2835_armctrl_enable_irq(irq);
+    } else if (irq <= BCM2836_IRQ_CNTV) {
+        bcm2836_registers_base->Core0TimersInterruptControl |= 1u << irq;
+    } else if (irq <= BCM2836_IRQ_MAILBOX_3) {
+        const uint32_t mailbox = irq - BCM2836_IRQ_MAILBOX_0;
+        bcm2836_registers_base->Core0MailboxInterruptControl |= 1u << mailbox;
+    }
+    // The remaining local sources are enabled in their own devices
+}
+
+void bcm2836_disable_irq(uint32_t irq) {
+    if (irq >= BCM2835_IRQ_END) {
+        return;
+    } else if (irq >= BCM2835_IRQ_BASE) {
+        bcm2835_armctrl_disable_irq(irq);
+    } else if (irq <= BCM2836_IRQ_CNTV) {
+        bcm2836_registers_base->Core0TimersInterruptControl &= ~(1u << irq);
+    } else if (irq <= BCM2836_IRQ_MAILBOX_3) {
+        const uint32_t mailbox = irq - BCM2836_IRQ_MAILBOX_0;
+        bcm2836_registers_base->Core0MailboxInterruptControl &= ~(1u << mailbox);
+    }
+}
+
+// The timers have a FIQ enable bit next to every IRQ enable bit
+#define TIMER_FIQ_SHIFT 4
+
+bool bcm2836_route_fiq(uint32_t irq) {
+    if (irq >= BCM2835_IRQ_END) {
+        return false;
+    } else if (irq >= BCM2835_IRQ_BASE) {
+        bcm2835_armctrl_route_fiq(irq);
+    } else if (irq <= BCM2836_IRQ_CNTV) {
+        bcm2836_disable_irq(irq);
+        bcm2836_registers_base->Core0TimersInterruptControl |= 1u << (irq + TIMER_FIQ_SHIFT);
+    } else {
+        return false;
     }
+    return true;
 }
 
+void bcm2836_unroute_fiq(uint32_t irq) {
+    if (irq >= BCM2835_IRQ_END) {
+        return;
+    } else if (irq >= BCM2835_IRQ_BASE) {
+        bcm2835_armctrl_unroute_fiq();
+    } else if (irq <= BCM2836_IRQ_CNTV) {
+        bcm2836_registers_base->Core0TimersInterruptControl &= ~(1u << (irq + TIMER_FIQ_SHIFT));
+    }
+}
+
+// FIQs are handled by the handler fiq_install puts at the vector, this only runs when nothing is
+// installed.
 void bcm2836_fiq_handler() {}
 
 void bcm2836_init() {
     chipset.schedule_timer_periodic = &bcm2836_schedule_timer_periodic;
     chipset.schedule_timer_once = &bcm2836_schedule_timer_once;
     chipset.deschedule_timer = &bcm2836_deschedule_timer;
+    chipset.schedule_timer_with_slack = &bcm2836_schedule_timer_with_slack;
+    chipset.start_timer = &bcm2836_start_timer;
+    chipset.stop_timer = &bcm2836_stop_timer;
     chipset.uart_putc = &bcm2836_uart_putc;
+    chipset.uart_write = &bcm2836_uart_write;
+    chipset.uart_flush = &bcm2836_uart_flush;
     chipset.uart_on_message = &bcm2836_uart_on_message;
+    chipset.uart_off_message = &bcm2836_uart_off_message;
     chipset.handle_irq = &bcm2836_irq_handler;
     chipset.handle_fiq = &bcm2836_fiq_handler;
+    chipset.enable_irq = &bcm2836_enable_irq;
+    chipset.disable_irq = &bcm2836_disable_irq;
+    chipset.route_fiq = &bcm2836_route_fiq;
+    chipset.unroute_fiq = &bcm2836_unroute_fiq;
     chipset.late_init = &bcm2836_late_init;
 
     bcm2836_registers_base =
         (struct BCM2836Registers *)vm2_map_peripheral(BCM2836_REGISTERS_PHYSICAL_BASE, 4);
     bcm2836_peripheral_base = vm2_map_peripheral(BCM2836_PERIPHERALS_PHYSICAL_BASE, 16);
 
+    bcm2835_armctrl_init(bcm2836_peripheral_base);
+
     bcm2836_uart_init();
 }
 
 void bcm2836_late_init() {
     bcm2836_timer_init();
+    bcm2836_uart_late_init();
 }
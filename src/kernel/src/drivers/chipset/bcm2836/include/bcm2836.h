@@ -105,6 +105,21 @@ enum InterruptSource {
     LOCAL_TIMER = (1 << 11),
 };
 
+// Interrupt numbers (see irq.h) of the local sources: their bit number in Core0IRQSource.
+// The GPU source is not dispatched itself, it forwards to the ARMCTRL sources (see bcm2835.h).
+enum BCM2836Irq {
+    BCM2836_IRQ_CNTPS = 0,
+    BCM2836_IRQ_CNTPNS = 1,
+    BCM2836_IRQ_CNTHP = 2,
+    BCM2836_IRQ_CNTV = 3,
+    BCM2836_IRQ_MAILBOX_0 = 4,
+    BCM2836_IRQ_MAILBOX_3 = 7,
+    BCM2836_IRQ_GPU = 8,
+    BCM2836_IRQ_PMU = 9,
+    BCM2836_IRQ_AXI = 10,
+    BCM2836_IRQ_LOCAL_TIMER = 11,
+};
+
 
 void bcm2836_init();
 void bcm2836_late_init();
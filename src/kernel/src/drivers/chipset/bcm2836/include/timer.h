@@ -10,12 +10,49 @@
 
 void bcm2836_timer_init();
 
-void timer_handle_interrupt();
-
 TimerHandle bcm2836_schedule_timer_once(TimerCallback callback, uint32_t delay_ms);
 
 TimerHandle bcm2836_schedule_timer_periodic(TimerCallback callback, uint32_t delay_ms);
 
 void bcm2836_deschedule_timer(TimerHandle handle);
 
+void bcm2836_start_timer(Timer * timer, TimerCallback callback, uint32_t delay_ms, bool periodic);
+
+void bcm2836_stop_timer(Timer * timer);
+
+TimerHandle bcm2836_schedule_timer_with_slack(TimerCallback callback, uint32_t delay_ms,
+                                              uint32_t slack_ms, bool periodic);
+
+/// Picks the deadline in [deadline, deadline + slack] with the most trailing zero bits. Timers with
+/// overlapping slack windows tend to get the same deadline this way, so they expire together.
+uint64_t timer_apply_slack(uint64_t deadline, uint64_t slack);
+
+struct TimerStats {
+    /// Timer interrupts that ran at least one callback
+    uint32_t wakeups;
+    /// Callbacks that ran
+    uint32_t expiries;
+    /// Callbacks that would have needed an interrupt of their own without slack (approximately)
+    uint32_t wakeups_saved;
+};
+
+const struct TimerStats * bcm2836_timer_stats();
+
+#ifdef ENABLE_TESTS
+/// Simulated clock for the tests. Timers started between begin and end run on a clock that starts
+/// at 0 and only moves in [bcm2836_timer_virtual_advance], which runs their callbacks
+/// synchronously, in deadline order (timers with the same deadline after slack in any order).
+/// Timers that were started before keep running in real time.
+void bcm2836_timer_virtual_begin();
+
+/// Moves the simulated clock ms milliseconds forward and runs every timer that expires on the way.
+void bcm2836_timer_virtual_advance(uint32_t ms);
+
+/// The simulated clock in counter ticks
+uint64_t bcm2836_timer_virtual_now();
+
+/// Goes back to real time. Timers on the simulated clock that are still running are dropped.
+void bcm2836_timer_virtual_end();
+#endif
+
 #endif
@@ -27,12 +27,66 @@ typedef volatile struct BCM2836UartInterface {
     uint32_t DMACR;           // DMA Control Register
 } BCM2836UartInterface;
 
+/// Uart 0 is a PL011 with 16 byte fifos. Output goes through a transmit queue which is emptied by
+/// the transmit interrupt, so writing returns as soon as the bytes are queued. Received bytes are
+/// collected by the receive interrupts and handed to the uart_on_message callbacks in batches, from
+/// a softirq. Until bcm2836_uart_late_init (which needs interrupts), output is written directly.
+
+#define UART_TX_BUFFER_SIZE 4096  // Must be a power of 2
+#define UART_RX_BUFFER_SIZE 256   // Must be a power of 2
+#define UART_RX_BATCH_SIZE  64
+#define UART_MAX_CALLBACKS  4
+
+/// The uart reference clock set up by the firmware (and qemu)
+#define BCM2836_UART_CLOCK 48000000
+#define UART_DEFAULT_BAUD  115200
+
+/// How full a fifo has to be (receive) or how empty (transmit) before it raises an interrupt
+enum UartFifoLevel {
+    UART_FIFO_1_8 = 0,
+    UART_FIFO_1_4 = 1,
+    UART_FIFO_1_2 = 2,
+    UART_FIFO_3_4 = 3,
+    UART_FIFO_7_8 = 4,
+};
+
+struct UartConfig {
+    uint32_t baud;
+    enum UartFifoLevel tx_level;
+    enum UartFifoLevel rx_level;
+};
+
 void bcm2836_uart_init();
 
-void uart_write_byte(BCM2836UartInterface * interface, volatile uint8_t value);
+/// Enables the interrupts, after which uart 0 is buffered.
+void bcm2836_uart_late_init();
+
+/// Sets the baud rate, 8N1 framing and the fifo trigger levels of uart 0.
+void bcm2836_uart_configure(const struct UartConfig * config);
+
+/// Computes the integer and fractional baud rate divisors.
+void bcm2836_uart_divisor(uint32_t clock, uint32_t baud, uint32_t * ibrd, uint32_t * fbrd);
+
+void uart_write_byte(BCM2836UartInterface * interface, uint8_t value);
 
 void bcm2836_uart_putc(char c, int uartchannel);
 
+void bcm2836_uart_write(const char * data, size_t length, int uartchannel);
+
+/// Waits until everything that is queued has been written to the fifo.
+void bcm2836_uart_flush();
+
+/// Number of bytes waiting in the transmit queue.
+size_t bcm2836_uart_tx_pending();
+
+/// Adds a callback for received bytes. At most UART_MAX_CALLBACKS are kept, registering one that
+/// is already there does nothing.
 void bcm2836_uart_on_message(UartCallback callback, int uartchannel);
 
+/// Removes a callback added with bcm2836_uart_on_message. Does nothing if it isn't registered.
+void bcm2836_uart_off_message(UartCallback callback, int uartchannel);
+
+/// Queues received bytes for the callbacks. Called by the receive interrupt.
+void bcm2836_uart_receive(const char * data, size_t length);
+
 #endif
@@ -1,8 +1,16 @@
+#include <ktime.h>
 #include <timer.h>
 #include <test.h>
 
-static int callback_count_1;
-static int callback_count_2;
+// The tests run on the simulated clock (see bcm2836_timer_virtual_begin), except
+// test_timer_hardware, where these are changed by the timer interrupt while the test waits.
+static volatile int callback_count_1;
+static volatile int callback_count_2;
+// What test_callback_2 saw when it ran
+static int callback_2_saw_count_1;
+static uint64_t callback_2_ran_at;
+
+static Timer nested_timer;
 
 static void test_callback_1() {
     callback_count_1++;
@@ -10,41 +18,174 @@ static void test_callback_1() {
 
 static void test_callback_2() {
     callback_count_2++;
+    callback_2_saw_count_1 = callback_count_1;
+    callback_2_ran_at = bcm2836_timer_virtual_now();
 }
 
-TEST_CREATE(test_timer_cb_called, {
+static void test_callback_nested() {
+    callback_count_1++;
+    bcm2836_start_timer(&nested_timer, test_callback_2, 10, false);
+}
+
+TEST_CREATE(test_timer_hardware, {
     callback_count_1 = 0;
 
-    bcm2836_schedule_timer_once(test_callback_1, 50);
+    bcm2836_schedule_timer_once(test_callback_1, 1);
     DEBUG("If the test gets stuck here, the timer callback was never called");
     while (callback_count_1 != 1);
 })
 
+TEST_CREATE(test_timer_cb_called, {
+    callback_count_1 = 0;
+    bcm2836_timer_virtual_begin();
+
+    bcm2836_schedule_timer_once(test_callback_1, 50);
+    bcm2836_timer_virtual_advance(49);
+    ASSERT_EQ(callback_count_1, 0);
+    // Leaves room for the rounding of the conversion to counter ticks
+    bcm2836_timer_virtual_advance(2);
+    ASSERT_EQ(callback_count_1, 1);
+    bcm2836_timer_virtual_advance(1000);
+    ASSERT_EQ(callback_count_1, 1);
+
+    bcm2836_timer_virtual_end();
+})
+
 TEST_CREATE(test_timer_cancel, {
     callback_count_1 = 0;
+    bcm2836_timer_virtual_begin();
 
     TimerHandle const handle = bcm2836_schedule_timer_once(test_callback_1, 50);
     bcm2836_deschedule_timer(handle);
+    bcm2836_timer_virtual_advance(100);
     ASSERT_EQ(callback_count_1, 0);
+
+    bcm2836_timer_virtual_end();
 })
 
 TEST_CREATE(test_timer_periodic_cb_called, {
     callback_count_1 = 0;
+    bcm2836_timer_virtual_begin();
 
     TimerHandle const handle = bcm2836_schedule_timer_periodic(test_callback_1, 50);
-    DEBUG("If the test gets stuck here, the timer callback was not called the required number of times");
-    while (callback_count_1 != 10);
+    bcm2836_timer_virtual_advance(500);
+    ASSERT_EQ(callback_count_1, 10);
     bcm2836_deschedule_timer(handle);
+    bcm2836_timer_virtual_advance(500);
+    ASSERT_EQ(callback_count_1, 10);
+
+    bcm2836_timer_virtual_end();
 })
 
 TEST_CREATE(test_timer_order, {
     callback_count_1 = 0;
     callback_count_2 = 0;
+    bcm2836_timer_virtual_begin();
 
-    bcm2836_schedule_timer_once(test_callback_1, 50);
+    // Started in reverse order, both expire in the same advance
     bcm2836_schedule_timer_once(test_callback_2, 100);
-    DEBUG("If the test gets stuck here, one of the timer callbacks was never called");
-    while (callback_count_1 != 1);
+    TimerHandle const handle = bcm2836_schedule_timer_periodic(test_callback_1, 30);
+    bcm2836_timer_virtual_advance(200);
+    bcm2836_deschedule_timer(handle);
+
+    ASSERT_EQ(callback_count_2, 1);
+    ASSERT_EQ(callback_2_saw_count_1, 3);
+    ASSERT_EQ(callback_2_ran_at, ktime_ms_to_counts(100));
+
+    bcm2836_timer_virtual_end();
+})
+
+TEST_CREATE(test_timer_nested, {
+    callback_count_1 = 0;
+    callback_count_2 = 0;
+    bcm2836_timer_virtual_begin();
+
+    // The callback starts a timer, which still expires in the same advance, at its own deadline
+    bcm2836_schedule_timer_once(test_callback_nested, 50);
+    bcm2836_timer_virtual_advance(100);
+    ASSERT_EQ(callback_count_1, 1);
+    ASSERT_EQ(callback_count_2, 1);
+    ASSERT_EQ(callback_2_ran_at, ktime_ms_to_counts(50) + ktime_ms_to_counts(10));
+
+    bcm2836_timer_virtual_end();
+})
+
+TEST_CREATE(test_timer_embedded, {
+    static Timer timer;
+    callback_count_1 = 0;
+    bcm2836_timer_virtual_begin();
+
+    bcm2836_start_timer(&timer, test_callback_1, 50, false);
+    // Restarting moves it instead of adding it twice
+    bcm2836_start_timer(&timer, test_callback_1, 50, false);
+    bcm2836_timer_virtual_advance(100);
+    ASSERT_EQ(callback_count_1, 1);
+    ASSERT(!timer_wheel_pending(&timer.entry));
+
+    bcm2836_start_timer(&timer, test_callback_1, 50, true);
+    bcm2836_stop_timer(&timer);
+    ASSERT(!timer_wheel_pending(&timer.entry));
+    bcm2836_timer_virtual_advance(100);
+    ASSERT_EQ(callback_count_1, 1);
+
+    bcm2836_timer_virtual_end();
+})
+
+TEST_CREATE(test_timer_virtual_end_drops, {
+    static Timer timer;
+    callback_count_1 = 0;
+    bcm2836_timer_virtual_begin();
+
+    bcm2836_start_timer(&timer, test_callback_1, 50, true);
+    bcm2836_schedule_timer_periodic(test_callback_1, 50);
+    bcm2836_timer_virtual_end();
+
+    ASSERT(!timer_wheel_pending(&timer.entry));
+    ASSERT_EQ(callback_count_1, 0);
+})
+
+TEST_CREATE(test_timer_apply_slack, {
+    ASSERT_EQ(timer_apply_slack(0x1234, 0), 0x1234);
+
+    // Both windows contain 0x2000, the roundest value
+    ASSERT_EQ(timer_apply_slack(0x1005, 0x1000), 0x2000);
+    ASSERT_EQ(timer_apply_slack(0x1064, 0x1000), 0x2000);
+
+    // Never leaves the window
+    for (uint64_t deadline = 0x7ff0; deadline < 0x8010; deadline++) {
+        const uint64_t rounded = timer_apply_slack(deadline, 0x20);
+        ASSERT_GTEQ(rounded, deadline);
+        ASSERT_LTEQ(rounded, deadline + 0x20);
+    }
+})
+
+TEST_CREATE(test_timer_slack_coalesces, {
+    callback_count_1 = 0;
+    callback_count_2 = 0;
+    const struct TimerStats before = *bcm2836_timer_stats();
+
+    bcm2836_timer_virtual_begin();
+
+    // The windows [50, 150] and [60, 160] ms both contain the same power of two counter value
+    // (2^23 at 62.5 MHz, 2^21 at 19.2 MHz) and not its double, so both timers get that deadline.
+    const uint64_t deadline = timer_apply_slack(ktime_ms_to_counts(50), ktime_ms_to_counts(100));
+    ASSERT_EQ(timer_apply_slack(ktime_ms_to_counts(60), ktime_ms_to_counts(100)), deadline);
+
+    bcm2836_schedule_timer_with_slack(test_callback_1, 50, 100, false);
+    bcm2836_schedule_timer_with_slack(test_callback_2, 60, 100, false);
+    bcm2836_timer_virtual_advance(49);
+    ASSERT_EQ(callback_count_1, 0);
     ASSERT_EQ(callback_count_2, 0);
-    while (callback_count_2 != 1);
+    bcm2836_timer_virtual_advance(151);
+    ASSERT_EQ(callback_count_1, 1);
+    ASSERT_EQ(callback_count_2, 1);
+    ASSERT_EQ(callback_2_ran_at, deadline);
+
+    // One wakeup ran both, the second would have needed its own without slack
+    const struct TimerStats * after = bcm2836_timer_stats();
+    ASSERT_EQ(after->expiries, before.expiries + 2);
+    ASSERT_EQ(after->wakeups, before.wakeups + 1);
+    ASSERT_EQ(after->wakeups_saved, before.wakeups_saved + 1);
+
+    bcm2836_timer_virtual_end();
 })
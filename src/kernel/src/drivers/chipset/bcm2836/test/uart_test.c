@@ -0,0 +1,72 @@
+#include <interrupt.h>
+#include <irq.h>
+#include <string.h>
+#include <test.h>
+#include <uart.h>
+
+static char received[UART_RX_BUFFER_SIZE];
+static size_t received_length;
+static size_t received_batches;
+
+static void test_uart_callback(const char * data, size_t length) {
+    const size_t room = sizeof(received) - received_length;
+    if (length > room) { length = room; }
+    memcpy(received + received_length, (char *)data, length);
+    received_length += length;
+    received_batches++;
+}
+
+TEST_CREATE(test_uart_divisor, {
+    uint32_t ibrd;
+    uint32_t fbrd;
+
+    // The example from the PL011 manual
+    bcm2836_uart_divisor(4000000, 230400, &ibrd, &fbrd);
+    ASSERT_EQ(ibrd, 1);
+    ASSERT_EQ(fbrd, 5);
+
+    bcm2836_uart_divisor(BCM2836_UART_CLOCK, UART_DEFAULT_BAUD, &ibrd, &fbrd);
+    ASSERT_EQ(ibrd, 26);
+    ASSERT_EQ(fbrd, 3);
+})
+
+TEST_CREATE(test_uart_write_flush, {
+    // More than fits in the hardware fifo
+    for (int i = 0; i < 4; i++) {
+        bcm2836_uart_write("uart buffering test line, should be printed completely\n", 56, 0);
+    }
+
+    bcm2836_uart_flush();
+    ASSERT_EQ(bcm2836_uart_tx_pending(), 0);
+})
+
+TEST_CREATE(test_uart_receive_batches, {
+    // Registering twice must not duplicate the callback
+    bcm2836_uart_on_message(test_uart_callback, 0);
+    bcm2836_uart_on_message(test_uart_callback, 0);
+    received_length = 0;
+    received_batches = 0;
+
+    char data[UART_RX_BATCH_SIZE + 10];
+    for (size_t i = 0; i < sizeof(data); i++) { data[i] = 'a' + i % 26; }
+
+    // bcm2836_uart_receive and softirq_run expect to run in an interrupt
+    int cpsr = disable_interrupt_save(IRQ);
+    bcm2836_uart_receive(data, sizeof(data));
+    softirq_run();
+    restore_proc_status(cpsr);
+
+    // Removed before checking anything, so console input never ends up in received
+    bcm2836_uart_off_message(test_uart_callback, 0);
+    const size_t batches = received_batches;
+
+    cpsr = disable_interrupt_save(IRQ);
+    bcm2836_uart_receive(data, 1);
+    softirq_run();
+    restore_proc_status(cpsr);
+
+    ASSERT_EQ(received_batches, batches);
+    ASSERT_EQ(received_length, sizeof(data));
+    ASSERT_EQ(received_batches, 2);
+    for (size_t i = 0; i < sizeof(data); i++) { ASSERT_EQ(received[i], data[i]); }
+})
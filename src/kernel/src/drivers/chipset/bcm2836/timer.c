@@ -1,17 +1,13 @@
 #include <timer.h>
 #include <bcm2836.h>
 #include <chipset.h>
-#include <priority_queue.h>
+#include <interrupt.h>
+#include <irq.h>
+#include <ktime.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
-
-typedef struct ScheduledTimer {
-    uint64_t scheduled_count;
-    TimerHandle handle;
-    TimerCallback callback;
-    uint32_t periodic_delay;
-} ScheduledTimer;
+#include <timer_wheel.h>
 
 typedef union LittleEndianUint64 {
     uint64_t dword;
@@ -22,7 +18,6 @@ typedef union LittleEndianUint64 {
 } LittleEndianUint64;
 
 // Internal implementation functions
-static uint32_t get_frequency();
 static void unmask_and_enable_timer();
 static void mask_and_enable_timer();
 static uint64_t get_phy_count();
@@ -30,20 +25,34 @@ static int32_t get_phy_timer_val();
 static void set_phy_timer_val(int32_t);
 static uint64_t get_phy_timer_cmp_val();
 static void set_phy_timer_cmp_val(uint64_t);
-static ScheduledTimer * get_prq_node_data(prq_node *);
-static TimerHandle schedule_timer(TimerCallback, uint32_t, bool);
-
-static prq_handle * scheduled_timers;
-
-/*
- * Gives the frequency of the counter in Hz
- */
-static inline uint32_t get_frequency() {
-    uint32_t val;
-    // Read CNTFRQ
-    asm volatile("mrc p15, 0, %0, c14, c0, 0" : "=r"(val));
-    return val;
-}
+static void program_next_deadline();
+static struct TimerWheel * wheel_of(const Timer *);
+static uint32_t run_expired(struct TimerWheel *, uint64_t);
+static Timer * allocate_handle_timer();
+static void free_handle_timer(Timer *);
+static void add_timer(Timer *, uint64_t);
+static TimerHandle schedule_timer(TimerCallback, uint32_t, uint32_t, bool);
+static void timer_irq(void *);
+static void timer_softirq(void *);
+
+// Deadlines are physical counter values
+static struct TimerWheel timer_wheel;
+
+// Timers behind the TimerHandles of schedule_timer_once/periodic, so these don't have to allocate
+// either. Only when more of them are running at the same time they come from the heap.
+#define HANDLE_TIMER_POOL_SIZE 32
+static Timer handle_timer_pool[HANDLE_TIMER_POOL_SIZE];
+static uint32_t handle_timer_pool_used = 0;
+
+static struct TimerStats timer_stats;
+
+#ifdef ENABLE_TESTS
+// Timers started between bcm2836_timer_virtual_begin and _end live in their own wheel, whose
+// deadlines are counter values of a clock that starts at 0 and only moves when a test advances it.
+static bool virtual_time = false;
+static uint64_t virtual_now;
+static struct TimerWheel virtual_wheel;
+#endif
 
 static inline void unmask_and_enable_timer() {
     // Disable output mask, enable timer
@@ -91,131 +100,271 @@ static inline void set_phy_timer_cmp_val(uint64_t val) {
     asm volatile("mcrr p15, 2, %0, %1, c14" ::"r"(le_val.low_word), "r"(le_val.high_word));
 }
 
-static inline ScheduledTimer * get_prq_node_data(prq_node * node) {
-    return (ScheduledTimer *)node->data;
-}
-
 void bcm2836_timer_init() {
-    const uint32_t freq = get_frequency();
-    INFO("System counter frequency: %u kHz\n", freq / 1000);
+    const uint64_t now = get_phy_count();
+    INFO("System counter frequency: %u kHz, counter at %llu", ktime_page->frequency / 1000, now);
 
-    bcm2836_registers_base->Core0TimersInterruptControl = PHYSICAL_SECURE_TIMER;
-
-    // Init priority queue
-    scheduled_timers = prq_create();
+    timer_wheel_init(&timer_wheel, now);
 
     // Initially there are no timers set yet, so the interrupt is masked
     mask_and_enable_timer();
-}
 
-void timer_handle_interrupt() {
-    volatile const uint64_t current_count = get_phy_count();
+    softirq_register(SOFTIRQ_TIMER, timer_softirq, NULL);
+    irq_register(BCM2836_IRQ_CNTPS, timer_irq, NULL);
+}
 
-    // Begin of critical section, disable timer interrupts
-    bcm2836_registers_base->Core0TimersInterruptControl = 0;
+// Top half: the timer interrupt stays asserted as long as the compare value has passed, so mask it
+// and leave the callbacks to the softirq, which also sets up the next compare value.
+static void timer_irq(void * ctx) {
+    irq_record_timer_latency(get_phy_timer_cmp_val());
+    mask_and_enable_timer();
+    softirq_raise(SOFTIRQ_TIMER);
+}
 
-    // Process all timers that are not in the future, if any
-    prq_node * next_timer_node = prq_peek(scheduled_timers);
-    while (next_timer_node != NULL &&
-           get_prq_node_data(next_timer_node)->scheduled_count <= current_count) {
+static void timer_softirq(void * ctx) {
+    run_expired(&timer_wheel, get_phy_count());
 
-        prq_dequeue(scheduled_timers);
-        ScheduledTimer * const next_timer = get_prq_node_data(next_timer_node);
+    const int cpsr = disable_interrupt_save(IRQ);
+    program_next_deadline();
+    restore_proc_status(cpsr);
+}
 
-        next_timer->callback();
+static inline struct TimerWheel * wheel_of(const Timer * timer) {
+#ifdef ENABLE_TESTS
+    if (timer->virtual_time) { return &virtual_wheel; }
+#endif
+    return &timer_wheel;
+}
 
-        // If the timer is not periodic, it is removed
-        if (next_timer->periodic_delay == 0) {
-            kfree(next_timer);
-            prq_free_node(next_timer_node);
-        }
-        // If the timer is periodic, it is updated and added to the queue again
-        else {
-            // TODO: Avoid duplicating code in `schedule_timer`
-            const uint64_t scheduled_count = next_timer->scheduled_count;
-            next_timer->scheduled_count = scheduled_count + next_timer->periodic_delay;
-            assert(scheduled_count <= INT32_MAX);
-            next_timer_node->priority = scheduled_count;
-
-            prq_enqueue(scheduled_timers, next_timer_node);
+// Runs the callbacks of all timers in the wheel that are not in the future and returns how many
+// ran. Counts as one wakeup if there were any. Timers run in the order of their wheel deadline,
+// the order of timers that slack rounded to the same deadline is unspecified.
+static uint32_t run_expired(struct TimerWheel * wheel, uint64_t current_count) {
+    uint32_t expired = 0;
+    uint64_t previous_expires = 0;
+
+    // The wheel is shared with interrupt handlers, but the callbacks run with interrupts enabled.
+    while (true) {
+        const int cpsr = disable_interrupt_save(IRQ);
+
+        // The entry is the first member of the timer
+        Timer * const timer = (Timer *)timer_wheel_expire(wheel, current_count);
+        if (timer == NULL) {
+            restore_proc_status(cpsr);
+            break;
         }
 
-        next_timer_node = prq_peek(scheduled_timers);
+        const uint64_t expires = timer->expires;
+        const TimerCallback callback = timer->callback;
+        const bool free_timer = timer->period == 0 && timer->handle_timer;
+
+        // A periodic timer is added again in the same critical section, so an interrupt handler
+        // never finds it outside the wheel (a stop would be undone, a start would add it twice),
+        // and before its callback runs, so the callback can stop it. The next run is based on the
+        // exact deadline, so the slack doesn't add up.
+        if (timer->period != 0) { add_timer(timer, expires + timer->period); }
+
+        restore_proc_status(cpsr);
+
+        // Without slack, every timer with a different exact deadline would have needed its own
+        // interrupt. Equal deadlines usually come out next to each other.
+        if (expired > 0 && expires != previous_expires) { timer_stats.wakeups_saved++; }
+        previous_expires = expires;
+        expired++;
+
+        if (free_timer) { free_handle_timer(timer); }
+
+        callback();
     }
 
-    // If there are no more scheduled timers in queue, mask interrupts until one is added again
-    if (next_timer_node == NULL) {
-        mask_and_enable_timer();
+    if (expired > 0) {
+        timer_stats.wakeups++;
+        timer_stats.expiries += expired;
     }
-    // If there still are, set compare val to next one
-    else {
-        set_phy_timer_cmp_val(get_prq_node_data(next_timer_node)->scheduled_count);
+
+    return expired;
+}
+
+// Sets the compare value to the earliest deadline and unmasks the interrupt, or masks it if there
+// are no more timers. Interrupts must be disabled.
+static void program_next_deadline() {
+    uint64_t deadline;
+
+    if (timer_wheel_next_deadline(&timer_wheel, &deadline)) {
+        set_phy_timer_cmp_val(deadline);
+        unmask_and_enable_timer();
+    } else {
+        mask_and_enable_timer();
     }
+}
 
-    // End of critical section, re-enable timer interrupts
-    bcm2836_registers_base->Core0TimersInterruptControl = PHYSICAL_SECURE_TIMER;
+uint64_t timer_apply_slack(uint64_t deadline, uint64_t slack) {
+    if (slack == 0) { return deadline; }
+
+    const uint64_t limit = deadline + slack;
+
+    // The highest bit in which the ends of the window differ is set in limit and not in deadline.
+    // Clearing all bits below it in limit gives the roundest value in the window.
+    const uint64_t differ = deadline ^ limit;
+    const uint32_t high = (uint32_t)(differ >> 32u);
+    const uint32_t low = (uint32_t)differ;
+    const uint32_t bit = high != 0 ? 63u - __builtin_clz(high) : 31u - __builtin_clz(low);
+
+    return limit & ~((1ull << bit) - 1);
+}
+
+// Adds a timer that is not in the wheel. Interrupts must be disabled.
+static void add_timer(Timer * timer, uint64_t expires) {
+    timer->expires = expires;
+    timer_wheel_add(wheel_of(timer), &timer->entry, timer_apply_slack(expires, timer->slack));
 }
 
-static TimerHandle schedule_timer(TimerCallback callback, uint32_t delay_ms, bool periodic) {
+void bcm2836_start_timer(Timer * timer, TimerCallback callback, uint32_t delay_ms, bool periodic) {
     assert(callback != NULL);
     assert(delay_ms > 0);
 
-    const uint64_t count_offset = (get_frequency() / 1000) * delay_ms;
-    volatile const uint64_t scheduled_count = get_phy_count() + count_offset;
+    const uint64_t count_offset = ktime_ms_to_counts(delay_ms);
+
+    const int cpsr = disable_interrupt_save(IRQ);
 
-    ScheduledTimer * const new_timer = kmalloc(sizeof(ScheduledTimer));
-    prq_node * const new_timer_node = prq_create_node();
+    // Restarting a running timer moves it
+    timer_wheel_remove(wheel_of(timer), &timer->entry);
 
-    new_timer->scheduled_count = scheduled_count;
-    new_timer->callback = callback;
-    assert(sizeof(TimerHandle) >= sizeof(prq_node *));
-    new_timer->handle = (TimerHandle)new_timer_node;
+    timer->callback = callback;
     // 0 means the timer is not periodic
-    new_timer->periodic_delay = periodic ? count_offset : 0;
-    // TODO: Find better way of doing this
-    assert(scheduled_count <= INT32_MAX);
-    new_timer_node->priority = scheduled_count;
-    new_timer_node->data = new_timer;
+    timer->period = periodic ? count_offset : 0;
+    timer->slack = ktime_ms_to_counts(timer->slack_ms);
+
+#ifdef ENABLE_TESTS
+    timer->virtual_time = virtual_time;
+    if (virtual_time) {
+        add_timer(timer, virtual_now + count_offset);
+        restore_proc_status(cpsr);
+        return;
+    }
+#endif
 
-    // Begin of critical section, disable timer interrupts
-    bcm2836_registers_base->Core0TimersInterruptControl = 0;
+    add_timer(timer, get_phy_count() + count_offset);
 
-    prq_enqueue(scheduled_timers, new_timer_node);
+    program_next_deadline();
 
-    set_phy_timer_cmp_val(get_prq_node_data(prq_peek(scheduled_timers))->scheduled_count);
+    restore_proc_status(cpsr);
+}
 
-    // Unmask interrupt if not already so
-    unmask_and_enable_timer();
+void bcm2836_stop_timer(Timer * timer) {
+    const int cpsr = disable_interrupt_save(IRQ);
 
-    // End of critical section, re-enable timer interrupts
-    bcm2836_registers_base->Core0TimersInterruptControl = PHYSICAL_SECURE_TIMER;
+    if (timer_wheel_remove(wheel_of(timer), &timer->entry) && wheel_of(timer) == &timer_wheel) {
+        program_next_deadline();
+    }
+
+    restore_proc_status(cpsr);
+}
+
+static Timer * allocate_handle_timer() {
+    Timer * timer = NULL;
+
+    const int cpsr = disable_interrupt_save(IRQ);
+    const uint32_t free = ~handle_timer_pool_used;
+    if (free != 0) {
+        const uint32_t index = __builtin_ctz(free);
+        handle_timer_pool_used |= 1u << index;
+        timer = &handle_timer_pool[index];
+    }
+    restore_proc_status(cpsr);
+
+    if (timer == NULL) { timer = kmalloc(sizeof(Timer)); }
+
+    timer_wheel_entry_init(&timer->entry);
+    timer->handle_timer = true;
 
-    return new_timer->handle;
+    return timer;
+}
+
+static void free_handle_timer(Timer * timer) {
+    if (timer >= handle_timer_pool && timer < handle_timer_pool + HANDLE_TIMER_POOL_SIZE) {
+        const int cpsr = disable_interrupt_save(IRQ);
+        handle_timer_pool_used &= ~(1u << (timer - handle_timer_pool));
+        restore_proc_status(cpsr);
+    } else {
+        kfree(timer);
+    }
+}
+
+static TimerHandle schedule_timer(TimerCallback callback, uint32_t delay_ms, uint32_t slack_ms,
+                                  bool periodic) {
+    Timer * const timer = allocate_handle_timer();
+    timer->slack_ms = slack_ms;
+    bcm2836_start_timer(timer, callback, delay_ms, periodic);
+
+    assert(sizeof(TimerHandle) >= sizeof(Timer *));
+    return (TimerHandle)timer;
 }
 
 TimerHandle bcm2836_schedule_timer_once(TimerCallback callback, uint32_t delay_ms) {
-    return schedule_timer(callback, delay_ms, false);
+    return schedule_timer(callback, delay_ms, 0, false);
 }
 
 TimerHandle bcm2836_schedule_timer_periodic(TimerCallback callback, uint32_t delay_ms) {
-    return schedule_timer(callback, delay_ms, true);
+    return schedule_timer(callback, delay_ms, 0, true);
+}
+
+TimerHandle bcm2836_schedule_timer_with_slack(TimerCallback callback, uint32_t delay_ms,
+                                              uint32_t slack_ms, bool periodic) {
+    return schedule_timer(callback, delay_ms, slack_ms, periodic);
 }
 
 void bcm2836_deschedule_timer(TimerHandle handle) {
-    assert(sizeof(prq_node *) >= sizeof(TimerHandle));
-    prq_node * const timer_node = (prq_node *)handle;
+    assert(sizeof(Timer *) >= sizeof(TimerHandle));
+    Timer * const timer = (Timer *)handle;
 
-    prq_remove(scheduled_timers, timer_node);
-    kfree(get_prq_node_data(timer_node));
-    prq_free_node(timer_node);
+    bcm2836_stop_timer(timer);
+    free_handle_timer(timer);
+}
 
-    prq_node * const next_timer_node = prq_peek(scheduled_timers);
-    // If there are no more scheduled timers in queue, mask interrupts until one is added again
-    if (next_timer_node == NULL) {
-        mask_and_enable_timer();
+const struct TimerStats * bcm2836_timer_stats() {
+    return &timer_stats;
+}
+
+#ifdef ENABLE_TESTS
+void bcm2836_timer_virtual_begin() {
+    assert(!virtual_time);
+
+    timer_wheel_init(&virtual_wheel, 0);
+    virtual_now = 0;
+    virtual_time = true;
+}
+
+void bcm2836_timer_virtual_advance(uint32_t ms) {
+    assert(virtual_time);
+
+    const uint64_t target = virtual_now + ktime_ms_to_counts(ms);
+    uint64_t deadline;
+
+    // Stops at every deadline on the way, so callbacks see the time they were due at, and timers
+    // they start expire in order with the others.
+    while (timer_wheel_next_deadline(&virtual_wheel, &deadline) && deadline <= target) {
+        if (deadline > virtual_now) { virtual_now = deadline; }
+        run_expired(&virtual_wheel, virtual_now);
     }
-    // If there still are, set compare val to next one
-    else {
-        set_phy_timer_cmp_val(get_prq_node_data(next_timer_node)->scheduled_count);
+
+    virtual_now = target;
+}
+
+uint64_t bcm2836_timer_virtual_now() {
+    assert(virtual_time);
+    return virtual_now;
+}
+
+void bcm2836_timer_virtual_end() {
+    assert(virtual_time);
+
+    // Drops the timers that are still running without calling them
+    Timer * timer;
+    while ((timer = (Timer *)timer_wheel_expire(&virtual_wheel, UINT64_MAX)) != NULL) {
+        if (timer->handle_timer) { free_handle_timer(timer); }
     }
+
+    virtual_time = false;
 }
+#endif
@@ -1,5 +1,8 @@
+#include <bcm2835.h>
 #include <bcm2836.h>
 #include <chipset.h>
+#include <interrupt.h>
+#include <irq.h>
 #include <klibc.h>
 #include <stdint.h>
 #include <uart.h>
@@ -50,41 +53,271 @@ volatile UartInterface * const UART2_ADDRESS = (volatile UartInterface *)0x101f3
 
 // (CR)
 //#define CTSEn  ()    // CTS Hardware Control Enable
+#define RXE    (1 << 9)  // Receive enable
+#define TXE    (1 << 8)  // Transmit enable
+#define UARTEN (1 << 0)  // Uart enable
+
+// (LCR_H)
+#define WLEN_8 (3 << 5)  // 8 bit words
+#define FEN    (1 << 4)  // Enable the fifos
+
+// (IFLS)
+#define TXIFLSEL_SHIFT 0
+#define RXIFLSEL_SHIFT 3
+
+// The I bit in the CPSR, set when irqs are disabled
+#define CPSR_IRQ_DISABLED (1 << 7)
 
 static BCM2836UartInterface * BCM2836_UART0_ADDRESS;
 static BCM2836UartInterface * BCM2836_UART1_ADDRESS;
 static BCM2836UartInterface * BCM2836_UART2_ADDRESS;
 static BCM2836UartInterface * BCM2836_UART3_ADDRESS;
 
+// Single producer, single consumer. Indices only grow, the size is a power of 2.
+struct UartRing {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+};
+
+#define RING_COUNT(ring)    ((ring)->head - (ring)->tail)
+#define RING_INDEX(i, size) ((i) & ((size)-1))
+
+// Only uart 0 (the PL011) is buffered and interrupt driven, the others are written to directly.
+static struct {
+    struct UartRing tx;
+    char tx_buffer[UART_TX_BUFFER_SIZE];
+    struct UartRing rx;
+    char rx_buffer[UART_RX_BUFFER_SIZE];
+    // Set once the interrupt is registered, before that everything is written directly.
+    bool buffered;
+    uint32_t rx_dropped;
+    UartCallback callbacks[UART_MAX_CALLBACKS];
+} uart0;
+
+static void uart_irq(void * ctx);
+static void uart_rx_softirq(void * ctx);
+
 void bcm2836_uart_init() {
     BCM2836_UART0_ADDRESS = (BCM2836UartInterface *)(bcm2836_peripheral_base + 0x201000);
     BCM2836_UART1_ADDRESS = (BCM2836UartInterface *)(bcm2836_peripheral_base + 0x202000);
     BCM2836_UART2_ADDRESS = (BCM2836UartInterface *)(bcm2836_peripheral_base + 0x203000);
     BCM2836_UART3_ADDRESS = (BCM2836UartInterface *)(bcm2836_peripheral_base + 0x204000);
+
+    struct UartConfig config = {
+        .baud = UART_DEFAULT_BAUD,
+        .tx_level = UART_FIFO_1_8,
+        .rx_level = UART_FIFO_1_2,
+    };
+    bcm2836_uart_configure(&config);
+}
+
+void bcm2836_uart_late_init() {
+    softirq_register(SOFTIRQ_UART, uart_rx_softirq, NULL);
+
+    // Receive interrupts are always on, the transmit interrupt only while bytes are queued.
+    BCM2836_UART0_ADDRESS->ICR = 0x7ff;
+    BCM2836_UART0_ADDRESS->IMSC = RXIM | RTIM;
+    uart0.buffered = irq_register(BCM2835_IRQ_UART, uart_irq, NULL);
+}
+
+void bcm2836_uart_divisor(uint32_t clock, uint32_t baud, uint32_t * ibrd, uint32_t * fbrd) {
+    // The divisor is clock / (16 * baud), with 6 fractional bits. Rounded to nearest.
+    const uint32_t divisor = (clock * 4 + baud / 2) / baud;
+    *ibrd = divisor >> 6;
+    *fbrd = divisor & 0x3f;
+}
+
+void bcm2836_uart_configure(const struct UartConfig * config) {
+    BCM2836UartInterface * uart = BCM2836_UART0_ADDRESS;
+
+    // The uart has to be disabled while it is configured, let it finish the current byte first.
+    while (uart->FR & BUSY) {}
+    uart->CR = 0;
+
+    uint32_t ibrd, fbrd;
+    bcm2836_uart_divisor(BCM2836_UART_CLOCK, config->baud, &ibrd, &fbrd);
+    uart->IBRD = ibrd;
+    uart->FBRD = fbrd;
+    // Writing LCR_H also latches the baud rate
+    uart->LCR_H = WLEN_8 | FEN;
+    uart->IFLS = (config->tx_level << TXIFLSEL_SHIFT) | (config->rx_level << RXIFLSEL_SHIFT);
+
+    uart->CR = UARTEN | TXE | RXE;
 }
 
-void uart_write_byte(volatile BCM2836UartInterface * interface, volatile uint8_t value) {
-    //    while (interface->FR & TXFF ) {
-    //        asm volatile ("nop");
-    //    }
+void uart_write_byte(volatile BCM2836UartInterface * interface, uint8_t value) {
+    while (interface->FR & TXFF) {}
     interface->DR = (uint32_t)value;
 }
 
-void bcm2836_uart_putc(char c, int uartchannel) {
-    if (uartchannel >= 4) { uartchannel = 0; }
+// Moves queued bytes into the transmit fifo until it is full. Interrupts must be disabled.
+static void uart_tx_fill() {
+    while (RING_COUNT(&uart0.tx) != 0 && !(BCM2836_UART0_ADDRESS->FR & TXFF)) {
+        BCM2836_UART0_ADDRESS->DR = uart0.tx_buffer[RING_INDEX(uart0.tx.tail, UART_TX_BUFFER_SIZE)];
+        uart0.tx.tail++;
+    }
+
+    if (RING_COUNT(&uart0.tx) == 0) { BCM2836_UART0_ADDRESS->IMSC &= ~TXIM; }
+}
+
+// Queues as much of data as fits and returns how much that was. Interrupts must be disabled.
+static size_t uart_tx_queue(const char * data, size_t length) {
+    size_t written = 0;
+
+    // Only bypass the queue when it is empty, so the order is kept
+    if (RING_COUNT(&uart0.tx) == 0) {
+        while (written < length && !(BCM2836_UART0_ADDRESS->FR & TXFF)) {
+            BCM2836_UART0_ADDRESS->DR = (uint8_t)data[written++];
+        }
+    }
+
+    while (written < length && RING_COUNT(&uart0.tx) < UART_TX_BUFFER_SIZE) {
+        uart0.tx_buffer[RING_INDEX(uart0.tx.head, UART_TX_BUFFER_SIZE)] = data[written++];
+        uart0.tx.head++;
+    }
+
+    if (RING_COUNT(&uart0.tx) != 0) { BCM2836_UART0_ADDRESS->IMSC |= TXIM; }
+
+    return written;
+}
+
+static void uart0_write(const char * data, size_t length) {
+    while (length > 0) {
+        const int cpsr = disable_interrupt_save(IRQ);
+
+        const size_t written = uart_tx_queue(data, length);
+        data += written;
+        length -= written;
+
+        // When the caller has interrupts disabled (an interrupt handler, or a panic) the transmit
+        // interrupt may never come, so send everything right away.
+        if (cpsr & CPSR_IRQ_DISABLED) {
+            while (RING_COUNT(&uart0.tx) != 0) { uart_tx_fill(); }
+        }
+
+        // Otherwise the transmit interrupt makes room while interrupts are enabled again
+        restore_proc_status(cpsr);
+    }
+}
 
+static BCM2836UartInterface * uart_address(int uartchannel) {
     switch (uartchannel) {
-        case 0:
-            return uart_write_byte(BCM2836_UART0_ADDRESS, c);
         case 1:
-            return uart_write_byte(BCM2836_UART1_ADDRESS, c);
+            return BCM2836_UART1_ADDRESS;
         case 2:
-            return uart_write_byte(BCM2836_UART2_ADDRESS, c);
+            return BCM2836_UART2_ADDRESS;
         case 3:
-            return uart_write_byte(BCM2836_UART3_ADDRESS, c);
+            return BCM2836_UART3_ADDRESS;
         default:
-            panic();
+            return BCM2836_UART0_ADDRESS;
     }
 }
 
-void bcm2836_uart_on_message(UartCallback callback, int uartchannel) {}
+void bcm2836_uart_write(const char * data, size_t length, int uartchannel) {
+    if (uartchannel >= 4 || uartchannel < 0) { uartchannel = 0; }
+
+    if (uartchannel == 0 && uart0.buffered) {
+        uart0_write(data, length);
+        return;
+    }
+
+    BCM2836UartInterface * const uart = uart_address(uartchannel);
+    for (size_t i = 0; i < length; i++) { uart_write_byte(uart, data[i]); }
+}
+
+void bcm2836_uart_putc(char c, int uartchannel) {
+    bcm2836_uart_write(&c, 1, uartchannel);
+}
+
+void bcm2836_uart_flush() {
+    while (RING_COUNT(&uart0.tx) != 0) {
+        const int cpsr = disable_interrupt_save(IRQ);
+        uart_tx_fill();
+        restore_proc_status(cpsr);
+    }
+}
+
+size_t bcm2836_uart_tx_pending() {
+    return RING_COUNT(&uart0.tx);
+}
+
+void bcm2836_uart_on_message(UartCallback callback, int uartchannel) {
+    // Only uart 0 receives, callbacks for other channels get its input as well. A callback that
+    // is already registered is not added again, so it never gets the same bytes twice.
+    size_t free_slot = UART_MAX_CALLBACKS;
+    for (size_t i = 0; i < UART_MAX_CALLBACKS; i++) {
+        if (uart0.callbacks[i] == callback) { return; }
+        if (uart0.callbacks[i] == NULL && free_slot == UART_MAX_CALLBACKS) { free_slot = i; }
+    }
+
+    if (free_slot == UART_MAX_CALLBACKS) {
+        WARN("Too many uart callbacks");
+        return;
+    }
+    uart0.callbacks[free_slot] = callback;
+}
+
+void bcm2836_uart_off_message(UartCallback callback, int uartchannel) {
+    for (size_t i = 0; i < UART_MAX_CALLBACKS; i++) {
+        if (uart0.callbacks[i] == callback) { uart0.callbacks[i] = NULL; }
+    }
+}
+
+void bcm2836_uart_receive(const char * data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (RING_COUNT(&uart0.rx) == UART_RX_BUFFER_SIZE) {
+            uart0.rx_dropped++;
+            continue;
+        }
+        uart0.rx_buffer[RING_INDEX(uart0.rx.head, UART_RX_BUFFER_SIZE)] = data[i];
+        uart0.rx.head++;
+    }
+
+    softirq_raise(SOFTIRQ_UART);
+}
+
+static void uart_irq(void * ctx) {
+    BCM2836UartInterface * const uart = BCM2836_UART0_ADDRESS;
+    const uint32_t status = uart->MIS;
+
+    if (status & (RXIM | RTIM)) {
+        // Empty the whole fifo, which also clears both interrupts
+        char batch[16];
+        size_t n = 0;
+        while (!(uart->FR & RXFE)) {
+            batch[n++] = (char)uart->DR;
+            if (n == sizeof(batch)) {
+                bcm2836_uart_receive(batch, n);
+                n = 0;
+            }
+        }
+        if (n > 0) { bcm2836_uart_receive(batch, n); }
+        uart->ICR = RXIM | RTIM;
+    }
+
+    if (status & TXIM) {
+        uart->ICR = TXIM;
+        uart_tx_fill();
+    }
+}
+
+// Hands everything that was received to the callbacks, in as few calls as possible.
+static void uart_rx_softirq(void * ctx) {
+    char batch[UART_RX_BATCH_SIZE];
+
+    while (true) {
+        const int cpsr = disable_interrupt_save(IRQ);
+        size_t n = 0;
+        while (n < sizeof(batch) && RING_COUNT(&uart0.rx) != 0) {
+            batch[n++] = uart0.rx_buffer[RING_INDEX(uart0.rx.tail, UART_RX_BUFFER_SIZE)];
+            uart0.rx.tail++;
+        }
+        restore_proc_status(cpsr);
+
+        if (n == 0) { break; }
+
+        for (size_t i = 0; i < UART_MAX_CALLBACKS; i++) {
+            if (uart0.callbacks[i] != NULL) { uart0.callbacks[i](batch, n); }
+        }
+    }
+}
@@ -8,9 +8,15 @@
 // We use putc (and printf) before the chipset is initialized already.
 // This stub makes sure that nothing crashes if you do that.
 void uart_putc_stub(char c __attribute__((unused)), int channel __attribute__((unused))) {}
+void uart_write_stub(const char * data __attribute__((unused)),
+                     size_t length __attribute__((unused)),
+                     int channel __attribute__((unused))) {}
+void uart_flush_stub() {}
 
 ChipsetInterface chipset = {
-    .uart_putc = uart_putc_stub  // Stub putc
+    .uart_putc = uart_putc_stub,  // Stub putc
+    .uart_write = uart_write_stub,
+    .uart_flush = uart_flush_stub,
 };
 
 // init_chipset requests hardware info, and based on it loads the right chipset. Currently only the
@@ -0,0 +1,50 @@
+#include <chipset.h>
+#include <fiq.h>
+#include <interrupt.h>
+#include <mmio.h>
+#include <vm2.h>
+
+// Where the FIQ vector (see init_vector_table) loads its handler address from
+#define FIQ_VECTOR_ADDRESS (HIGH_VECTOR_LOCATION + 0x3C)
+
+static bool fiq_installed = false;
+
+bool fiq_install(uint32_t irq, FiqHandler handler, uint32_t r8, uint32_t r9) {
+    if (fiq_installed) { return false; }
+
+    int cpsr = disable_interrupt_save(FIQ);
+
+    fiq_set_registers(r8, r9);
+    mmio_write(FIQ_VECTOR_ADDRESS, handler);
+
+    bool routed = chipset.route_fiq(irq);
+    if (routed) {
+        fiq_installed = true;
+    } else {
+        mmio_write(FIQ_VECTOR_ADDRESS, &fiq_handler);
+    }
+
+    restore_proc_status(cpsr);
+
+    return routed;
+}
+
+void fiq_uninstall(uint32_t irq) {
+    int cpsr = disable_interrupt_save(FIQ);
+
+    chipset.unroute_fiq(irq);
+    mmio_write(FIQ_VECTOR_ADDRESS, &fiq_handler);
+    fiq_installed = false;
+
+    restore_proc_status(cpsr);
+}
+
+bool fiq_ring_pop(struct FiqRing * ring, uint32_t * value) {
+    const uint32_t tail = ring->tail;
+    if (tail == ring->head) { return false; }
+
+    *value = ring->data[tail & (FIQ_RING_SIZE - 1)];
+    ring->tail = tail + 1;
+
+    return true;
+}
@@ -0,0 +1,84 @@
+// FIQ handlers, see fiq.h.
+//
+// These run directly from the FIQ vector. They only use the banked registers r8-r12, so nothing has
+// to be saved. r8 and r9 are set up by fiq_install and keep their value, r10-r12 are scratch.
+
+.equ FIQ_RING_SIZE, 64
+
+// Offsets into struct FiqRing
+.equ RING_HEAD, 0
+.equ RING_TAIL, 4
+.equ RING_OVERFLOWS, 8
+.equ RING_DATA, 12
+
+// Offsets and flags of the PL011 uart
+.equ UART_DR, 0x00
+.equ UART_FR, 0x18
+.equ UART_ICR, 0x44
+.equ UART_FR_RXFE, (1 << 4)
+.equ UART_INT_RX, (1 << 4)
+.equ UART_INT_RT, (1 << 6)
+
+// Pushes reg into the ring pointed to by r8. Clobbers r11 and r12.
+.macro FIQ_RING_PUSH reg
+    ldr r11, [r8, #RING_HEAD]
+    ldr r12, [r8, #RING_TAIL]
+    sub r12, r11, r12
+    cmp r12, #FIQ_RING_SIZE
+    bhs ring_full\@
+    and r12, r11, #(FIQ_RING_SIZE - 1)
+    add r12, r8, r12, lsl #2
+    str \reg, [r12, #RING_DATA]
+    add r11, r11, #1
+    str r11, [r8, #RING_HEAD]
+    b ring_done\@
+ring_full\@:
+    ldr r12, [r8, #RING_OVERFLOWS]
+    add r12, r12, #1
+    str r12, [r8, #RING_OVERFLOWS]
+ring_done\@:
+.endm
+
+.text
+
+// void fiq_uart_rx_handler()
+// r8: ring, r9: uart base
+.global fiq_uart_rx_handler
+fiq_uart_rx_handler:
+    ldr r10, [r9, #UART_FR]
+    tst r10, #UART_FR_RXFE
+    bne fiq_uart_rx_done
+    // The data register also holds the error bits of this byte
+    ldr r10, [r9, #UART_DR]
+    FIQ_RING_PUSH r10
+    b fiq_uart_rx_handler
+fiq_uart_rx_done:
+    mov r10, #(UART_INT_RX | UART_INT_RT)
+    str r10, [r9, #UART_ICR]
+    subs pc, lr, #4
+
+// void fiq_timer_handler()
+// r8: ring
+.global fiq_timer_handler
+fiq_timer_handler:
+    // CNTVCT - CNTV_CVAL, only the low words matter for a latency
+    mrrc p15, 1, r10, r11, c14
+    mrrc p15, 3, r12, r11, c14
+    sub r10, r10, r12
+    // Mask the timer (CNTV_CTL = IMASK | ENABLE) so the interrupt goes away
+    mov r12, #3
+    mcr p15, 0, r12, c14, c3, 1
+    FIQ_RING_PUSH r10
+    subs pc, lr, #4
+
+// void fiq_set_registers(uint32_t r8, uint32_t r9)
+.global fiq_set_registers
+fiq_set_registers:
+    // r8-r14 are banked in FIQ mode, so the mode to return to is kept in r2
+    mrs r2, cpsr
+    // Switch to FIQ mode with FIQs masked
+    cpsid if, #0x11
+    mov r8, r0
+    mov r9, r1
+    msr cpsr_c, r2
+    bx lr
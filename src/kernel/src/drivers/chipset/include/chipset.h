@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <timer_wheel.h>
 
 /*
  * Abstract chipset driver interface
@@ -16,13 +17,45 @@ void uart_putc(char c, int channel);
 typedef size_t TimerHandle;
 typedef void (*TimerCallback)();
 
-typedef void (*UartCallback)(char c);
+// A timer that lives in the caller's memory, see start_timer. It must be zeroed before first use.
+typedef struct Timer {
+    // Must be the first member, the driver turns wheel entries back into timers
+    struct TimerWheelEntry entry;
+    TimerCallback callback;
+    // Counter ticks between two runs of a periodic timer, 0 for a one shot timer
+    uint64_t period;
+    // The timer may run up to slack_ms later than requested, so it can share an interrupt with
+    // other timers. Set before starting the timer.
+    uint32_t slack_ms;
+    // Exact deadline and slack in counter ticks
+    uint64_t expires;
+    uint64_t slack;
+    // Set for the timers behind a TimerHandle, which are freed by the driver
+    bool handle_timer;
+#ifdef ENABLE_TESTS
+    // Set for timers on the simulated clock of the tests
+    bool virtual_time;
+#endif
+} Timer;
+
+// Called with a batch of received bytes
+typedef void (*UartCallback)(const char * data, size_t length);
 
 typedef struct ChipsetInterface {
     /// Timer Functions
     TimerHandle (*schedule_timer_periodic)(TimerCallback callback, uint32_t ms);
     TimerHandle (*schedule_timer_once)(TimerCallback callback, uint32_t ms);
     void (*deschedule_timer)(TimerHandle handle);
+    // Like the two above, but the callback may run up to slack_ms late. Timers whose slack windows
+    // overlap are run from a single interrupt.
+    TimerHandle (*schedule_timer_with_slack)(TimerCallback callback, uint32_t delay_ms,
+                                             uint32_t slack_ms, bool periodic);
+
+    // Same as above, but with a timer provided by the caller. These never allocate, so they can
+    // be used from interrupt handlers. Starting a running timer restarts it, stopping a timer that
+    // isn't running does nothing.
+    void (*start_timer)(Timer * timer, TimerCallback callback, uint32_t delay_ms, bool periodic);
+    void (*stop_timer)(Timer * timer);
 
     /// UART Functions
     // Prints a character to a uart channel.
@@ -33,14 +66,33 @@ typedef struct ChipsetInterface {
     // channel 0.
     void (*uart_putc)(char c, int uartchannel);
 
-    // The callback given to this function is called any time a uart message
-    // is received on the channel. The same rules apply as for puts. When a channel
+    // Same as uart_putc, for a whole buffer. May return before the bytes are actually sent.
+    void (*uart_write)(const char * data, size_t length, int uartchannel);
+
+    // Waits until everything given to uart_write has been sent.
+    void (*uart_flush)();
+
+    // The callback given to this function is called any time uart bytes
+    // are received on the channel. The same rules apply as for puts. When a channel
     // is requested that does not exist, input from channel zero shall be given to this callback.
     void (*uart_on_message)(UartCallback callback, int uartchannel);
 
+    // Stops calling a callback given to uart_on_message.
+    void (*uart_off_message)(UartCallback callback, int uartchannel);
+
     void (*handle_irq)();
     void (*handle_fiq)();
 
+    // Enable or disable an interrupt source in the interrupt controller. See irq.h for the
+    // numbering. Drivers normally use irq_register/irq_unregister instead.
+    void (*enable_irq)(uint32_t irq);
+    void (*disable_irq)(uint32_t irq);
+
+    // Deliver an interrupt source as FIQ instead of IRQ, see fiq.h. route_fiq returns false if the
+    // source can't be routed as FIQ.
+    bool (*route_fiq)(uint32_t irq);
+    void (*unroute_fiq)(uint32_t irq);
+
     // Called for every chipset after interrupts and dynamic memory has been enabled
     // So the chipset can do some more initialization.
     void (*late_init)();
@@ -0,0 +1,59 @@
+#ifndef FIQ_H
+#define FIQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Fast interrupts.
+///
+/// One interrupt source at a time can be delivered as FIQ instead of IRQ. Its handler is written in
+/// assembly and installed directly at the FIQ vector. FIQ mode has its own copies of r8-r12, so a
+/// handler that only uses those needs no stack and saves nothing: [fiq_install] loads r8 and r9
+/// with whatever the handler needs (pointers to its ring buffer and device registers) once, and
+/// they keep their values between interrupts. r10-r12 are scratch registers.
+///
+/// The handlers below push what they read into a [FiqRing]. Normal code drains it with
+/// [fiq_ring_pop]. Since a FIQ can't safely call into the rest of the kernel, consumers have to
+/// poll (for example from a timer or the irq handler of the same device).
+
+#define FIQ_RING_SIZE 64  // Must be a power of 2, see fiq.s
+
+/// Single producer (the FIQ handler), single consumer ring buffer.
+/// The layout is used by fiq.s, keep them in sync.
+struct FiqRing {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    /// Number of values dropped because the ring was full
+    volatile uint32_t overflows;
+    volatile uint32_t data[FIQ_RING_SIZE];
+};
+
+typedef void (*FiqHandler)();
+
+/// Installs handler at the FIQ vector with banked r8 and r9 set to the arguments, and routes the
+/// interrupt source irq (see irq.h) to the FIQ. Returns false if another source is already
+/// installed or the chipset can't route this source as FIQ.
+bool fiq_install(uint32_t irq, FiqHandler handler, uint32_t r8, uint32_t r9);
+
+/// Stops delivering the source as FIQ and restores the default FIQ handler. The source stays
+/// disabled until it is enabled again, for example with irq_register.
+void fiq_uninstall(uint32_t irq);
+
+/// Takes the oldest value out of the ring. Returns false if it is empty.
+bool fiq_ring_pop(struct FiqRing * ring, uint32_t * value);
+
+/// Handlers (see fiq.s)
+
+/// Reads all available bytes from a PL011 uart into the ring.
+/// r8: the FiqRing, r9: the base address of the uart.
+void fiq_uart_rx_handler();
+
+/// Virtual generic timer. Pushes how many counter ticks passed between the compare value and the
+/// start of the handler (the interrupt latency) into the ring, and masks the timer again.
+/// r8: the FiqRing.
+void fiq_timer_handler();
+
+// Sets the banked FIQ registers r8 and r9 (fiq.s)
+void fiq_set_registers(uint32_t r8, uint32_t r9);
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Chipset independent interrupt dispatch.
+///
+/// Every interrupt source has a number below NR_IRQS (the chipset decides which number belongs to
+/// which device, see bcm2836.h and bcm2835.h). Drivers register a handler for their source with
+/// [irq_register]. The chipset's irq handler reads the pending bits of its interrupt controller(s)
+/// and passes them to [irq_dispatch_pending], which calls the handler of every pending source.
+///
+/// Handlers run in the "top half": interrupts are disabled and they should only acknowledge the
+/// device and grab whatever data can't wait. Anything else is deferred to a softirq with
+/// [softirq_raise]. Pending softirqs run when the interrupt is done (after the device has been
+/// acknowledged), with interrupts enabled again.
+///
+/// The dispatcher times every handler with the physical counter (CNTPCT) and keeps log2
+/// histograms of the handler durations, of how long each interrupt kept interrupts masked and of
+/// how late timer interrupts were entered. [irq_stats_dump] prints them.
+
+#define NR_IRQS 128
+
+/// Bucket 0 counts values of 0, bucket n > 0 values in [2^(n-1), 2^n). The last bucket also
+/// counts everything that is bigger.
+#define IRQ_HISTOGRAM_BUCKETS 24
+
+/// Durations in counter ticks
+struct IrqHistogram {
+    uint32_t buckets[IRQ_HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+};
+
+typedef void (*IrqHandler)(void * ctx);
+
+struct IrqAction {
+    IrqHandler handler;
+    void * ctx;
+    /// How often this source fired
+    uint32_t count;
+    /// How long the handler ran
+    struct IrqHistogram duration;
+};
+
+/// Registers the handler for an interrupt source and enables the source in the interrupt
+/// controller. Returns false if the source doesn't exist or already has a handler.
+bool irq_register(uint32_t irq, IrqHandler handler, void * ctx);
+
+/// Disables the source and removes its handler.
+void irq_unregister(uint32_t irq);
+
+/// Calls the handler of interrupt source `base + n` for every bit n set in pending.
+/// Used by the chipset irq handlers.
+void irq_dispatch_pending(uint32_t base, uint32_t pending);
+
+/// How often an interrupt source fired since boot.
+uint32_t irq_count(uint32_t irq);
+
+/// Called by irq_handler when an interrupt is entered and when the top half is done.
+void irq_enter();
+void irq_exit();
+
+/// Called by timer interrupt handlers with the compare value the timer was programmed with. Records
+/// how long after this deadline the interrupt was entered.
+void irq_record_timer_latency(uint64_t deadline);
+
+/// Adds a value to a histogram.
+void irq_histogram_add(struct IrqHistogram * histogram, uint64_t value);
+
+/// Statistics of the handler of a source, of the time interrupts were masked and of the timer
+/// latency. NULL if the source doesn't exist.
+const struct IrqHistogram * irq_duration_histogram(uint32_t irq);
+const struct IrqHistogram * irq_masked_histogram();
+const struct IrqHistogram * irq_timer_latency_histogram();
+
+/// Prints all non-empty histograms.
+void irq_stats_dump();
+
+/// Deferred work. Lower numbers run first.
+enum Softirq {
+    SOFTIRQ_TIMER,
+    SOFTIRQ_UART,
+    SOFTIRQ_LOG,
+#ifdef ENABLE_TESTS
+    SOFTIRQ_TEST,
+#endif
+    NR_SOFTIRQS,
+};
+
+typedef void (*SoftirqHandler)(void * ctx);
+
+/// Sets the function that runs when softirq nr is raised.
+void softirq_register(enum Softirq nr, SoftirqHandler handler, void * ctx);
+
+/// Marks a softirq as pending. Raising it multiple times before it runs runs it once.
+/// Can be called from interrupt handlers and from normal kernel code.
+void softirq_raise(enum Softirq nr);
+
+/// Runs all pending softirqs with interrupts enabled. Called at the end of every interrupt, with
+/// interrupts disabled. Does nothing when called from within a softirq.
+void softirq_run();
+
+#endif
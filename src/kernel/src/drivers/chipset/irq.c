@@ -0,0 +1,182 @@
+#include <barrier.h>
+#include <chipset.h>
+#include <irq.h>
+#include <stdio.h>
+
+static struct IrqAction irq_actions[NR_IRQS];
+
+// Counter value when the current interrupt was entered
+static uint64_t irq_entry_count;
+static struct IrqHistogram irq_masked;
+static struct IrqHistogram irq_timer_latency;
+
+struct SoftirqAction {
+    SoftirqHandler handler;
+    void * ctx;
+};
+
+static struct SoftirqAction softirq_actions[NR_SOFTIRQS];
+static volatile uint32_t softirq_pending = 0;
+static bool softirq_active = false;
+
+// Reads CNTPCT
+static inline uint64_t read_counter() {
+    uint32_t low, high;
+    isb();
+    asm volatile("mrrc p15, 0, %0, %1, c14" : "=r"(low), "=r"(high));
+    return ((uint64_t)high << 32u) | low;
+}
+
+bool irq_register(uint32_t irq, IrqHandler handler, void * ctx) {
+    if (irq >= NR_IRQS || handler == NULL || irq_actions[irq].handler != NULL) { return false; }
+
+    // The statistics of the previous handler are kept
+    irq_actions[irq].handler = handler;
+    irq_actions[irq].ctx = ctx;
+
+    chipset.enable_irq(irq);
+
+    return true;
+}
+
+void irq_unregister(uint32_t irq) {
+    if (irq >= NR_IRQS) { return; }
+
+    chipset.disable_irq(irq);
+    irq_actions[irq].handler = NULL;
+    irq_actions[irq].ctx = NULL;
+}
+
+uint32_t irq_count(uint32_t irq) {
+    if (irq >= NR_IRQS) { return 0; }
+    return irq_actions[irq].count;
+}
+
+void irq_dispatch_pending(uint32_t base, uint32_t pending) {
+    while (pending != 0) {
+        // Highest pending bit first, clz is a single instruction.
+        const uint32_t bit = 31u - __builtin_clz(pending);
+        pending &= ~(1u << bit);
+
+        struct IrqAction * action = &irq_actions[base + bit];
+        action->count++;
+
+        if (action->handler != NULL) {
+            const uint64_t start = read_counter();
+            action->handler(action->ctx);
+            irq_histogram_add(&action->duration, read_counter() - start);
+        } else {
+            // Nobody will acknowledge this source, so keep it from firing again.
+            chipset.disable_irq(base + bit);
+            WARN("Unhandled interrupt %u", base + bit);
+        }
+    }
+}
+
+void irq_enter() {
+    irq_entry_count = read_counter();
+}
+
+void irq_exit() {
+    irq_histogram_add(&irq_masked, read_counter() - irq_entry_count);
+}
+
+void irq_record_timer_latency(uint64_t deadline) {
+    const uint64_t latency = irq_entry_count > deadline ? irq_entry_count - deadline : 0;
+    irq_histogram_add(&irq_timer_latency, latency);
+}
+
+void irq_histogram_add(struct IrqHistogram * histogram, uint64_t value) {
+    const uint32_t clamped = value > UINT32_MAX ? UINT32_MAX : (uint32_t)value;
+    uint32_t bucket = clamped == 0 ? 0 : 32u - __builtin_clz(clamped);
+    if (bucket >= IRQ_HISTOGRAM_BUCKETS) { bucket = IRQ_HISTOGRAM_BUCKETS - 1; }
+
+    histogram->buckets[bucket]++;
+    histogram->count++;
+    if (clamped > histogram->max) { histogram->max = clamped; }
+}
+
+const struct IrqHistogram * irq_duration_histogram(uint32_t irq) {
+    if (irq >= NR_IRQS) { return NULL; }
+    return &irq_actions[irq].duration;
+}
+
+const struct IrqHistogram * irq_masked_histogram() {
+    return &irq_masked;
+}
+
+const struct IrqHistogram * irq_timer_latency_histogram() {
+    return &irq_timer_latency;
+}
+
+static void irq_histogram_dump(const char * name, uint32_t irq, const struct IrqHistogram * h) {
+    if (h->count == 0) { return; }
+
+    kprintf("  %s", name);
+    if (irq < NR_IRQS) { kprintf(" %u", irq); }
+    kprintf(": %u samples, max %u\n", h->count, h->max);
+
+    for (uint32_t bucket = 0; bucket < IRQ_HISTOGRAM_BUCKETS; bucket++) {
+        if (h->buckets[bucket] == 0) { continue; }
+
+        if (bucket == 0) {
+            kprintf("    0: %u\n", h->buckets[bucket]);
+        } else if (bucket == IRQ_HISTOGRAM_BUCKETS - 1) {
+            kprintf("    >= %u: %u\n", 1u << (bucket - 1), h->buckets[bucket]);
+        } else {
+            const uint32_t low = 1u << (bucket - 1);
+            kprintf("    %u - %u: %u\n", low, 2 * low - 1, h->buckets[bucket]);
+        }
+    }
+}
+
+void irq_stats_dump() {
+    kprintf("Interrupt statistics (counter ticks):\n");
+    irq_histogram_dump("masked", NR_IRQS, &irq_masked);
+    irq_histogram_dump("timer latency", NR_IRQS, &irq_timer_latency);
+    for (uint32_t irq = 0; irq < NR_IRQS; irq++) {
+        irq_histogram_dump("handler", irq, &irq_actions[irq].duration);
+    }
+}
+
+void softirq_register(enum Softirq nr, SoftirqHandler handler, void * ctx) {
+    softirq_actions[nr] = (struct SoftirqAction){
+        .handler = handler,
+        .ctx = ctx,
+    };
+}
+
+void softirq_raise(enum Softirq nr) {
+    // Interrupts are off for the read-modify-write, so a handler raising a softirq at the same time
+    // can't lose its bit.
+    uint32_t cpsr;
+    asm volatile("mrs %0, cpsr\ncpsid i" : "=r"(cpsr)::"memory");
+    softirq_pending |= 1u << nr;
+    asm volatile("msr cpsr_c, %0" ::"r"(cpsr) : "memory");
+}
+
+void softirq_run() {
+    // Interrupts that arrive while softirqs run leave their work to the loop below.
+    if (softirq_active) { return; }
+    softirq_active = true;
+
+    while (softirq_pending != 0) {
+        uint32_t pending = softirq_pending;
+        softirq_pending = 0;
+
+        asm volatile("cpsie i" ::: "memory");
+
+        while (pending != 0) {
+            const uint32_t nr = __builtin_ctz(pending);
+            pending &= ~(1u << nr);
+
+            if (softirq_actions[nr].handler != NULL) {
+                softirq_actions[nr].handler(softirq_actions[nr].ctx);
+            }
+        }
+
+        asm volatile("cpsid i" ::: "memory");
+    }
+
+    softirq_active = false;
+}
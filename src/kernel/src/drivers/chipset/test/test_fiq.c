@@ -0,0 +1,113 @@
+#include <barrier.h>
+#include <bcm2836.h>
+#include <bench.h>
+#include <fiq.h>
+#include <irq.h>
+#include <test.h>
+
+// The kernel schedules its timers on the physical timer, so the virtual timer is free for these.
+#define LATENCY_ITERATIONS 100
+// Ticks between arming the timer and its deadline
+#define LATENCY_DELAY 100
+
+static struct FiqRing ring;
+
+static uint64_t get_virtual_count() {
+    uint32_t low, high;
+    isb();
+    asm volatile("mrrc p15, 1, %0, %1, c14" : "=r"(low), "=r"(high));
+    return ((uint64_t)high << 32u) | low;
+}
+
+static uint64_t get_virtual_compare() {
+    uint32_t low, high;
+    asm volatile("mrrc p15, 3, %0, %1, c14" : "=r"(low), "=r"(high));
+    return ((uint64_t)high << 32u) | low;
+}
+
+static void set_virtual_compare(uint64_t value) {
+    asm volatile("mcrr p15, 3, %0, %1, c14" ::"r"((uint32_t)value), "r"((uint32_t)(value >> 32u)));
+}
+
+static void set_virtual_control(uint32_t value) {
+    asm volatile("mcr p15, 0, %0, c14, c3, 1" ::"r"(value));
+    isb();
+}
+
+// Same as fiq_timer_handler, but as a normal irq handler
+static void irq_timer_handler(void * ctx) {
+    struct FiqRing * r = ctx;
+    const uint32_t latency = (uint32_t)(get_virtual_count() - get_virtual_compare());
+    r->data[r->head & (FIQ_RING_SIZE - 1)] = latency;
+    set_virtual_control(3);
+    r->head++;
+}
+
+// Arms the virtual timer LATENCY_ITERATIONS times and returns the sum of the latencies the
+// handler measured.
+static uint64_t measure_timer_latency() {
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i < LATENCY_ITERATIONS; i++) {
+        set_virtual_compare(get_virtual_count() + LATENCY_DELAY);
+        set_virtual_control(1);
+
+        uint32_t latency;
+        while (!fiq_ring_pop(&ring, &latency)) {}
+        total += latency;
+    }
+
+    set_virtual_control(0);
+    return total;
+}
+
+TEST_CREATE(test_fiq_ring, {
+    ring.head = ring.tail = ring.overflows = 0;
+
+    uint32_t value;
+    ASSERT(!fiq_ring_pop(&ring, &value));
+
+    ring.data[0] = 42;
+    ring.data[1] = 43;
+    ring.head = 2;
+
+    ASSERT(fiq_ring_pop(&ring, &value));
+    ASSERT_EQ(value, 42);
+    ASSERT(fiq_ring_pop(&ring, &value));
+    ASSERT_EQ(value, 43);
+    ASSERT(!fiq_ring_pop(&ring, &value));
+})
+
+TEST_CREATE(test_fiq_install, {
+    ring.head = ring.tail = ring.overflows = 0;
+
+    ASSERT(fiq_install(BCM2836_IRQ_CNTV, fiq_timer_handler, (uint32_t)&ring, 0));
+    // Only one source can be the FIQ
+    ASSERT(!fiq_install(BCM2836_IRQ_CNTV, fiq_timer_handler, (uint32_t)&ring, 0));
+
+    // Fire once right away
+    set_virtual_compare(get_virtual_count());
+    set_virtual_control(1);
+
+    uint32_t latency;
+    while (!fiq_ring_pop(&ring, &latency)) {}
+    ASSERT_EQ(ring.overflows, 0);
+
+    fiq_uninstall(BCM2836_IRQ_CNTV);
+    set_virtual_control(0);
+})
+
+TEST_CREATE(bench_fiq_vs_irq_latency, {
+    ring.head = ring.tail = ring.overflows = 0;
+
+    ASSERT(fiq_install(BCM2836_IRQ_CNTV, fiq_timer_handler, (uint32_t)&ring, 0));
+    const uint64_t fiq_total = measure_timer_latency();
+    fiq_uninstall(BCM2836_IRQ_CNTV);
+
+    ASSERT(irq_register(BCM2836_IRQ_CNTV, irq_timer_handler, &ring));
+    const uint64_t irq_total = measure_timer_latency();
+    irq_unregister(BCM2836_IRQ_CNTV);
+
+    bench_report("fiq entry latency", fiq_total, LATENCY_ITERATIONS);
+    bench_report("irq entry latency", irq_total, LATENCY_ITERATIONS);
+})
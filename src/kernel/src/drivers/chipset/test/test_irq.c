@@ -0,0 +1,110 @@
+#include <bcm2835.h>
+#include <irq.h>
+#include <string.h>
+#include <test.h>
+
+// No device has a number after the BCM2835 sources, and bcm2836_enable_irq/disable_irq ignore
+// them, so the tests can dispatch these without unmasking real interrupts.
+#define TEST_IRQ_BASE  BCM2835_IRQ_END
+#define TEST_IRQ_COUNT (NR_IRQS - TEST_IRQ_BASE)
+#define TEST_IRQ_LAST  (TEST_IRQ_COUNT - 1)
+
+static uint32_t irq_calls;
+static void * irq_last_ctx;
+
+static void test_irq_handler(void * ctx) {
+    irq_calls++;
+    irq_last_ctx = ctx;
+}
+
+static uint32_t softirq_calls;
+
+static void test_softirq_handler(void * ctx) {
+    softirq_calls++;
+}
+
+TEST_CREATE(test_irq_register, {
+    int ctx;
+
+    ASSERT(irq_register(TEST_IRQ_BASE, test_irq_handler, &ctx));
+    ASSERT(!irq_register(TEST_IRQ_BASE, test_irq_handler, NULL));
+    ASSERT(!irq_register(NR_IRQS, test_irq_handler, NULL));
+
+    irq_unregister(TEST_IRQ_BASE);
+    ASSERT(irq_register(TEST_IRQ_BASE, test_irq_handler, NULL));
+    irq_unregister(TEST_IRQ_BASE);
+})
+
+TEST_CREATE(test_irq_dispatch_simultaneous, {
+    int ctx;
+    irq_calls = 0;
+
+    irq_register(TEST_IRQ_BASE + 1, test_irq_handler, &ctx);
+    irq_register(TEST_IRQ_BASE + 5, test_irq_handler, &ctx);
+    irq_register(TEST_IRQ_BASE + TEST_IRQ_LAST, test_irq_handler, &ctx);
+    uint32_t count = irq_count(TEST_IRQ_BASE + 5);
+
+    // All pending sources are handled, not just the first
+    irq_dispatch_pending(TEST_IRQ_BASE, (1u << 1u) | (1u << 5u) | (1u << TEST_IRQ_LAST));
+    ASSERT_EQ(irq_calls, 3);
+    ASSERT_EQ(irq_last_ctx, &ctx);
+    ASSERT_EQ(irq_count(TEST_IRQ_BASE + 5), count + 1);
+
+    irq_unregister(TEST_IRQ_BASE + 1);
+    irq_unregister(TEST_IRQ_BASE + 5);
+    irq_unregister(TEST_IRQ_BASE + TEST_IRQ_LAST);
+})
+
+TEST_CREATE(test_softirq_run, {
+    softirq_calls = 0;
+    softirq_register(SOFTIRQ_TEST, test_softirq_handler, NULL);
+
+    // Raising twice before it runs runs it once
+    softirq_raise(SOFTIRQ_TEST);
+    softirq_raise(SOFTIRQ_TEST);
+
+    // softirq_run expects to be called at the end of an interrupt, with interrupts disabled
+    asm volatile("cpsid i");
+    softirq_run();
+    asm volatile("cpsie i");
+
+    ASSERT_EQ(softirq_calls, 1);
+
+    softirq_register(SOFTIRQ_TEST, NULL, NULL);
+})
+
+TEST_CREATE(test_irq_histogram, {
+    struct IrqHistogram histogram;
+    memset(&histogram, 0, sizeof(histogram));
+
+    irq_histogram_add(&histogram, 0);
+    irq_histogram_add(&histogram, 1);
+    irq_histogram_add(&histogram, 5);
+    irq_histogram_add(&histogram, 7);
+    irq_histogram_add(&histogram, 0x100000000ull);
+
+    ASSERT_EQ(histogram.count, 5);
+    ASSERT_EQ(histogram.max, UINT32_MAX);
+    ASSERT_EQ(histogram.buckets[0], 1);
+    ASSERT_EQ(histogram.buckets[1], 1);
+    // 5 and 7 are in [4, 8)
+    ASSERT_EQ(histogram.buckets[3], 2);
+    ASSERT_EQ(histogram.buckets[IRQ_HISTOGRAM_BUCKETS - 1], 1);
+})
+
+// Only used by test_irq_handler_duration, so no other test adds samples to its histogram
+#define TEST_IRQ_DURATION 2
+
+TEST_CREATE(test_irq_handler_duration, {
+    const uint32_t irq = TEST_IRQ_BASE + TEST_IRQ_DURATION;
+    ASSERT_GTEQ(irq, BCM2835_IRQ_END);
+    const uint32_t samples = irq_duration_histogram(irq)->count;
+
+    irq_register(irq, test_irq_handler, NULL);
+    irq_dispatch_pending(TEST_IRQ_BASE, 1u << TEST_IRQ_DURATION);
+    irq_dispatch_pending(TEST_IRQ_BASE, 1u << TEST_IRQ_DURATION);
+    irq_unregister(irq);
+
+    ASSERT_EQ(irq_duration_histogram(irq)->count, samples + 2);
+    ASSERT(!irq_duration_histogram(NR_IRQS));
+})
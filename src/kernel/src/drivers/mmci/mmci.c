@@ -19,6 +19,8 @@
  */
 #include <klibc.h>
 #include <mmci.h>
+#include <mmio.h>
+#include <string.h>
 
 // MMCI Definitions - Used to access SD card registers; DO NOT CHANGE!
 #define MMCI_BASE 0x10005000
@@ -242,10 +244,13 @@ int push_bytes(void * buffer) {
     // Clear out FIFO and set to write
     run_mmci(DCTRL, DISABLE);
     run_mmci(DCTRL, SET_WRITE);
-    int i = 0;
+    uint8_t * bytes = buffer;
     while (WRITE_CNT) {
-        run_mmci(FIFO, ((uint32_t *)buffer)[i]);
-        i++;
+        // The buffer may be any type, so it's not accessed through a uint32_t pointer
+        uint32_t word;
+        memcpy(&word, bytes, sizeof(word));
+        run_mmci(FIFO, word);
+        bytes += sizeof(word);
     }
 
     // Return that the push succeeded for now
@@ -272,10 +277,11 @@ int push_bytes(void * buffer) {
  * register
  */
 int pull_bytes(void * buffer) {
-    int i = 0;
+    uint8_t * bytes = buffer;
     while (READ_CNT) {
-        ((uint32_t *)buffer)[i] = read_mmci(FIFO);
-        i++;
+        const uint32_t word = read_mmci(FIFO);
+        memcpy(bytes, &word, sizeof(word));
+        bytes += sizeof(word);
     }
 
     // Return that the pull succeeded for now
@@ -300,8 +306,7 @@ int pull_bytes(void * buffer) {
  *                 on the register when running a specific command
  */
 void run_mmci(uint32_t cmd, uint32_t args) {
-    uint32_t reg_address = MMCI_BASE + cmd;
-    asm volatile("str %0,[%1]" : : "r"(args), "r"(reg_address));
+    mmio_write(MMCI_BASE + cmd, args);
 }
 
 /**
@@ -320,10 +325,7 @@ void run_mmci(uint32_t cmd, uint32_t args) {
  * Returns the value stored in the target register as an integer value
  */
 uint32_t read_mmci(uint32_t target) {
-    uint32_t response;
-    uint32_t reg_address = MMCI_BASE + target;
-    asm volatile("ldr %0,[%1]" : "=r"(response) : "r"(reg_address));
-    return response;
+    return mmio_read(MMCI_BASE + target);
 }
 
 /**
@@ -45,6 +45,12 @@ void hashmap__init(struct HashMap * map,
     map->cap = 0;
     map->cap_bits = 0;
     map->sz = 0;
+
+    map->incremental = false;
+    map->old_buckets = NULL;
+    map->old_cap = 0;
+    map->old_cap_bits = 0;
+    map->rehash_idx = 0;
 }
 
 struct HashMap * hashmap__new(hashmap_hash_fn hash_fn,
@@ -70,7 +76,10 @@ void hashmap__clear(struct HashMap * map) {
     }
 
     kfree(map->buckets);
+    kfree(map->old_buckets);
+    map->buckets = map->old_buckets = NULL;
     map->cap = map->cap_bits = map->sz = 0;
+    map->old_cap = map->old_cap_bits = map->rehash_idx = 0;
 }
 
 void hashmap__free(struct HashMap * map) {
@@ -88,6 +97,32 @@ size_t hashmap__capacity(const struct HashMap * map) {
     return map->cap;
 }
 
+/* moves up to count buckets of the old bucket array to the new one */
+static void hashmap_rehash_step(struct HashMap * map, size_t count) {
+    struct hashmap_entry *cur, *tmp;
+    size_t h;
+
+    while (map->old_buckets && count-- > 0) {
+        for (cur = map->old_buckets[map->rehash_idx]; cur; cur = tmp) {
+            tmp = cur->next;
+            h = hash_bits(map->hash_fn(cur->key, map->ctx), map->cap_bits);
+            hashmap_add_entry(&map->buckets[h], cur);
+        }
+        map->old_buckets[map->rehash_idx] = NULL;
+
+        if (++map->rehash_idx == map->old_cap) {
+            kfree(map->old_buckets);
+            map->old_buckets = NULL;
+            map->old_cap = map->old_cap_bits = map->rehash_idx = 0;
+        }
+    }
+}
+
+void hashmap__set_incremental(struct HashMap * map, bool incremental) {
+    if (!incremental) hashmap_rehash_step(map, map->old_cap);
+    map->incremental = incremental;
+}
+
 static bool hashmap_needs_to_grow(struct HashMap * map) {
     /* grow if empty or more than 75% filled */
     return (map->cap == 0) || ((map->sz + 1) * 4 / 3 > map->cap);
@@ -107,6 +142,25 @@ static int hashmap_grow(struct HashMap * map) {
     new_buckets = kcalloc(new_cap, sizeof(new_buckets[0]));
     if (!new_buckets) return -1;
 
+    if (map->incremental && map->buckets) {
+        /*
+         * Normally the previous resize finished long ago: this one needed at least old_cap / 2
+         * more inserts, which move HASHMAP_REHASH_STEP buckets each.
+         */
+        hashmap_rehash_step(map, map->old_cap);
+
+        map->old_buckets = map->buckets;
+        map->old_cap = map->cap;
+        map->old_cap_bits = map->cap_bits;
+        map->rehash_idx = 0;
+
+        map->buckets = new_buckets;
+        map->cap = new_cap;
+        map->cap_bits = new_cap_bits;
+
+        return 0;
+    }
+
     hashmap__for_each_entry_safe(map, cur, tmp, bkt) {
         h = hash_bits(map->hash_fn(cur->key, map->ctx), new_cap_bits);
         hashmap_add_entry(&new_buckets[h], cur);
@@ -120,17 +174,14 @@ static int hashmap_grow(struct HashMap * map) {
     return 0;
 }
 
-static bool hashmap_find_entry(const struct HashMap * map,
-                               const void * key,
-                               size_t hash,
-                               struct hashmap_entry *** pprev,
-                               struct hashmap_entry ** entry) {
+static bool hashmap_find_in_bucket(const struct HashMap * map,
+                                   struct hashmap_entry ** bucket,
+                                   const void * key,
+                                   struct hashmap_entry *** pprev,
+                                   struct hashmap_entry ** entry) {
     struct hashmap_entry *cur, **prev_ptr;
 
-    if (!map->buckets) return false;
-
-    for (prev_ptr = &map->buckets[hash], cur = *prev_ptr; cur;
-         prev_ptr = &cur->next, cur = cur->next) {
+    for (prev_ptr = bucket, cur = *prev_ptr; cur; prev_ptr = &cur->next, cur = cur->next) {
         if (map->equal_fn(cur->key, key, map->ctx)) {
             if (pprev) *pprev = prev_ptr;
             *entry = cur;
@@ -141,6 +192,24 @@ static bool hashmap_find_entry(const struct HashMap * map,
     return false;
 }
 
+/* hash is the result of hash_fn, during an incremental resize both bucket arrays are checked */
+static bool hashmap_find_entry(const struct HashMap * map,
+                               const void * key,
+                               size_t hash,
+                               struct hashmap_entry *** pprev,
+                               struct hashmap_entry ** entry) {
+    if (!map->buckets) return false;
+
+    if (hashmap_find_in_bucket(
+            map, &map->buckets[hash_bits(hash, map->cap_bits)], key, pprev, entry)) {
+        return true;
+    }
+
+    return map->old_buckets &&
+           hashmap_find_in_bucket(
+               map, &map->old_buckets[hash_bits(hash, map->old_cap_bits)], key, pprev, entry);
+}
+
 int hashmap__insert(struct HashMap * map,
                     const void * key,
                     void * value,
@@ -154,7 +223,9 @@ int hashmap__insert(struct HashMap * map,
     if (old_key) *old_key = NULL;
     if (old_value) *old_value = NULL;
 
-    h = hash_bits(map->hash_fn(key, map->ctx), map->cap_bits);
+    hashmap_rehash_step(map, HASHMAP_REHASH_STEP);
+
+    h = map->hash_fn(key, map->ctx);
     if (strategy != HASHMAP_APPEND && hashmap_find_entry(map, key, h, NULL, &entry)) {
         if (old_key) *old_key = entry->key;
         if (old_value) *old_value = entry->value;
@@ -173,8 +244,6 @@ int hashmap__insert(struct HashMap * map,
     if (hashmap_needs_to_grow(map)) {
         err = hashmap_grow(map);
         if (err) { return err; }
-
-        h = hash_bits(map->hash_fn(key, map->ctx), map->cap_bits);
     }
 
     entry = kmalloc(sizeof(struct hashmap_entry));
@@ -183,7 +252,7 @@ int hashmap__insert(struct HashMap * map,
 
     entry->key = key;
     entry->value = value;
-    hashmap_add_entry(&map->buckets[h], entry);
+    hashmap_add_entry(&map->buckets[hash_bits(h, map->cap_bits)], entry);
 
     map->sz++;
 
@@ -192,10 +261,8 @@ int hashmap__insert(struct HashMap * map,
 
 bool hashmap__find(const struct HashMap * map, const void * key, void ** value) {
     struct hashmap_entry * entry;
-    size_t h;
 
-    h = hash_bits(map->hash_fn(key, map->ctx), map->cap_bits);
-    if (!hashmap_find_entry(map, key, h, NULL, &entry)) return false;
+    if (!hashmap_find_entry(map, key, map->hash_fn(key, map->ctx), NULL, &entry)) return false;
 
     if (value) *value = entry->value;
     return true;
@@ -206,10 +273,10 @@ bool hashmap__delete(struct HashMap * map,
                      const void ** old_key,
                      void ** old_value) {
     struct hashmap_entry **pprev, *entry;
-    size_t h;
 
-    h = hash_bits(map->hash_fn(key, map->ctx), map->cap_bits);
-    if (!hashmap_find_entry(map, key, h, &pprev, &entry)) return false;
+    hashmap_rehash_step(map, HASHMAP_REHASH_STEP);
+
+    if (!hashmap_find_entry(map, key, map->hash_fn(key, map->ctx), &pprev, &entry)) return false;
 
     if (old_key) *old_key = entry->key;
     if (old_value) *old_value = entry->value;
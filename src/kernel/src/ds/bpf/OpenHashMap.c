@@ -0,0 +1,311 @@
+/*
+ * Open addressing hash map with Robin Hood hashing, see OpenHashMap.h.
+ */
+
+#include "include/OpenHashMap.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* control bytes are compared a machine word at a time */
+#define GROUP_SIZE sizeof(size_t)
+#define GROUP_ONES ((size_t)0x0101010101010101ull)
+#define GROUP_HIGH ((size_t)0x8080808080808080ull)
+
+/* start with 8 slots, at least one group */
+#define OPENHASHMAP_MIN_CAP_BITS 3
+
+#define CTRL_EMPTY 0
+
+static inline size_t openhashmap_hash(const struct OpenHashMap * map, const void * key) {
+    return (size_t)(map->hash_fn(key, map->ctx) * 11400714819323198485llu);
+}
+
+/* the upper bits of the hash pick the slot, like hash_bits */
+static inline size_t openhashmap_home(const struct OpenHashMap * map, size_t hash) {
+    return hash >> (MACHINE_WORDSIZE - map->cap_bits);
+}
+
+/* the 7 bits below them go in the control byte */
+static inline uint8_t openhashmap_tag(const struct OpenHashMap * map, size_t hash) {
+    return 0x80 | ((hash >> (MACHINE_WORDSIZE - map->cap_bits - 7)) & 0x7f);
+}
+
+/* how far the entry in a used slot is from its home slot */
+static inline size_t openhashmap_distance(const struct OpenHashMap * map, size_t slot) {
+    return (slot - openhashmap_home(map, map->entries[slot].hash)) & (map->cap - 1);
+}
+
+static inline void openhashmap_set_ctrl(struct OpenHashMap * map, size_t slot, uint8_t ctrl) {
+    map->ctrl[slot] = ctrl;
+    if (slot < GROUP_SIZE - 1) map->ctrl[map->cap + slot] = ctrl;
+}
+
+static inline size_t openhashmap_load_group(const uint8_t * ctrl) {
+    size_t group;
+    __builtin_memcpy(&group, ctrl, sizeof(group));
+    return group;
+}
+
+/*
+ * High bit set in the bytes of the group that equal tag. A byte after a matching one can be
+ * reported too, the caller compares the full hash anyway.
+ */
+static inline size_t openhashmap_match_tag(size_t group, uint8_t tag) {
+    const size_t x = group ^ (GROUP_ONES * tag);
+    return (x - GROUP_ONES) & ~x & GROUP_HIGH;
+}
+
+/* high bit set in the empty bytes of the group, used slots always have it set */
+static inline size_t openhashmap_match_empty(size_t group) {
+    return ~group & GROUP_HIGH;
+}
+
+void openhashmap__init(struct OpenHashMap * map,
+                       hashmap_hash_fn hash_fn,
+                       hashmap_equal_fn equal_fn,
+                       FreeFunc free_key,
+                       FreeFunc free_data,
+                       void * ctx) {
+    map->hash_fn = hash_fn;
+    map->equal_fn = equal_fn;
+    map->freeData = free_data;
+    map->freeKey = free_key;
+    map->ctx = ctx;
+
+    map->entries = NULL;
+    map->ctrl = NULL;
+    map->cap = 0;
+    map->cap_bits = 0;
+    map->sz = 0;
+    map->max_load = OPENHASHMAP_DEFAULT_MAX_LOAD;
+}
+
+struct OpenHashMap * openhashmap__new(hashmap_hash_fn hash_fn,
+                                      hashmap_equal_fn equal_fn,
+                                      FreeFunc free_key,
+                                      FreeFunc free_data,
+                                      void * ctx) {
+    struct OpenHashMap * map = kmalloc(sizeof(struct OpenHashMap));
+
+    if (!map) return NULL;
+    openhashmap__init(map, hash_fn, equal_fn, free_key, free_data, ctx);
+    return map;
+}
+
+void openhashmap__clear(struct OpenHashMap * map) {
+    struct openhashmap_entry * cur;
+    size_t bkt;
+
+    openhashmap__for_each_entry(map, cur, bkt) {
+        map->freeKey((void *)cur->key);
+        map->freeData(cur->value);
+    }
+
+    kfree(map->entries);
+    map->entries = NULL;
+    map->ctrl = NULL;
+    map->cap = map->cap_bits = map->sz = 0;
+}
+
+void openhashmap__free(struct OpenHashMap * map) {
+    if (!map) return;
+
+    openhashmap__clear(map);
+    kfree(map);
+}
+
+size_t openhashmap__size(const struct OpenHashMap * map) {
+    return map->sz;
+}
+
+size_t openhashmap__capacity(const struct OpenHashMap * map) {
+    return map->cap;
+}
+
+int openhashmap__set_max_load(struct OpenHashMap * map, size_t percent) {
+    if (percent < OPENHASHMAP_MIN_MAX_LOAD || percent > OPENHASHMAP_MAX_MAX_LOAD) return -1;
+
+    map->max_load = percent;
+    return 0;
+}
+
+/*
+ * Puts an entry whose key is not in the map yet (or may be there more than once) in the first
+ * empty slot after its home. On the way it takes the slot of every entry that is closer to its own
+ * home, and continues with that entry instead.
+ */
+static void openhashmap_place(struct OpenHashMap * map, struct openhashmap_entry entry) {
+    const size_t mask = map->cap - 1;
+    size_t pos = openhashmap_home(map, entry.hash);
+    size_t dist = 0;
+
+    while (map->ctrl[pos] != CTRL_EMPTY) {
+        const size_t other_dist = openhashmap_distance(map, pos);
+        if (other_dist < dist) {
+            const struct openhashmap_entry other = map->entries[pos];
+            map->entries[pos] = entry;
+            openhashmap_set_ctrl(map, pos, openhashmap_tag(map, entry.hash));
+            entry = other;
+            dist = other_dist;
+        }
+
+        pos = (pos + 1) & mask;
+        dist++;
+    }
+
+    map->entries[pos] = entry;
+    openhashmap_set_ctrl(map, pos, openhashmap_tag(map, entry.hash));
+}
+
+static bool openhashmap_needs_to_grow(struct OpenHashMap * map) {
+    return (map->cap == 0) || ((map->sz + 1) * 100 > map->cap * map->max_load);
+}
+
+static int openhashmap_grow(struct OpenHashMap * map) {
+    struct openhashmap_entry * old_entries = map->entries;
+    const uint8_t * old_ctrl = map->ctrl;
+    const size_t old_cap = map->cap;
+    size_t new_cap_bits, new_cap;
+
+    new_cap_bits = map->cap_bits + 1;
+    if (new_cap_bits < OPENHASHMAP_MIN_CAP_BITS) new_cap_bits = OPENHASHMAP_MIN_CAP_BITS;
+    new_cap = 1UL << new_cap_bits;
+
+    /* every control byte starts out empty */
+    struct openhashmap_entry * new_entries =
+        kcalloc(new_cap * sizeof(struct openhashmap_entry) + new_cap + GROUP_SIZE - 1, 1);
+    if (!new_entries) return -1;
+
+    map->entries = new_entries;
+    map->ctrl = (uint8_t *)(new_entries + new_cap);
+    map->cap = new_cap;
+    map->cap_bits = new_cap_bits;
+
+    for (size_t i = 0; i < old_cap; i++) {
+        if (old_ctrl[i] != CTRL_EMPTY) openhashmap_place(map, old_entries[i]);
+    }
+
+    kfree(old_entries);
+
+    return 0;
+}
+
+static inline bool openhashmap_find_slot(const struct OpenHashMap * map,
+                                         const void * key,
+                                         size_t hash,
+                                         size_t * slot) {
+    if (!map->entries) return false;
+
+    const size_t mask = map->cap - 1;
+    const uint8_t tag = openhashmap_tag(map, hash);
+    size_t pos = openhashmap_home(map, hash);
+    size_t dist = 0;
+
+    while (true) {
+        const size_t group = openhashmap_load_group(map->ctrl + pos);
+
+        for (size_t match = openhashmap_match_tag(group, tag); match; match &= match - 1) {
+            const size_t i = (pos + __builtin_ctzl(match) / 8) & mask;
+            const struct openhashmap_entry * entry = &map->entries[i];
+            if (entry->hash == hash && map->equal_fn(entry->key, key, map->ctx)) {
+                *slot = i;
+                return true;
+            }
+        }
+
+        /* the entries of a key never continue past an empty slot */
+        if (openhashmap_match_empty(group)) return false;
+
+        /*
+         * Robin Hood: the key would have taken the slot of an entry that is closer to its home
+         * than the key would be, so it isn't in the rest of the table either.
+         */
+        const size_t last = (pos + GROUP_SIZE - 1) & mask;
+        if (openhashmap_distance(map, last) < dist + GROUP_SIZE - 1) return false;
+
+        pos = (pos + GROUP_SIZE) & mask;
+        dist += GROUP_SIZE;
+    }
+}
+
+int openhashmap__insert(struct OpenHashMap * map,
+                        const void * key,
+                        void * value,
+                        enum hashmap_insert_strategy strategy,
+                        const void ** old_key,
+                        void ** old_value) {
+    const size_t hash = openhashmap_hash(map, key);
+    size_t slot;
+    int err;
+
+    if (old_key) *old_key = NULL;
+    if (old_value) *old_value = NULL;
+
+    if (strategy != HASHMAP_APPEND && openhashmap_find_slot(map, key, hash, &slot)) {
+        struct openhashmap_entry * entry = &map->entries[slot];
+
+        if (old_key) *old_key = entry->key;
+        if (old_value) *old_value = entry->value;
+
+        if (strategy == HASHMAP_SET || strategy == HASHMAP_UPDATE) {
+            entry->key = key;
+            entry->value = value;
+            return 0;
+        } else if (strategy == HASHMAP_ADD) {
+            return -1;
+        }
+    }
+
+    if (strategy == HASHMAP_UPDATE) return -1;
+
+    if (openhashmap_needs_to_grow(map)) {
+        err = openhashmap_grow(map);
+        if (err) { return err; }
+    }
+
+    openhashmap_place(map, (struct openhashmap_entry){.key = key, .value = value, .hash = hash});
+    map->sz++;
+
+    return 0;
+}
+
+bool openhashmap__find(const struct OpenHashMap * map, const void * key, void ** value) {
+    size_t slot;
+
+    if (!openhashmap_find_slot(map, key, openhashmap_hash(map, key), &slot)) return false;
+
+    if (value) *value = map->entries[slot].value;
+    return true;
+}
+
+bool openhashmap__delete(struct OpenHashMap * map,
+                         const void * key,
+                         const void ** old_key,
+                         void ** old_value) {
+    size_t hole;
+
+    if (!openhashmap_find_slot(map, key, openhashmap_hash(map, key), &hole)) return false;
+
+    if (old_key) *old_key = map->entries[hole].key;
+    if (old_value) *old_value = map->entries[hole].value;
+
+    /*
+     * Backward shift: move the following entries one slot closer to their home, until an empty
+     * slot or an entry that already is at its home. Lookups stay correct without tombstones.
+     */
+    const size_t mask = map->cap - 1;
+    size_t next = (hole + 1) & mask;
+    while (map->ctrl[next] != CTRL_EMPTY && openhashmap_distance(map, next) != 0) {
+        map->entries[hole] = map->entries[next];
+        openhashmap_set_ctrl(map, hole, map->ctrl[next]);
+        hole = next;
+        next = (next + 1) & mask;
+    }
+    openhashmap_set_ctrl(map, hole, CTRL_EMPTY);
+
+    map->sz--;
+
+    return true;
+}
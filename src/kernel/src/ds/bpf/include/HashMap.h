@@ -16,6 +16,7 @@
 
 static inline size_t hash_bits(size_t h, int bits) {
     /* shuffle bits and return requested number of upper bits */
+    if (bits == 0) return 0;
     return (size_t)(h * 11400714819323198485llu) >> (MACHINE_WORDSIZE - bits);
 }
 
@@ -40,12 +41,29 @@ typedef struct HashMap {
     size_t cap;
     size_t cap_bits;
     size_t sz;
+
+    /*
+     * In incremental mode, growing keeps the previous bucket array here and moves
+     * HASHMAP_REHASH_STEP of its buckets to the new one on every insert and delete. Until it is
+     * empty lookups check both. old_cap is 0 when no resize is in progress.
+     */
+    bool incremental;
+    struct hashmap_entry ** old_buckets;
+    size_t old_cap;
+    size_t old_cap_bits;
+    /* the next bucket of old_buckets to move */
+    size_t rehash_idx;
 } HashMap;
 
-#define HASHMAP_INIT(hash_fn, equal_fn, free_key, free_data, ctx)                                 \
-    {                                                                                             \
-        .hash_fn = (hash_fn), .freeKey = (free_key).freeData = (free_data).equal_fn = (equal_fn), \
-        .ctx = (ctx), .buckets = NULL, .cap = 0, .cap_bits = 0, .sz = 0,                          \
+/* buckets of the old array moved per insert or delete in incremental mode */
+#define HASHMAP_REHASH_STEP 4
+
+#define HASHMAP_INIT(hash_fn, equal_fn, free_key, free_data, ctx)                               \
+    {                                                                                           \
+        .hash_fn = (hash_fn), .freeKey = (free_key), .freeData = (free_data),                   \
+        .equal_fn = (equal_fn), .ctx = (ctx), .buckets = NULL, .cap = 0, .cap_bits = 0, .sz = 0, \
+        .incremental = false, .old_buckets = NULL, .old_cap = 0, .old_cap_bits = 0,             \
+        .rehash_idx = 0,                                                                        \
     }
 
 void hashmap__init(struct HashMap * map,
@@ -69,6 +87,15 @@ void hashmap__free(struct HashMap * map);
 size_t hashmap__size(const struct HashMap * map);
 size_t hashmap__capacity(const struct HashMap * map);
 
+/*
+ * Switches incremental resizing on or off. Normally the insert that makes the map grow rehashes
+ * every entry, which takes time proportional to the size of the map. In incremental mode it only
+ * allocates the new bucket array, and the entries are moved a few buckets at a time by the
+ * following inserts and deletes, so no single operation takes long. Switching it off finishes a
+ * resize that is in progress.
+ */
+void hashmap__set_incremental(struct HashMap * map, bool incremental);
+
 /*
  * Hashmap insertion strategy:
  * - HASHMAP_ADD - only add key/value if key doesn't exist yet;
@@ -135,15 +162,36 @@ bool hashmap__delete(struct HashMap * map,
 
 bool hashmap__find(const struct HashMap * map, const void * key, void ** value);
 
+/*
+ * Bucket bkt of the new bucket array followed by the old one, so iterations cover entries that
+ * haven't been moved yet during an incremental resize.
+ */
+static inline struct hashmap_entry * hashmap__bucket(const struct HashMap * map, size_t bkt) {
+    return bkt < map->cap ? map->buckets[bkt] : map->old_buckets[bkt - map->cap];
+}
+
+/* the bucket of key in the new (table 0) or the old (table 1) bucket array, if any */
+static inline struct hashmap_entry * hashmap__key_bucket(const struct HashMap * map,
+                                                         const void * key,
+                                                         int table) {
+    if (table == 0) {
+        return map->buckets ? map->buckets[hash_bits(map->hash_fn(key, map->ctx), map->cap_bits)]
+                            : NULL;
+    }
+    return map->old_buckets
+               ? map->old_buckets[hash_bits(map->hash_fn(key, map->ctx), map->old_cap_bits)]
+               : NULL;
+}
+
 /*
  * hashmap__for_each_entry - iterate over all entries in hashmap
  * @map: hashmap to iterate
  * @cur: struct hashmap_entry * used as a loop cursor
  * @bkt: integer used as a bucket loop cursor
  */
-#define hashmap__for_each_entry(map, cur, bkt) \
-    for (bkt = 0; bkt < map->cap; bkt++)       \
-        for (cur = map->buckets[bkt]; cur; cur = cur->next)
+#define hashmap__for_each_entry(map, cur, bkt)          \
+    for (bkt = 0; bkt < map->cap + map->old_cap; bkt++) \
+        for (cur = hashmap__bucket(map, bkt); cur; cur = cur->next)
 
 /*
  * hashmap__for_each_entry_safe - iterate over all entries in hashmap, safe
@@ -153,12 +201,12 @@ bool hashmap__find(const struct HashMap * map, const void * key, void ** value);
  * @tmp: struct hashmap_entry * used as a temporary next cursor storage
  * @bkt: integer used as a bucket loop cursor
  */
-#define hashmap__for_each_entry_safe(map, cur, tmp, bkt)   \
-    for (bkt = 0; bkt < map->cap; bkt++)                   \
-        for (cur = map->buckets[bkt]; cur && ({            \
-                                          tmp = cur->next; \
-                                          true;            \
-                                      });                  \
+#define hashmap__for_each_entry_safe(map, cur, tmp, bkt)           \
+    for (bkt = 0; bkt < map->cap + map->old_cap; bkt++)            \
+        for (cur = hashmap__bucket(map, bkt); cur && ({            \
+                                                  tmp = cur->next; \
+                                                  true;            \
+                                              });                  \
              cur = tmp)
 
 /*
@@ -166,26 +214,25 @@ bool hashmap__find(const struct HashMap * map, const void * key, void ** value);
  * @map: hashmap to iterate
  * @cur: struct hashmap_entry * used as a loop cursor
  * @key: key to iterate entries for
+ *
+ * During an incremental resize, the cursor continues from the chain of key in the new bucket
+ * array into its chain in the old one, which is only looked up once the first is exhausted.
+ * Without a resize in progress only the new array is checked. After a break, cur is the entry
+ * the loop stopped at, otherwise it ends as NULL.
  */
-#define hashmap__for_each_key_entry(map, cur, _key)                                 \
-    for (cur = ({                                                                   \
-             size_t bkt = hash_bits(map->hash_fn((_key), map->ctx), map->cap_bits); \
-             map->buckets ? map->buckets[bkt] : NULL;                               \
-         });                                                                        \
-         cur;                                                                       \
-         cur = cur->next)                                                           \
+#define hashmap__for_each_key_entry(map, cur, _key)                                              \
+    for (int __hm_old = (cur = hashmap__key_bucket(map, (_key), 0), 0);                          \
+         cur || (!__hm_old && (__hm_old = 1, cur = hashmap__key_bucket(map, (_key), 1)));        \
+         cur = cur->next)                                                                        \
         if (map->equal_fn(cur->key, (_key), map->ctx))
 
-#define hashmap__for_each_key_entry_safe(map, cur, tmp, _key)                       \
-    for (cur = ({                                                                   \
-             size_t bkt = hash_bits(map->hash_fn((_key), map->ctx), map->cap_bits); \
-             cur = map->buckets ? map->buckets[bkt] : NULL;                         \
-         });                                                                        \
-         cur && ({                                                                  \
-             tmp = cur->next;                                                       \
-             true;                                                                  \
-         });                                                                        \
-         cur = tmp)                                                                 \
+#define hashmap__for_each_key_entry_safe(map, cur, tmp, _key)                                    \
+    for (int __hm_old = (cur = hashmap__key_bucket(map, (_key), 0), 0);                          \
+         (cur || (!__hm_old && (__hm_old = 1, cur = hashmap__key_bucket(map, (_key), 1)))) && ({ \
+             tmp = cur->next;                                                                    \
+             true;                                                                               \
+         });                                                                                     \
+         cur = tmp)                                                                              \
         if (map->equal_fn(cur->key, (_key), map->ctx))
 
 #endif /* __LIBBPF_HASHMAP_H */
@@ -0,0 +1,151 @@
+#ifndef OPEN_HASHMAP_H
+#define OPEN_HASHMAP_H
+
+#include <HashMap.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Open addressing variant of HashMap, with the same API (openhashmap__ instead of hashmap__).
+ *
+ * Entries are stored inline in one array, so inserting doesn't allocate unless the map grows, and
+ * a lookup reads one array instead of following a chain. Collisions are resolved with linear
+ * probing and Robin Hood hashing: an entry that is further from its home slot than the one in its
+ * way takes that slot, which keeps every probe sequence short. Deleting moves the following
+ * entries one slot back ("backward shift") instead of leaving tombstones.
+ *
+ * Every slot also has a control byte: 0 when it is empty, otherwise the high bit and 7 more bits
+ * of the hash. Lookups compare a machine word of control bytes with the wanted tag at once, and
+ * only compare keys of the slots whose tag matches. The first word - 1 control bytes are repeated
+ * after the last one, so a word can be read at any slot without wrapping around.
+ */
+
+/* percent of the slots that may be used before the map grows */
+#define OPENHASHMAP_DEFAULT_MAX_LOAD 80
+#define OPENHASHMAP_MIN_MAX_LOAD     10
+#define OPENHASHMAP_MAX_MAX_LOAD     95
+
+struct openhashmap_entry {
+    const void * key;
+    void * value;
+    /* the mixed hash of the key, so growing and moving entries don't call hash_fn again */
+    size_t hash;
+};
+
+typedef struct OpenHashMap {
+    hashmap_hash_fn hash_fn;
+    hashmap_equal_fn equal_fn;
+    void * ctx;
+
+    FreeFunc freeData;
+    FreeFunc freeKey;
+
+    /* cap entries followed by the control bytes, in one allocation */
+    struct openhashmap_entry * entries;
+    uint8_t * ctrl;
+    size_t cap;
+    size_t cap_bits;
+    size_t sz;
+    size_t max_load;
+} OpenHashMap;
+
+void openhashmap__init(struct OpenHashMap * map,
+                       hashmap_hash_fn hash_fn,
+                       hashmap_equal_fn equal_fn,
+                       FreeFunc free_key,
+                       FreeFunc free_data,
+                       void * ctx);
+
+struct OpenHashMap * openhashmap__new(hashmap_hash_fn hash_fn,
+                                      hashmap_equal_fn equal_fn,
+                                      FreeFunc free_key,
+                                      FreeFunc free_data,
+                                      void * ctx);
+
+void openhashmap__clear(struct OpenHashMap * map);
+void openhashmap__free(struct OpenHashMap * map);
+
+size_t openhashmap__size(const struct OpenHashMap * map);
+size_t openhashmap__capacity(const struct OpenHashMap * map);
+
+/*
+ * Sets the percentage of slots that may be used before the map doubles its capacity, between
+ * OPENHASHMAP_MIN_MAX_LOAD and OPENHASHMAP_MAX_MAX_LOAD. Higher values use less memory, lower
+ * values make probe sequences shorter. Takes effect on the next insert. Returns -1 if the value is
+ * out of range.
+ */
+int openhashmap__set_max_load(struct OpenHashMap * map, size_t percent);
+
+/*
+ * Same strategies as hashmap__insert. With HASHMAP_APPEND, openhashmap__find returns one of the
+ * entries with the key, not necessarily the last inserted one.
+ */
+int openhashmap__insert(struct OpenHashMap * map,
+                        const void * key,
+                        void * value,
+                        enum hashmap_insert_strategy strategy,
+                        const void ** old_key,
+                        void ** old_value);
+
+static inline int openhashmap__add(struct OpenHashMap * map, const void * key, void * value) {
+    return openhashmap__insert(map, key, value, HASHMAP_ADD, NULL, NULL);
+}
+
+static inline int openhashmap__set(struct OpenHashMap * map,
+                                   const void * key,
+                                   void * value,
+                                   const void ** old_key,
+                                   void ** old_value) {
+    return openhashmap__insert(map, key, value, HASHMAP_SET, old_key, old_value);
+}
+
+static inline int openhashmap__update(struct OpenHashMap * map,
+                                      const void * key,
+                                      void * value,
+                                      const void ** old_key,
+                                      void ** old_value) {
+    return openhashmap__insert(map, key, value, HASHMAP_UPDATE, old_key, old_value);
+}
+
+static inline int openhashmap__append(struct OpenHashMap * map, const void * key, void * value) {
+    return openhashmap__insert(map, key, value, HASHMAP_APPEND, NULL, NULL);
+}
+
+bool openhashmap__delete(struct OpenHashMap * map,
+                         const void * key,
+                         const void ** old_key,
+                         void ** old_value);
+
+bool openhashmap__find(const struct OpenHashMap * map, const void * key, void ** value);
+
+/*
+ * openhashmap__next - advance an iteration over all entries
+ * @map: hashmap to iterate
+ * @bkt: slot cursor, 0 before the first call
+ * @entry: set to the next entry
+ *
+ * Returns false when there are no more entries. Deleting moves other entries, so the map must not
+ * be changed during an iteration.
+ */
+static inline bool openhashmap__next(const struct OpenHashMap * map,
+                                     size_t * bkt,
+                                     struct openhashmap_entry ** entry) {
+    for (; *bkt < map->cap; (*bkt)++) {
+        if (map->ctrl[*bkt] != 0) {
+            *entry = &map->entries[(*bkt)++];
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * openhashmap__for_each_entry - iterate over all entries in hashmap
+ * @map: hashmap to iterate
+ * @cur: struct openhashmap_entry * used as a loop cursor
+ * @bkt: size_t used as a slot loop cursor
+ */
+#define openhashmap__for_each_entry(map, cur, bkt) \
+    for (bkt = 0; openhashmap__next(map, &bkt, &cur);)
+
+#endif
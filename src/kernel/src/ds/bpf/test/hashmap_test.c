@@ -1,7 +1,11 @@
 #include <HashMap.h>
+#include <bench.h>
 #include <stdlib.h>
 #include <test.h>
 
+#define RESIZE_TEST_KEYS    512
+#define BENCH_RESIZE_ROUNDS 8
+
 
 size_t int_hash_fn(const void * key, void * ctx) {
     return (size_t) * (int *)key;
@@ -11,6 +15,16 @@ bool int_compare_fn(const void * key1, const void * key2, void * ctx) {
     return *(int *)key1 == *(int *)key2;
 }
 
+// Every call to the hash function is work the map does for an operation
+static uint32_t hash_calls;
+
+static size_t counting_hash_fn(const void * key, void * ctx) {
+    hash_calls++;
+    return (size_t) * (int *)key;
+}
+
+static int resize_keys[RESIZE_TEST_KEYS];
+
 void fakeFree(void * fake) {
     UNUSED(fake);
 }
@@ -140,3 +154,187 @@ TEST_CREATE(test_update_hm, {
 
     hashmap__free(hm);
 })
+
+TEST_CREATE(test_incremental_hm, {
+    HashMap * hm = hashmap__new(int_hash_fn, int_compare_fn, fakeFree, fakeFree, NULL);
+    hashmap__set_incremental(hm, true);
+    bool resized = false;
+
+    for (int i = 0; i < RESIZE_TEST_KEYS; i++) {
+        resize_keys[i] = i * 7919;
+        ASSERT_EQ(hashmap__add(hm, &resize_keys[i], &resize_keys[i]), 0);
+        resized |= hm->old_buckets != NULL;
+
+        // Keys in both bucket arrays are found
+        for (int j = 0; j <= i; j += 17) { ASSERT(hashmap__find(hm, &resize_keys[j], NULL)); }
+    }
+    ASSERT(resized);
+
+    // Delete half of them, which also moves the rest
+    for (int i = 0; i < RESIZE_TEST_KEYS; i += 2) {
+        ASSERT(hashmap__delete(hm, &resize_keys[i], NULL, NULL));
+    }
+    ASSERT_EQ(hashmap__size(hm), RESIZE_TEST_KEYS / 2);
+
+    for (int i = 0; i < RESIZE_TEST_KEYS; i++) {
+        int * value = NULL;
+        const bool found = hashmap__find(hm, &resize_keys[i], (void **)&value);
+        ASSERT_EQ(found, (i % 2 == 1));
+        if (found) { ASSERT_EQ(value, &resize_keys[i]); }
+    }
+
+    struct hashmap_entry * cur;
+    size_t bkt;
+    size_t seen = 0;
+    hashmap__for_each_entry(hm, cur, bkt) { seen++; }
+    ASSERT_EQ(seen, RESIZE_TEST_KEYS / 2);
+
+    hashmap__free(hm);
+})
+
+TEST_CREATE(test_incremental_in_progress_hm, {
+    HashMap * hm = hashmap__new(int_hash_fn, int_compare_fn, fakeFree, fakeFree, NULL);
+    hashmap__set_incremental(hm, true);
+
+    // Stop right after a resize started
+    int count = 0;
+    while (hm->old_buckets == NULL || count < 8) {
+        resize_keys[count] = count;
+        hashmap__add(hm, &resize_keys[count], NULL);
+        count++;
+    }
+    ASSERT_NEQ(hm->old_cap, 0);
+
+    // Every entry is seen exactly once, whichever array it is in
+    struct hashmap_entry * cur;
+    size_t bkt;
+    int seen = 0;
+    hashmap__for_each_entry(hm, cur, bkt) { seen++; }
+    ASSERT_EQ(seen, count);
+
+    for (int i = 0; i < count; i++) {
+        int matches = 0;
+        hashmap__for_each_key_entry(hm, cur, &resize_keys[i]) { matches++; }
+        ASSERT_EQ(matches, 1);
+    }
+
+    // Switching back finishes the resize
+    hashmap__set_incremental(hm, false);
+    ASSERT_NULL(hm->old_buckets);
+    for (int i = 0; i < count; i++) { ASSERT(hashmap__find(hm, &resize_keys[i], NULL)); }
+
+    // Freed halfway a resize without leaking
+    hashmap__set_incremental(hm, true);
+    while (hm->old_buckets == NULL) {
+        resize_keys[count] = count;
+        hashmap__add(hm, &resize_keys[count], NULL);
+        count++;
+    }
+    hashmap__free(hm);
+})
+
+TEST_CREATE(test_key_entry_break_hm, {
+    HashMap * hm = hashmap__new(counting_hash_fn, int_compare_fn, fakeFree, fakeFree, NULL);
+    struct hashmap_entry * cur;
+    struct hashmap_entry * tmp;
+
+    for (int i = 0; i < 8; i++) {
+        resize_keys[i] = i;
+        hashmap__add(hm, &resize_keys[i], &resize_keys[i]);
+    }
+
+    // Without a resize in progress only the new bucket array is looked up
+    hash_calls = 0;
+    hashmap__for_each_key_entry(hm, cur, &resize_keys[3]) { break; }
+    ASSERT_EQ(hash_calls, 1);
+    ASSERT_NOT_NULL(cur);
+    ASSERT_EQ(cur->value, &resize_keys[3]);
+
+    // Stop right after a resize started, so keys are in both arrays
+    hashmap__set_incremental(hm, true);
+    int count = 8;
+    while (hm->old_buckets == NULL || count < 16) {
+        resize_keys[count] = count;
+        hashmap__add(hm, &resize_keys[count], &resize_keys[count]);
+        count++;
+    }
+    ASSERT_NEQ(hm->old_cap, 0);
+
+    // A break leaves cur at the matching entry, whichever array it is in
+    for (int i = 0; i < count; i++) {
+        hashmap__for_each_key_entry(hm, cur, &resize_keys[i]) { break; }
+        ASSERT_NOT_NULL(cur);
+        ASSERT_EQ(cur->value, &resize_keys[i]);
+
+        hashmap__for_each_key_entry_safe(hm, cur, tmp, &resize_keys[i]) { break; }
+        ASSERT_NOT_NULL(cur);
+        ASSERT_EQ(cur->value, &resize_keys[i]);
+    }
+
+    // Without a match the loop ends with cur NULL
+    int missing = count;
+    hashmap__for_each_key_entry(hm, cur, &missing) { break; }
+    ASSERT_NULL(cur);
+
+    hashmap__free(hm);
+})
+
+// The most hash function calls a single insert of RESIZE_TEST_KEYS keys makes
+static uint32_t max_insert_hash_calls(bool incremental) {
+    HashMap * hm = hashmap__new(counting_hash_fn, int_compare_fn, fakeFree, fakeFree, NULL);
+    hashmap__set_incremental(hm, incremental);
+    uint32_t max = 0;
+
+    for (int i = 0; i < RESIZE_TEST_KEYS; i++) {
+        resize_keys[i] = i;
+        hash_calls = 0;
+        hashmap__add(hm, &resize_keys[i], NULL);
+        if (hash_calls > max) { max = hash_calls; }
+    }
+
+    hashmap__free(hm);
+    return max;
+}
+
+TEST_CREATE(test_incremental_bounded_hm, {
+    // Growing rehashes every entry at once
+    ASSERT_GT(max_insert_hash_calls(false), RESIZE_TEST_KEYS / 2);
+    // The key itself and the entries in a few buckets
+    ASSERT_LTEQ(max_insert_hash_calls(true), 1 + HASHMAP_REHASH_STEP * 4);
+})
+
+// The slowest and the average insert of RESIZE_TEST_KEYS keys. The slowest one is the lowest of a
+// few rounds, so an interrupt (or a page fault on the host) during one insert doesn't count.
+static void bench_hashmap_inserts(const char * name, bool incremental) {
+    uint64_t worst = UINT64_MAX;
+    uint64_t total = 0;
+
+    for (int round = 0; round < BENCH_RESIZE_ROUNDS; round++) {
+        HashMap * hm = hashmap__new(int_hash_fn, int_compare_fn, fakeFree, fakeFree, NULL);
+        hashmap__set_incremental(hm, incremental);
+        uint64_t round_worst = 0;
+
+        for (int i = 0; i < RESIZE_TEST_KEYS; i++) {
+            resize_keys[i] = i * 2654435761u;
+            const uint64_t start = bench_counter();
+            hashmap__add(hm, &resize_keys[i], NULL);
+            const uint64_t ticks = bench_counter() - start;
+            total += ticks;
+            if (ticks > round_worst) { round_worst = ticks; }
+        }
+
+        hashmap__free(hm);
+        if (round_worst < worst) { worst = round_worst; }
+    }
+
+    char label[64];
+    os_snprintf(label, sizeof(label), "%s worst insert", name);
+    bench_report(label, worst, 1);
+    os_snprintf(label, sizeof(label), "%s insert", name);
+    bench_report(label, total, RESIZE_TEST_KEYS * BENCH_RESIZE_ROUNDS);
+}
+
+TEST_CREATE(bench_hashmap_resize, {
+    bench_hashmap_inserts("hashmap", false);
+    bench_hashmap_inserts("incremental hashmap", true);
+})
@@ -0,0 +1,281 @@
+#include <HashMap.h>
+#include <OpenHashMap.h>
+#include <allocator.h>
+#include <bench.h>
+#include <stdlib.h>
+#include <test.h>
+
+#define OPENHASHMAP_TEST_KEYS 512
+// The chained map has to fit in the initial heap, the allocator doesn't grow it for large blocks
+#define BENCH_HASHMAP_KEYS    512
+// Lookups are fast, so they are repeated for a stable result
+#define BENCH_HASHMAP_FIND_ROUNDS 16
+
+static size_t open_int_hash_fn(const void * key, void * ctx) {
+    return (size_t) * (int *)key;
+}
+
+// Every key in one of 4 home slots, so all of them collide
+static size_t open_bad_hash_fn(const void * key, void * ctx) {
+    return (size_t)(*(int *)key & 3);
+}
+
+static bool open_int_equal_fn(const void * key1, const void * key2, void * ctx) {
+    return *(int *)key1 == *(int *)key2;
+}
+
+static void open_no_free(void * data) {
+    UNUSED(data);
+}
+
+static void open_simple_free(void * data) {
+    kfree(data);
+}
+
+static int open_keys[OPENHASHMAP_TEST_KEYS];
+static int bench_keys[BENCH_HASHMAP_KEYS];
+
+TEST_CREATE(test_openhashmap_add_find, {
+    OpenHashMap * hm =
+        openhashmap__new(open_int_hash_fn, open_int_equal_fn, open_no_free, open_no_free, NULL);
+
+    int key = 5;
+    int data = 42;
+    int * ptr = NULL;
+
+    ASSERT(!openhashmap__find(hm, &key, NULL));
+    ASSERT_EQ(openhashmap__add(hm, &key, &data), 0);
+    ASSERT_EQ(openhashmap__add(hm, &key, &data), -1);
+    ASSERT_EQ(openhashmap__size(hm), 1);
+
+    ASSERT(openhashmap__find(hm, &key, (void **)&ptr));
+    ASSERT_EQ(ptr, &data);
+
+    openhashmap__free(hm);
+})
+
+TEST_CREATE(test_openhashmap_set_update, {
+    OpenHashMap * hm =
+        openhashmap__new(open_int_hash_fn, open_int_equal_fn, open_no_free, open_no_free, NULL);
+
+    int key = 5;
+    int data = 42;
+    int new_data = 69;
+    int extra_key = 144;
+    int * ptr = NULL;
+    const void * old_key = NULL;
+    void * old_value = NULL;
+
+    openhashmap__add(hm, &key, &data);
+    ASSERT_EQ(openhashmap__set(hm, &key, &new_data, &old_key, &old_value), 0);
+    ASSERT_EQ(old_key, &key);
+    ASSERT_EQ(old_value, &data);
+    ASSERT(openhashmap__find(hm, &key, (void **)&ptr));
+    ASSERT_EQ(ptr, &new_data);
+
+    // Update only changes keys that exist, set adds them
+    ASSERT_EQ(openhashmap__update(hm, &extra_key, &data, NULL, NULL), -1);
+    ASSERT(!openhashmap__find(hm, &extra_key, NULL));
+    ASSERT_EQ(openhashmap__set(hm, &extra_key, &data, NULL, NULL), 0);
+    ASSERT(openhashmap__find(hm, &extra_key, (void **)&ptr));
+    ASSERT_EQ(ptr, &data);
+    ASSERT_EQ(openhashmap__size(hm), 2);
+
+    openhashmap__free(hm);
+})
+
+TEST_CREATE(test_openhashmap_append_delete, {
+    OpenHashMap * hm =
+        openhashmap__new(open_int_hash_fn, open_int_equal_fn, open_no_free, open_no_free, NULL);
+
+    int key = 7;
+    int first = 1;
+    int second = 2;
+    void * old_value = NULL;
+
+    openhashmap__append(hm, &key, &first);
+    openhashmap__append(hm, &key, &second);
+    ASSERT_EQ(openhashmap__size(hm), 2);
+
+    ASSERT(openhashmap__delete(hm, &key, NULL, &old_value));
+    ASSERT((old_value == &first || old_value == &second));
+    ASSERT(openhashmap__find(hm, &key, NULL));
+    ASSERT(openhashmap__delete(hm, &key, NULL, NULL));
+    ASSERT(!openhashmap__find(hm, &key, NULL));
+    ASSERT(!openhashmap__delete(hm, &key, NULL, NULL));
+    ASSERT_EQ(openhashmap__size(hm), 0);
+
+    openhashmap__free(hm);
+})
+
+TEST_CREATE(test_openhashmap_free_entries, {
+    OpenHashMap * hm = openhashmap__new(
+        open_int_hash_fn, open_int_equal_fn, open_simple_free, open_simple_free, NULL);
+
+    for (int i = 0; i < 20; i++) {
+        int * key = kmalloc(sizeof(int));
+        int * value = kmalloc(sizeof(int));
+        *key = i;
+        *value = i * 2;
+        ASSERT_EQ(openhashmap__add(hm, key, value), 0);
+    }
+
+    // Test framework will assert that we won't leak.
+    openhashmap__free(hm);
+})
+
+// Deletes every third key, then checks that exactly the others can be found and iterated
+static int openhashmap_check_many(OpenHashMap * hm) {
+    for (int i = 0; i < OPENHASHMAP_TEST_KEYS; i++) {
+        open_keys[i] = i * 7919;
+        ASSERT_EQ(openhashmap__add(hm, &open_keys[i], &open_keys[i]), 0);
+    }
+    ASSERT_EQ(openhashmap__size(hm), OPENHASHMAP_TEST_KEYS);
+
+    for (int i = 0; i < OPENHASHMAP_TEST_KEYS; i += 3) {
+        ASSERT(openhashmap__delete(hm, &open_keys[i], NULL, NULL));
+    }
+
+    size_t expected = 0;
+    for (int i = 0; i < OPENHASHMAP_TEST_KEYS; i++) {
+        int * value = NULL;
+        const bool found = openhashmap__find(hm, &open_keys[i], (void **)&value);
+        ASSERT_EQ(found, (i % 3 != 0));
+        if (found) {
+            ASSERT_EQ(value, &open_keys[i]);
+            expected++;
+        }
+    }
+    ASSERT_EQ(openhashmap__size(hm), expected);
+
+    struct openhashmap_entry * cur;
+    size_t bkt;
+    size_t seen = 0;
+    openhashmap__for_each_entry(hm, cur, bkt) {
+        ASSERT_NEQ(*(int *)cur->key % 3, 0);
+        seen++;
+    }
+    ASSERT_EQ(seen, expected);
+
+    return TEST_PASS;
+}
+
+TEST_CREATE(test_openhashmap_many, {
+    OpenHashMap * hm =
+        openhashmap__new(open_int_hash_fn, open_int_equal_fn, open_no_free, open_no_free, NULL);
+    const int result = openhashmap_check_many(hm);
+    openhashmap__free(hm);
+    ASSERT_EQ(result, TEST_PASS);
+})
+
+TEST_CREATE(test_openhashmap_collisions, {
+    OpenHashMap * hm =
+        openhashmap__new(open_bad_hash_fn, open_int_equal_fn, open_no_free, open_no_free, NULL);
+    const int result = openhashmap_check_many(hm);
+    openhashmap__free(hm);
+    ASSERT_EQ(result, TEST_PASS);
+})
+
+TEST_CREATE(test_openhashmap_max_load, {
+    OpenHashMap * hm =
+        openhashmap__new(open_int_hash_fn, open_int_equal_fn, open_no_free, open_no_free, NULL);
+
+    ASSERT_EQ(openhashmap__set_max_load(hm, 100), -1);
+    ASSERT_EQ(openhashmap__set_max_load(hm, 5), -1);
+    ASSERT_EQ(openhashmap__set_max_load(hm, 50), 0);
+
+    for (int i = 0; i < 100; i++) {
+        open_keys[i] = i;
+        openhashmap__add(hm, &open_keys[i], NULL);
+        ASSERT_LTEQ(openhashmap__size(hm) * 2, openhashmap__capacity(hm));
+    }
+    ASSERT_EQ(openhashmap__capacity(hm), 256);
+
+    // A fuller table for the same keys
+    openhashmap__clear(hm);
+    ASSERT_EQ(openhashmap__set_max_load(hm, 95), 0);
+    const int result = openhashmap_check_many(hm);
+    ASSERT_EQ(result, TEST_PASS);
+    ASSERT_EQ(openhashmap__capacity(hm), 1024);
+
+    openhashmap__free(hm);
+})
+
+static void bench_hashmap_memory(const char * name, size_t bytes, size_t allocations) {
+    kprintf("[BENCH] %s: %u bytes in %u allocations, %u with allocator headers\n",
+            name,
+            (uint32_t)bytes,
+            (uint32_t)allocations,
+            (uint32_t)(bytes + allocations * overhead));
+}
+
+TEST_CREATE(bench_hashmap, {
+    heap_t * heap = mem_get_allocator();
+    volatile size_t sink = 0;
+    uint64_t start;
+    size_t before;
+
+    for (int i = 0; i < BENCH_HASHMAP_KEYS; i++) { bench_keys[i] = i * 2654435761u; }
+
+    HashMap * chained =
+        hashmap__new(open_int_hash_fn, open_int_equal_fn, open_no_free, open_no_free, NULL);
+    before = heap->bytes_allocated;
+
+    start = bench_counter();
+    for (int i = 0; i < BENCH_HASHMAP_KEYS; i++) { hashmap__add(chained, &bench_keys[i], NULL); }
+    bench_report("chained hashmap insert", bench_counter() - start, BENCH_HASHMAP_KEYS);
+
+    // An entry per key and the bucket array
+    bench_hashmap_memory(
+        "chained hashmap memory", heap->bytes_allocated - before, BENCH_HASHMAP_KEYS + 1);
+
+    start = bench_counter();
+    for (int round = 0; round < BENCH_HASHMAP_FIND_ROUNDS; round++) {
+        for (int i = 0; i < BENCH_HASHMAP_KEYS; i++) {
+            sink += hashmap__find(chained, &bench_keys[i], NULL);
+        }
+    }
+    bench_report("chained hashmap find",
+                 bench_counter() - start,
+                 BENCH_HASHMAP_KEYS * BENCH_HASHMAP_FIND_ROUNDS);
+
+    start = bench_counter();
+    for (int i = 0; i < BENCH_HASHMAP_KEYS; i++) {
+        sink += hashmap__delete(chained, &bench_keys[i], NULL, NULL);
+    }
+    bench_report("chained hashmap delete", bench_counter() - start, BENCH_HASHMAP_KEYS);
+
+    hashmap__free(chained);
+
+    OpenHashMap * open_map =
+        openhashmap__new(open_int_hash_fn, open_int_equal_fn, open_no_free, open_no_free, NULL);
+    before = heap->bytes_allocated;
+
+    start = bench_counter();
+    for (int i = 0; i < BENCH_HASHMAP_KEYS; i++) {
+        openhashmap__add(open_map, &bench_keys[i], NULL);
+    }
+    bench_report("open hashmap insert", bench_counter() - start, BENCH_HASHMAP_KEYS);
+
+    bench_hashmap_memory("open hashmap memory", heap->bytes_allocated - before, 1);
+
+    start = bench_counter();
+    for (int round = 0; round < BENCH_HASHMAP_FIND_ROUNDS; round++) {
+        for (int i = 0; i < BENCH_HASHMAP_KEYS; i++) {
+            sink += openhashmap__find(open_map, &bench_keys[i], NULL);
+        }
+    }
+    bench_report("open hashmap find",
+                 bench_counter() - start,
+                 BENCH_HASHMAP_KEYS * BENCH_HASHMAP_FIND_ROUNDS);
+
+    start = bench_counter();
+    for (int i = 0; i < BENCH_HASHMAP_KEYS; i++) {
+        sink += openhashmap__delete(open_map, &bench_keys[i], NULL, NULL);
+    }
+    bench_report("open hashmap delete", bench_counter() - start, BENCH_HASHMAP_KEYS);
+
+    openhashmap__free(open_map);
+
+    ASSERT_EQ(sink, 2 * (BENCH_HASHMAP_FIND_ROUNDS + 1) * BENCH_HASHMAP_KEYS);
+})
@@ -0,0 +1,139 @@
+#include <dary_heap.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DARY_HEAP_MIN_CAPACITY 16
+
+static inline uint32_t parent_of(uint32_t index) {
+    return (index - 1) / DARY_HEAP_ARITY;
+}
+
+static inline uint32_t first_child_of(uint32_t index) {
+    return index * DARY_HEAP_ARITY + 1;
+}
+
+// Puts slot at index or above it. Parents are moved down into the hole instead of swapped, so
+// every step writes one slot.
+static void sift_up(struct DaryHeap * heap, uint32_t index, struct DaryHeapSlot slot) {
+    struct DaryHeapSlot * const slots = heap->slots;
+
+    while (index > 0) {
+        const uint32_t parent = parent_of(index);
+        if (slots[parent].key <= slot.key) { break; }
+
+        slots[index] = slots[parent];
+        slots[index].node->index = index;
+        index = parent;
+    }
+
+    slots[index] = slot;
+    slot.node->index = index;
+}
+
+// Puts slot at index or below it, moving the smallest child up into the hole.
+static void sift_down(struct DaryHeap * heap, uint32_t index, struct DaryHeapSlot slot) {
+    struct DaryHeapSlot * const slots = heap->slots;
+    const uint32_t count = heap->count;
+
+    while (true) {
+        const uint32_t first = first_child_of(index);
+        if (first >= count) { break; }
+
+        const uint32_t last = first + DARY_HEAP_ARITY < count ? first + DARY_HEAP_ARITY : count;
+        uint32_t smallest = first;
+        for (uint32_t child = first + 1; child < last; child++) {
+            if (slots[child].key < slots[smallest].key) { smallest = child; }
+        }
+        if (slot.key <= slots[smallest].key) { break; }
+
+        slots[index] = slots[smallest];
+        slots[index].node->index = index;
+        index = smallest;
+    }
+
+    slots[index] = slot;
+    slot.node->index = index;
+}
+
+// Puts slot at index, which was taken by a slot with a different key, and restores the order.
+static void replace(struct DaryHeap * heap, uint32_t index, struct DaryHeapSlot slot) {
+    if (index > 0 && slot.key < heap->slots[parent_of(index)].key) {
+        sift_up(heap, index, slot);
+    } else {
+        sift_down(heap, index, slot);
+    }
+}
+
+void dary_heap_init(struct DaryHeap * heap) {
+    heap->slots = NULL;
+    heap->count = 0;
+    heap->capacity = 0;
+}
+
+void dary_heap_destroy(struct DaryHeap * heap) {
+    kfree(heap->slots);
+    dary_heap_init(heap);
+}
+
+bool dary_heap_push(struct DaryHeap * heap, struct DaryHeapNode * node, uint64_t key) {
+    assert(!dary_heap_queued(node));
+
+    if (heap->count == heap->capacity) {
+        const uint32_t capacity =
+            heap->capacity == 0 ? DARY_HEAP_MIN_CAPACITY : heap->capacity * 2;
+        struct DaryHeapSlot * const slots =
+            krealloc(heap->slots, capacity * sizeof(struct DaryHeapSlot));
+        if (slots == NULL) { return false; }
+
+        heap->slots = slots;
+        heap->capacity = capacity;
+    }
+
+    sift_up(heap, heap->count++, (struct DaryHeapSlot){.key = key, .node = node});
+    return true;
+}
+
+struct DaryHeapNode * dary_heap_peek(const struct DaryHeap * heap, uint64_t * key) {
+    if (heap->count == 0) { return NULL; }
+
+    if (key != NULL) { *key = heap->slots[0].key; }
+    return heap->slots[0].node;
+}
+
+struct DaryHeapNode * dary_heap_pop(struct DaryHeap * heap, uint64_t * key) {
+    struct DaryHeapNode * const node = dary_heap_peek(heap, key);
+
+    if (node != NULL) { dary_heap_remove(heap, node); }
+    return node;
+}
+
+void dary_heap_remove(struct DaryHeap * heap, struct DaryHeapNode * node) {
+    if (!dary_heap_queued(node)) { return; }
+
+    const uint32_t index = node->index;
+    assert(index < heap->count && heap->slots[index].node == node);
+
+    node->index = DARY_HEAP_NOT_QUEUED;
+
+    // The last slot fills the hole, it only has to move in one direction
+    const uint32_t last = --heap->count;
+    if (index != last) { replace(heap, index, heap->slots[last]); }
+}
+
+void dary_heap_decrease_key(struct DaryHeap * heap, struct DaryHeapNode * node, uint64_t key) {
+    assert(dary_heap_queued(node) && key <= dary_heap_key(heap, node));
+
+    sift_up(heap, node->index, (struct DaryHeapSlot){.key = key, .node = node});
+}
+
+void dary_heap_increase_key(struct DaryHeap * heap, struct DaryHeapNode * node, uint64_t key) {
+    assert(dary_heap_queued(node) && key >= dary_heap_key(heap, node));
+
+    sift_down(heap, node->index, (struct DaryHeapSlot){.key = key, .node = node});
+}
+
+void dary_heap_update_key(struct DaryHeap * heap, struct DaryHeapNode * node, uint64_t key) {
+    assert(dary_heap_queued(node));
+
+    replace(heap, node->index, (struct DaryHeapSlot){.key = key, .node = node});
+}
@@ -0,0 +1,89 @@
+#ifndef DARY_HEAP_H
+#define DARY_HEAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Min-heap with 4 children per node and 64 bit keys.
+///
+/// The heap is one array of (key, node) pairs, so sifting compares keys without touching the
+/// nodes, and the 4 children of a node are next to each other in memory. With 4 children the heap
+/// is half as deep as a binary heap. Nodes only store their position in the array, so the key of
+/// a queued node can be changed or the node removed in O(log n).
+///
+/// Nodes are embedded in the caller's own structures (like timer wheel entries), so pushing only
+/// allocates when the array has to grow. [dary_heap_entry] gets the structure back from a node.
+
+#define DARY_HEAP_ARITY 4
+
+/// Index of a node that is not in a heap
+#define DARY_HEAP_NOT_QUEUED UINT32_MAX
+
+struct DaryHeapNode {
+    uint32_t index;
+};
+
+struct DaryHeapSlot {
+    uint64_t key;
+    struct DaryHeapNode * node;
+};
+
+struct DaryHeap {
+    struct DaryHeapSlot * slots;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+/// The structure of the given type that node is member of.
+#define dary_heap_entry(node, type, member) \
+    ((type *)((char *)(node) - __builtin_offsetof(type, member)))
+
+/// Initializes an empty heap, which doesn't allocate until the first push.
+void dary_heap_init(struct DaryHeap * heap);
+
+/// Frees the array of the heap. The nodes that are still in it are not touched.
+void dary_heap_destroy(struct DaryHeap * heap);
+
+/// Initializes a node that is not in a heap.
+static inline void dary_heap_node_init(struct DaryHeapNode * node) {
+    node->index = DARY_HEAP_NOT_QUEUED;
+}
+
+/// Whether the node is in a heap.
+static inline bool dary_heap_queued(const struct DaryHeapNode * node) {
+    return node->index != DARY_HEAP_NOT_QUEUED;
+}
+
+static inline uint32_t dary_heap_count(const struct DaryHeap * heap) {
+    return heap->count;
+}
+
+/// The key of a node in the heap.
+static inline uint64_t dary_heap_key(const struct DaryHeap * heap,
+                                     const struct DaryHeapNode * node) {
+    return heap->slots[node->index].key;
+}
+
+/// Adds a node that is not in a heap. Returns false if the array couldn't grow.
+bool dary_heap_push(struct DaryHeap * heap, struct DaryHeapNode * node, uint64_t key);
+
+/// The node with the smallest key, or NULL if the heap is empty. Sets key if it isn't NULL.
+struct DaryHeapNode * dary_heap_peek(const struct DaryHeap * heap, uint64_t * key);
+
+/// Removes and returns the node with the smallest key, or NULL if the heap is empty. Sets key if it
+/// isn't NULL.
+struct DaryHeapNode * dary_heap_pop(struct DaryHeap * heap, uint64_t * key);
+
+/// Removes a node from the heap. Does nothing if it isn't queued.
+void dary_heap_remove(struct DaryHeap * heap, struct DaryHeapNode * node);
+
+/// Lowers the key of a node in the heap, key must not be larger than the current key.
+void dary_heap_decrease_key(struct DaryHeap * heap, struct DaryHeapNode * node, uint64_t key);
+
+/// Raises the key of a node in the heap, key must not be smaller than the current key.
+void dary_heap_increase_key(struct DaryHeap * heap, struct DaryHeapNode * node, uint64_t key);
+
+/// Changes the key of a node in the heap in either direction.
+void dary_heap_update_key(struct DaryHeap * heap, struct DaryHeapNode * node, uint64_t key);
+
+#endif
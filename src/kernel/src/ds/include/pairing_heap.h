@@ -0,0 +1,95 @@
+#ifndef PAIRING_HEAP_H
+#define PAIRING_HEAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Min-heap as a pairing heap, with 64 bit keys.
+///
+/// The heap is a tree in which every node has a key that is not larger than those of its children.
+/// Pushing is O(1): the node is linked with the root, and the larger of the two becomes the first
+/// child of the other. Decreasing a key does the same after cutting the node from its parent, an
+/// O(1) cut and meld. Its amortized cost is sub-logarithmic but not O(1), because the links it
+/// adds make later pops more expensive. Popping the root links its children in pairs from left to
+/// right, then the pairs from right to left, which is O(log n) amortized. Decreasing a key does no
+/// sifting, unlike in [DaryHeap], but every step follows a pointer, so popping is slower.
+///
+/// Nodes are embedded in the caller's own structures and the heap never allocates.
+/// [pairing_heap_entry] gets the structure back from a node.
+
+struct PairingHeapNode {
+    struct PairingHeapNode * child;
+    struct PairingHeapNode * next;
+    // The parent for the first child, otherwise the previous sibling. NULL for the root, the node
+    // itself when it is not queued.
+    struct PairingHeapNode * prev;
+    uint64_t key;
+};
+
+struct PairingHeap {
+    struct PairingHeapNode * root;
+    uint32_t count;
+};
+
+/// The structure of the given type that node is member of.
+#define pairing_heap_entry(node, type, member) \
+    ((type *)((char *)(node) - __builtin_offsetof(type, member)))
+
+/// Initializes an empty heap.
+static inline void pairing_heap_init(struct PairingHeap * heap) {
+    heap->root = 0;
+    heap->count = 0;
+}
+
+/// Initializes a node that is not in a heap.
+static inline void pairing_heap_node_init(struct PairingHeapNode * node) {
+    node->child = 0;
+    node->next = 0;
+    node->prev = node;
+}
+
+/// Whether the node is in a heap.
+static inline bool pairing_heap_queued(const struct PairingHeapNode * node) {
+    return node->prev != node;
+}
+
+static inline uint32_t pairing_heap_count(const struct PairingHeap * heap) {
+    return heap->count;
+}
+
+/// The key of a node in the heap.
+static inline uint64_t pairing_heap_key(const struct PairingHeapNode * node) {
+    return node->key;
+}
+
+/// Adds a node that is not in a heap.
+void pairing_heap_push(struct PairingHeap * heap, struct PairingHeapNode * node, uint64_t key);
+
+/// The node with the smallest key, or NULL if the heap is empty. Sets key if it isn't NULL.
+struct PairingHeapNode * pairing_heap_peek(const struct PairingHeap * heap, uint64_t * key);
+
+/// Removes and returns the node with the smallest key, or NULL if the heap is empty. Sets key if it
+/// isn't NULL.
+struct PairingHeapNode * pairing_heap_pop(struct PairingHeap * heap, uint64_t * key);
+
+/// Removes a node from the heap. Does nothing if it isn't queued.
+void pairing_heap_remove(struct PairingHeap * heap, struct PairingHeapNode * node);
+
+/// Lowers the key of a node in the heap with an O(1) cut and meld (amortized sub-logarithmic), key
+/// must not be larger than the current key.
+void pairing_heap_decrease_key(struct PairingHeap * heap,
+                               struct PairingHeapNode * node,
+                               uint64_t key);
+
+/// Raises the key of a node in the heap, key must not be smaller than the current key. This costs
+/// as much as removing the node.
+void pairing_heap_increase_key(struct PairingHeap * heap,
+                               struct PairingHeapNode * node,
+                               uint64_t key);
+
+/// Changes the key of a node in the heap in either direction.
+void pairing_heap_update_key(struct PairingHeap * heap,
+                             struct PairingHeapNode * node,
+                             uint64_t key);
+
+#endif
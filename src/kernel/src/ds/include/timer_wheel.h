@@ -0,0 +1,68 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Hierarchical timing wheel.
+///
+/// Keeps entries sorted by a 64 bit deadline (in any unit, the timer driver uses counter ticks).
+/// Adding and removing an entry is O(1) and never allocates: entries are embedded in the caller's
+/// own structures.
+///
+/// The wheel remembers the time it was last advanced to (`now`). Deadlines are split in groups of
+/// TIMER_WHEEL_LEVEL_BITS bits. An entry lives on the level of the highest group in which its
+/// deadline differs from `now`, in the slot given by the value of that group. So everything on a
+/// lower level expires before everything on a higher level, and on level 0 every slot holds a
+/// single deadline. When time passes a slot on a higher level, its entries are moved down
+/// ("cascaded"). Every entry is moved at most TIMER_WHEEL_LEVELS times.
+
+#define TIMER_WHEEL_LEVEL_BITS 5
+#define TIMER_WHEEL_SLOTS      (1u << TIMER_WHEEL_LEVEL_BITS)
+// Enough levels to cover all 64 bits of a deadline
+#define TIMER_WHEEL_LEVELS     ((64 + TIMER_WHEEL_LEVEL_BITS - 1) / TIMER_WHEEL_LEVEL_BITS)
+
+struct TimerWheelEntry {
+    struct TimerWheelEntry * next;
+    // Points to the pointer that points to this entry, NULL when the entry is not in a wheel.
+    struct TimerWheelEntry ** pprev;
+    uint64_t deadline;
+    uint8_t level;
+    uint8_t slot;
+};
+
+struct TimerWheel {
+    uint64_t now;
+    // A bit for every slot that is not empty
+    uint32_t occupied[TIMER_WHEEL_LEVELS];
+    struct TimerWheelEntry * slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
+/// Initializes an empty wheel at time now.
+void timer_wheel_init(struct TimerWheel * wheel, uint64_t now);
+
+/// Initializes an entry that is not in a wheel.
+void timer_wheel_entry_init(struct TimerWheelEntry * entry);
+
+/// Adds an entry that is not in a wheel. A deadline that already passed expires on the next call
+/// to [timer_wheel_expire].
+void timer_wheel_add(struct TimerWheel * wheel, struct TimerWheelEntry * entry, uint64_t deadline);
+
+/// Removes an entry from the wheel. Returns false if it wasn't in the wheel (anymore).
+bool timer_wheel_remove(struct TimerWheel * wheel, struct TimerWheelEntry * entry);
+
+/// Whether the entry is in a wheel.
+static inline bool timer_wheel_pending(const struct TimerWheelEntry * entry) {
+    return entry->pprev != 0;
+}
+
+/// Sets deadline to the earliest deadline in the wheel. Returns false if the wheel is empty.
+bool timer_wheel_next_deadline(const struct TimerWheel * wheel, uint64_t * deadline);
+
+/// Advances the wheel to time now and removes and returns one entry whose deadline is not after
+/// now. Returns NULL when no entry has expired. Entries come out slot by slot, so an earlier
+/// deadline comes first, but entries that share a slot (the same deadline, or deadlines that had
+/// already passed when they were added) come out in unspecified order.
+struct TimerWheelEntry * timer_wheel_expire(struct TimerWheel * wheel, uint64_t now);
+
+#endif
@@ -0,0 +1,146 @@
+#include <pairing_heap.h>
+#include <stdio.h>
+
+// Links two trees whose roots have no siblings, the root with the larger key becomes the first
+// child of the other.
+static struct PairingHeapNode * meld(struct PairingHeapNode * a, struct PairingHeapNode * b) {
+    if (a == NULL) { return b; }
+    if (b == NULL) { return a; }
+
+    if (b->key < a->key) {
+        struct PairingHeapNode * const tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    b->next = a->child;
+    if (a->child != NULL) { a->child->prev = b; }
+    b->prev = a;
+    a->child = b;
+
+    return a;
+}
+
+// Links a list of siblings into one tree: first in pairs from left to right, then the pairs from
+// right to left. The pairs are kept on a stack linked through next, so no recursion is needed.
+static struct PairingHeapNode * merge_pairs(struct PairingHeapNode * first) {
+    struct PairingHeapNode * pairs = NULL;
+
+    while (first != NULL) {
+        struct PairingHeapNode * const a = first;
+        struct PairingHeapNode * const b = a->next;
+        a->prev = NULL;
+        a->next = NULL;
+
+        if (b == NULL) {
+            a->next = pairs;
+            pairs = a;
+            break;
+        }
+
+        first = b->next;
+        b->prev = NULL;
+        b->next = NULL;
+
+        struct PairingHeapNode * const pair = meld(a, b);
+        pair->next = pairs;
+        pairs = pair;
+    }
+
+    struct PairingHeapNode * root = NULL;
+    while (pairs != NULL) {
+        struct PairingHeapNode * const pair = pairs;
+        pairs = pair->next;
+        pair->next = NULL;
+        root = meld(root, pair);
+    }
+
+    return root;
+}
+
+// Detaches a node that is not the root (with its children) from its parent and siblings
+static void cut(struct PairingHeapNode * node) {
+    if (node->prev->child == node) {
+        node->prev->child = node->next;
+    } else {
+        node->prev->next = node->next;
+    }
+    if (node->next != NULL) { node->next->prev = node->prev; }
+
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+void pairing_heap_push(struct PairingHeap * heap, struct PairingHeapNode * node, uint64_t key) {
+    assert(!pairing_heap_queued(node));
+
+    node->key = key;
+    node->child = NULL;
+    node->next = NULL;
+    node->prev = NULL;
+
+    heap->root = meld(heap->root, node);
+    heap->count++;
+}
+
+struct PairingHeapNode * pairing_heap_peek(const struct PairingHeap * heap, uint64_t * key) {
+    if (heap->root == NULL) { return NULL; }
+
+    if (key != NULL) { *key = heap->root->key; }
+    return heap->root;
+}
+
+struct PairingHeapNode * pairing_heap_pop(struct PairingHeap * heap, uint64_t * key) {
+    struct PairingHeapNode * const node = pairing_heap_peek(heap, key);
+
+    if (node != NULL) { pairing_heap_remove(heap, node); }
+    return node;
+}
+
+void pairing_heap_remove(struct PairingHeap * heap, struct PairingHeapNode * node) {
+    if (!pairing_heap_queued(node)) { return; }
+
+    struct PairingHeapNode * const children = merge_pairs(node->child);
+    if (node == heap->root) {
+        heap->root = children;
+    } else {
+        cut(node);
+        heap->root = meld(heap->root, children);
+    }
+
+    pairing_heap_node_init(node);
+    heap->count--;
+}
+
+void pairing_heap_decrease_key(struct PairingHeap * heap,
+                               struct PairingHeapNode * node,
+                               uint64_t key) {
+    assert(pairing_heap_queued(node) && key <= node->key);
+
+    node->key = key;
+    if (node == heap->root) { return; }
+
+    // The subtree of the node stays ordered, only the link to its parent can be wrong
+    cut(node);
+    heap->root = meld(heap->root, node);
+}
+
+void pairing_heap_increase_key(struct PairingHeap * heap,
+                               struct PairingHeapNode * node,
+                               uint64_t key) {
+    assert(pairing_heap_queued(node) && key >= node->key);
+
+    // The children could become smaller than the node, so they are merged without it
+    pairing_heap_remove(heap, node);
+    pairing_heap_push(heap, node, key);
+}
+
+void pairing_heap_update_key(struct PairingHeap * heap,
+                             struct PairingHeapNode * node,
+                             uint64_t key) {
+    if (key <= node->key) {
+        pairing_heap_decrease_key(heap, node, key);
+    } else {
+        pairing_heap_increase_key(heap, node, key);
+    }
+}
@@ -0,0 +1,323 @@
+#include <bench.h>
+#include <dary_heap.h>
+#include <klibc.h>
+#include <pairing_heap.h>
+#include <priority_queue.h>
+#include <stdlib.h>
+#include <string.h>
+#include <test.h>
+
+#define DARY_HEAP_TEST_ITEMS 64
+#define DARY_HEAP_TEST_OPS   4000
+// The binary heap allocates a node per element, which has to fit in the initial heap
+#define BENCH_HEAP_ITEMS     512
+// Decrease-key operations per element in the second workload
+#define BENCH_HEAP_DECREASES 8
+#define BENCH_HEAP_ROUNDS    8
+
+struct dary_item {
+    uint32_t id;
+    struct DaryHeapNode node;
+};
+
+static struct dary_item dary_items[DARY_HEAP_TEST_ITEMS];
+// What the heap should contain
+static uint64_t dary_keys[DARY_HEAP_TEST_ITEMS];
+static bool dary_queued[DARY_HEAP_TEST_ITEMS];
+
+TEST_CREATE(test_dary_heap_order, {
+    struct DaryHeap heap;
+    dary_heap_init(&heap);
+    ASSERT_NULL(dary_heap_peek(&heap, NULL));
+    ASSERT_NULL(dary_heap_pop(&heap, NULL));
+
+    // Keys above 32 bits, every one twice, pushed largest first
+    for (uint32_t i = 0; i < DARY_HEAP_TEST_ITEMS; i++) {
+        dary_items[i].id = i;
+        dary_heap_node_init(&dary_items[i].node);
+        ASSERT(!dary_heap_queued(&dary_items[i].node));
+        const uint64_t key = ((uint64_t)(DARY_HEAP_TEST_ITEMS / 2 - 1 - i / 2) << 40) + 7;
+        ASSERT(dary_heap_push(&heap, &dary_items[i].node, key));
+        ASSERT(dary_heap_queued(&dary_items[i].node));
+    }
+    ASSERT_EQ(dary_heap_count(&heap), DARY_HEAP_TEST_ITEMS);
+
+    for (uint32_t i = 0; i < DARY_HEAP_TEST_ITEMS; i++) {
+        uint64_t key;
+        struct DaryHeapNode * const node = dary_heap_pop(&heap, &key);
+        ASSERT_NOT_NULL(node);
+        ASSERT(!dary_heap_queued(node));
+        ASSERT_EQ(key >> 40, i / 2);
+
+        const struct dary_item * const item = dary_heap_entry(node, struct dary_item, node);
+        ASSERT_EQ(DARY_HEAP_TEST_ITEMS / 2 - 1 - item->id / 2, i / 2);
+    }
+    ASSERT_EQ(dary_heap_count(&heap), 0);
+    ASSERT_NULL(dary_heap_pop(&heap, NULL));
+
+    dary_heap_destroy(&heap);
+})
+
+TEST_CREATE(test_dary_heap_change_key, {
+    struct DaryHeap heap;
+    dary_heap_init(&heap);
+
+    for (uint32_t i = 0; i < DARY_HEAP_TEST_ITEMS; i++) {
+        dary_heap_node_init(&dary_items[i].node);
+        dary_heap_push(&heap, &dary_items[i].node, 1000 + i);
+    }
+
+    // The last leaf becomes the smallest, the root the largest
+    struct DaryHeapNode * const last = &dary_items[DARY_HEAP_TEST_ITEMS - 1].node;
+    dary_heap_decrease_key(&heap, last, 5);
+    ASSERT_EQ(dary_heap_peek(&heap, NULL), last);
+    ASSERT_EQ(dary_heap_key(&heap, last), 5);
+
+    struct DaryHeapNode * const first = &dary_items[0].node;
+    dary_heap_increase_key(&heap, first, 1ull << 50);
+    dary_heap_update_key(&heap, &dary_items[1].node, 3);
+    ASSERT_EQ(dary_heap_peek(&heap, NULL), &dary_items[1].node);
+    dary_heap_update_key(&heap, &dary_items[1].node, 2000);
+
+    // Removing nodes from the middle, and twice
+    dary_heap_remove(&heap, &dary_items[10].node);
+    dary_heap_remove(&heap, &dary_items[10].node);
+    dary_heap_remove(&heap, &dary_items[20].node);
+    ASSERT_EQ(dary_heap_count(&heap), DARY_HEAP_TEST_ITEMS - 2);
+
+    uint64_t key;
+    ASSERT_EQ(dary_heap_pop(&heap, &key), last);
+    ASSERT_EQ(key, 5);
+    for (uint32_t i = 2; i < DARY_HEAP_TEST_ITEMS - 1; i++) {
+        if (i == 10 || i == 20) { continue; }
+        ASSERT_EQ(dary_heap_pop(&heap, &key), &dary_items[i].node);
+        ASSERT_EQ(key, 1000 + i);
+    }
+    ASSERT_EQ(dary_heap_pop(&heap, &key), &dary_items[1].node);
+    ASSERT_EQ(dary_heap_pop(&heap, &key), first);
+    ASSERT_EQ(key, 1ull << 50);
+    ASSERT_EQ(dary_heap_count(&heap), 0);
+
+    dary_heap_destroy(&heap);
+})
+
+// The item with the smallest key that should be in the heap, DARY_HEAP_TEST_ITEMS if there is none
+static uint32_t dary_reference_min() {
+    uint32_t min = DARY_HEAP_TEST_ITEMS;
+    for (uint32_t i = 0; i < DARY_HEAP_TEST_ITEMS; i++) {
+        if (dary_queued[i] && (min == DARY_HEAP_TEST_ITEMS || dary_keys[i] < dary_keys[min])) {
+            min = i;
+        }
+    }
+    return min;
+}
+
+// Few different keys, so there are many ties
+static uint64_t dary_random_key() {
+    return ((uint64_t)(rand() % 256) << 32) | (rand() % 4);
+}
+
+TEST_CREATE(test_dary_heap_random, {
+    struct DaryHeap heap;
+    dary_heap_init(&heap);
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < DARY_HEAP_TEST_ITEMS; i++) {
+        dary_items[i].id = i;
+        dary_heap_node_init(&dary_items[i].node);
+        dary_queued[i] = false;
+    }
+
+    for (uint32_t op = 0; op < DARY_HEAP_TEST_OPS; op++) {
+        const uint32_t i = rand() % DARY_HEAP_TEST_ITEMS;
+        struct DaryHeapNode * const node = &dary_items[i].node;
+        const uint64_t key = dary_random_key();
+
+        switch (rand() % 5) {
+            case 0:
+                if (dary_queued[i]) { break; }
+                ASSERT(dary_heap_push(&heap, node, key));
+                dary_keys[i] = key;
+                dary_queued[i] = true;
+                count++;
+                break;
+            case 1:
+                if (!dary_queued[i]) { break; }
+                if (key <= dary_keys[i]) {
+                    dary_heap_decrease_key(&heap, node, key);
+                } else {
+                    dary_heap_increase_key(&heap, node, key);
+                }
+                dary_keys[i] = key;
+                break;
+            case 2:
+                if (!dary_queued[i]) { break; }
+                dary_heap_update_key(&heap, node, key);
+                dary_keys[i] = key;
+                break;
+            case 3:
+                dary_heap_remove(&heap, node);
+                if (dary_queued[i]) { count--; }
+                dary_queued[i] = false;
+                break;
+            default: {
+                const uint32_t min = dary_reference_min();
+                uint64_t popped_key;
+                struct DaryHeapNode * const popped = dary_heap_pop(&heap, &popped_key);
+                if (min == DARY_HEAP_TEST_ITEMS) {
+                    ASSERT_NULL(popped);
+                    break;
+                }
+                // With ties, any of the smallest
+                ASSERT_NOT_NULL(popped);
+                ASSERT_EQ(popped_key, dary_keys[min]);
+                const uint32_t id = dary_heap_entry(popped, struct dary_item, node)->id;
+                ASSERT(dary_queued[id]);
+                ASSERT_EQ(dary_keys[id], popped_key);
+                dary_queued[id] = false;
+                count--;
+                break;
+            }
+        }
+
+        ASSERT_EQ(dary_heap_count(&heap), count);
+        const uint32_t min = dary_reference_min();
+        uint64_t peek_key;
+        if (min == DARY_HEAP_TEST_ITEMS) {
+            ASSERT_NULL(dary_heap_peek(&heap, &peek_key));
+        } else {
+            ASSERT_NOT_NULL(dary_heap_peek(&heap, &peek_key));
+            ASSERT_EQ(peek_key, dary_keys[min]);
+        }
+    }
+
+    for (uint32_t i = 0; i < DARY_HEAP_TEST_ITEMS; i++) {
+        ASSERT_EQ(dary_heap_queued(&dary_items[i].node), dary_queued[i]);
+        if (dary_queued[i]) { ASSERT_EQ(dary_heap_key(&heap, &dary_items[i].node), dary_keys[i]); }
+    }
+
+    dary_heap_destroy(&heap);
+})
+
+struct bench_heap_item {
+    struct DaryHeapNode dary;
+    struct PairingHeapNode pairing;
+    prq_node * prq;
+};
+
+static struct bench_heap_item bench_heap_items[BENCH_HEAP_ITEMS];
+static uint64_t bench_heap_keys[BENCH_HEAP_ITEMS];
+static uint64_t bench_heap_start_keys[BENCH_HEAP_ITEMS];
+
+// Keys that fit in the int priority of the binary heap
+static void bench_heap_reset_keys() {
+    for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+        bench_heap_keys[i] = rand() % 0x40000000u + 0x40000000u;
+    }
+}
+
+// The next key of an element in the decrease-key workload, smaller than the current one
+static uint64_t bench_heap_decrease(uint32_t i) {
+    bench_heap_keys[i] -= rand() % 0x100000u + 1;
+    return bench_heap_keys[i];
+}
+
+static uint64_t bench_heap_prq(prq_handle * queue, bool decrease) {
+    const uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+        bench_heap_items[i].prq->priority = (int)bench_heap_keys[i];
+        prq_enqueue(queue, bench_heap_items[i].prq);
+    }
+    for (uint32_t round = 0; decrease && round < BENCH_HEAP_DECREASES; round++) {
+        for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+            // There is no decrease-key, only removing and adding again
+            prq_remove(queue, bench_heap_items[i].prq);
+            bench_heap_items[i].prq->priority = (int)bench_heap_decrease(i);
+            prq_enqueue(queue, bench_heap_items[i].prq);
+        }
+    }
+    while (prq_dequeue(queue) != NULL) {}
+    return bench_counter() - start;
+}
+
+static uint64_t bench_heap_dary(struct DaryHeap * heap, bool decrease) {
+    const uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+        dary_heap_push(heap, &bench_heap_items[i].dary, bench_heap_keys[i]);
+    }
+    for (uint32_t round = 0; decrease && round < BENCH_HEAP_DECREASES; round++) {
+        for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+            dary_heap_decrease_key(heap, &bench_heap_items[i].dary, bench_heap_decrease(i));
+        }
+    }
+    while (dary_heap_pop(heap, NULL) != NULL) {}
+    return bench_counter() - start;
+}
+
+static uint64_t bench_heap_pairing(struct PairingHeap * heap, bool decrease) {
+    const uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+        pairing_heap_push(heap, &bench_heap_items[i].pairing, bench_heap_keys[i]);
+    }
+    for (uint32_t round = 0; decrease && round < BENCH_HEAP_DECREASES; round++) {
+        for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+            pairing_heap_decrease_key(heap, &bench_heap_items[i].pairing, bench_heap_decrease(i));
+        }
+    }
+    while (pairing_heap_pop(heap, NULL) != NULL) {}
+    return bench_counter() - start;
+}
+
+// Every heap gets the same keys, the sum over the rounds is reported
+static void bench_heap_workload(const char * name, bool decrease) {
+    prq_handle * const queue = prq_create();
+    struct DaryHeap dary;
+    struct PairingHeap pairing;
+    uint64_t prq_ticks = 0;
+    uint64_t dary_ticks = 0;
+    uint64_t pairing_ticks = 0;
+    char label[64];
+
+    dary_heap_init(&dary);
+    pairing_heap_init(&pairing);
+
+    for (uint32_t round = 0; round < BENCH_HEAP_ROUNDS; round++) {
+        bench_heap_reset_keys();
+        for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+            dary_heap_node_init(&bench_heap_items[i].dary);
+            pairing_heap_node_init(&bench_heap_items[i].pairing);
+        }
+        // The decrease-key workload changes the keys, so every heap starts from a copy
+        memcpy(bench_heap_start_keys, bench_heap_keys, sizeof(bench_heap_keys));
+
+        prq_ticks += bench_heap_prq(queue, decrease);
+        memcpy(bench_heap_keys, bench_heap_start_keys, sizeof(bench_heap_keys));
+        dary_ticks += bench_heap_dary(&dary, decrease);
+        memcpy(bench_heap_keys, bench_heap_start_keys, sizeof(bench_heap_keys));
+        pairing_ticks += bench_heap_pairing(&pairing, decrease);
+    }
+
+    const uint32_t operations =
+        BENCH_HEAP_ROUNDS * BENCH_HEAP_ITEMS * (2 + (decrease ? BENCH_HEAP_DECREASES : 0));
+    os_snprintf(label, sizeof(label), "binary heap %s", name);
+    bench_report(label, prq_ticks, operations);
+    os_snprintf(label, sizeof(label), "4-ary heap %s", name);
+    bench_report(label, dary_ticks, operations);
+    os_snprintf(label, sizeof(label), "pairing heap %s", name);
+    bench_report(label, pairing_ticks, operations);
+
+    dary_heap_destroy(&dary);
+    prq_free(queue);
+}
+
+TEST_CREATE(bench_heaps, {
+    for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) {
+        bench_heap_items[i].prq = prq_create_node();
+        ASSERT_NOT_NULL(bench_heap_items[i].prq);
+    }
+
+    bench_heap_workload("push/pop", false);
+    bench_heap_workload("decrease-key", true);
+
+    for (uint32_t i = 0; i < BENCH_HEAP_ITEMS; i++) { prq_free_node(bench_heap_items[i].prq); }
+})
@@ -0,0 +1,192 @@
+#include <klibc.h>
+#include <pairing_heap.h>
+#include <stdlib.h>
+#include <test.h>
+
+#define PAIRING_HEAP_TEST_ITEMS 64
+#define PAIRING_HEAP_TEST_OPS   4000
+
+struct pairing_item {
+    uint32_t id;
+    struct PairingHeapNode node;
+};
+
+static struct pairing_item pairing_items[PAIRING_HEAP_TEST_ITEMS];
+// What the heap should contain
+static uint64_t pairing_keys[PAIRING_HEAP_TEST_ITEMS];
+static bool pairing_queued[PAIRING_HEAP_TEST_ITEMS];
+
+TEST_CREATE(test_pairing_heap_order, {
+    struct PairingHeap heap;
+    pairing_heap_init(&heap);
+    ASSERT_NULL(pairing_heap_peek(&heap, NULL));
+    ASSERT_NULL(pairing_heap_pop(&heap, NULL));
+
+    // Keys above 32 bits, every one twice, pushed largest first
+    for (uint32_t i = 0; i < PAIRING_HEAP_TEST_ITEMS; i++) {
+        pairing_items[i].id = i;
+        pairing_heap_node_init(&pairing_items[i].node);
+        ASSERT(!pairing_heap_queued(&pairing_items[i].node));
+        const uint64_t key = ((uint64_t)(PAIRING_HEAP_TEST_ITEMS / 2 - 1 - i / 2) << 40) + 7;
+        pairing_heap_push(&heap, &pairing_items[i].node, key);
+        ASSERT(pairing_heap_queued(&pairing_items[i].node));
+    }
+    ASSERT_EQ(pairing_heap_count(&heap), PAIRING_HEAP_TEST_ITEMS);
+
+    for (uint32_t i = 0; i < PAIRING_HEAP_TEST_ITEMS; i++) {
+        uint64_t key;
+        struct PairingHeapNode * const node = pairing_heap_pop(&heap, &key);
+        ASSERT_NOT_NULL(node);
+        ASSERT(!pairing_heap_queued(node));
+        ASSERT_EQ(key >> 40, i / 2);
+
+        const struct pairing_item * const item =
+            pairing_heap_entry(node, struct pairing_item, node);
+        ASSERT_EQ(PAIRING_HEAP_TEST_ITEMS / 2 - 1 - item->id / 2, i / 2);
+    }
+    ASSERT_EQ(pairing_heap_count(&heap), 0);
+    ASSERT_NULL(pairing_heap_pop(&heap, NULL));
+})
+
+TEST_CREATE(test_pairing_heap_change_key, {
+    struct PairingHeap heap;
+    pairing_heap_init(&heap);
+
+    for (uint32_t i = 0; i < PAIRING_HEAP_TEST_ITEMS; i++) {
+        pairing_heap_node_init(&pairing_items[i].node);
+        pairing_heap_push(&heap, &pairing_items[i].node, 1000 + i);
+    }
+    // Popping and pushing one node turns the list of children of the root into a deeper tree
+    struct PairingHeapNode * const first = &pairing_items[0].node;
+    ASSERT_EQ(pairing_heap_pop(&heap, NULL), first);
+    pairing_heap_push(&heap, first, 1000);
+
+    struct PairingHeapNode * const last = &pairing_items[PAIRING_HEAP_TEST_ITEMS - 1].node;
+    pairing_heap_decrease_key(&heap, last, 5);
+    ASSERT_EQ(pairing_heap_peek(&heap, NULL), last);
+    ASSERT_EQ(pairing_heap_key(last), 5);
+
+    pairing_heap_increase_key(&heap, first, 1ull << 50);
+    pairing_heap_update_key(&heap, &pairing_items[1].node, 3);
+    ASSERT_EQ(pairing_heap_peek(&heap, NULL), &pairing_items[1].node);
+    pairing_heap_update_key(&heap, &pairing_items[1].node, 2000);
+
+    // Removing nodes from the middle, and twice
+    pairing_heap_remove(&heap, &pairing_items[10].node);
+    pairing_heap_remove(&heap, &pairing_items[10].node);
+    pairing_heap_remove(&heap, &pairing_items[20].node);
+    ASSERT_EQ(pairing_heap_count(&heap), PAIRING_HEAP_TEST_ITEMS - 2);
+
+    uint64_t key;
+    ASSERT_EQ(pairing_heap_pop(&heap, &key), last);
+    ASSERT_EQ(key, 5);
+    for (uint32_t i = 2; i < PAIRING_HEAP_TEST_ITEMS - 1; i++) {
+        if (i == 10 || i == 20) { continue; }
+        ASSERT_EQ(pairing_heap_pop(&heap, &key), &pairing_items[i].node);
+        ASSERT_EQ(key, 1000 + i);
+    }
+    ASSERT_EQ(pairing_heap_pop(&heap, &key), &pairing_items[1].node);
+    ASSERT_EQ(pairing_heap_pop(&heap, &key), first);
+    ASSERT_EQ(key, 1ull << 50);
+    ASSERT_EQ(pairing_heap_count(&heap), 0);
+})
+
+// The item with the smallest key that should be in the heap, PAIRING_HEAP_TEST_ITEMS if there is
+// none
+static uint32_t pairing_reference_min() {
+    uint32_t min = PAIRING_HEAP_TEST_ITEMS;
+    for (uint32_t i = 0; i < PAIRING_HEAP_TEST_ITEMS; i++) {
+        if (pairing_queued[i] &&
+            (min == PAIRING_HEAP_TEST_ITEMS || pairing_keys[i] < pairing_keys[min])) {
+            min = i;
+        }
+    }
+    return min;
+}
+
+// Few different keys, so there are many ties
+static uint64_t pairing_random_key() {
+    return ((uint64_t)(rand() % 256) << 32) | (rand() % 4);
+}
+
+TEST_CREATE(test_pairing_heap_random, {
+    struct PairingHeap heap;
+    pairing_heap_init(&heap);
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < PAIRING_HEAP_TEST_ITEMS; i++) {
+        pairing_items[i].id = i;
+        pairing_heap_node_init(&pairing_items[i].node);
+        pairing_queued[i] = false;
+    }
+
+    for (uint32_t op = 0; op < PAIRING_HEAP_TEST_OPS; op++) {
+        const uint32_t i = rand() % PAIRING_HEAP_TEST_ITEMS;
+        struct PairingHeapNode * const node = &pairing_items[i].node;
+        const uint64_t key = pairing_random_key();
+
+        switch (rand() % 5) {
+            case 0:
+                if (pairing_queued[i]) { break; }
+                pairing_heap_push(&heap, node, key);
+                pairing_keys[i] = key;
+                pairing_queued[i] = true;
+                count++;
+                break;
+            case 1:
+                if (!pairing_queued[i]) { break; }
+                if (key <= pairing_keys[i]) {
+                    pairing_heap_decrease_key(&heap, node, key);
+                } else {
+                    pairing_heap_increase_key(&heap, node, key);
+                }
+                pairing_keys[i] = key;
+                break;
+            case 2:
+                if (!pairing_queued[i]) { break; }
+                pairing_heap_update_key(&heap, node, key);
+                pairing_keys[i] = key;
+                break;
+            case 3:
+                pairing_heap_remove(&heap, node);
+                if (pairing_queued[i]) { count--; }
+                pairing_queued[i] = false;
+                break;
+            default: {
+                const uint32_t min = pairing_reference_min();
+                uint64_t popped_key;
+                struct PairingHeapNode * const popped = pairing_heap_pop(&heap, &popped_key);
+                if (min == PAIRING_HEAP_TEST_ITEMS) {
+                    ASSERT_NULL(popped);
+                    break;
+                }
+                // With ties, any of the smallest
+                ASSERT_NOT_NULL(popped);
+                ASSERT_EQ(popped_key, pairing_keys[min]);
+                const uint32_t id = pairing_heap_entry(popped, struct pairing_item, node)->id;
+                ASSERT(pairing_queued[id]);
+                ASSERT_EQ(pairing_keys[id], popped_key);
+                pairing_queued[id] = false;
+                count--;
+                break;
+            }
+        }
+
+        ASSERT_EQ(pairing_heap_count(&heap), count);
+        const uint32_t min = pairing_reference_min();
+        uint64_t peek_key;
+        if (min == PAIRING_HEAP_TEST_ITEMS) {
+            ASSERT_NULL(pairing_heap_peek(&heap, &peek_key));
+        } else {
+            ASSERT_NOT_NULL(pairing_heap_peek(&heap, &peek_key));
+            ASSERT_EQ(peek_key, pairing_keys[min]);
+        }
+    }
+
+    for (uint32_t i = 0; i < PAIRING_HEAP_TEST_ITEMS; i++) {
+        ASSERT_EQ(pairing_heap_queued(&pairing_items[i].node), pairing_queued[i]);
+        if (pairing_queued[i]) {
+            ASSERT_EQ(pairing_heap_key(&pairing_items[i].node), pairing_keys[i]);
+        }
+    }
+})
@@ -0,0 +1,97 @@
+#include <string.h>
+#include <test.h>
+#include <timer_wheel.h>
+
+#define ENTRIES 64
+
+static struct TimerWheel wheel;
+static struct TimerWheelEntry entries[ENTRIES];
+
+TEST_CREATE(test_timer_wheel_empty, {
+    timer_wheel_init(&wheel, 1000);
+
+    uint64_t deadline;
+    ASSERT(!timer_wheel_next_deadline(&wheel, &deadline));
+    ASSERT_NULL(timer_wheel_expire(&wheel, 5000));
+})
+
+TEST_CREATE(test_timer_wheel_order, {
+    timer_wheel_init(&wheel, 1000);
+
+    // Spread over many levels, added in an order that is not sorted
+    for (uint32_t i = 0; i < ENTRIES; i++) {
+        timer_wheel_entry_init(&entries[i]);
+        const uint64_t deadline = 1000 + ((uint64_t)((i * 37) % ENTRIES) << (i % 40));
+        timer_wheel_add(&wheel, &entries[i], deadline);
+        ASSERT(timer_wheel_pending(&entries[i]));
+    }
+
+    uint64_t last = 0;
+    uint32_t expired = 0;
+    uint64_t deadline;
+    while (timer_wheel_next_deadline(&wheel, &deadline)) {
+        ASSERT_GTEQ(deadline, last);
+
+        // Nothing expires early
+        if (deadline > 1000) { ASSERT_NULL(timer_wheel_expire(&wheel, deadline - 1)); }
+
+        struct TimerWheelEntry * entry;
+        while ((entry = timer_wheel_expire(&wheel, deadline)) != NULL) {
+            ASSERT_EQ(entry->deadline, deadline);
+            ASSERT(!timer_wheel_pending(entry));
+            expired++;
+        }
+        last = deadline;
+    }
+
+    ASSERT_EQ(expired, ENTRIES);
+})
+
+TEST_CREATE(test_timer_wheel_large_deadline, {
+    // Past what fits in 32 bits, which the priority queue based timers couldn't handle
+    const uint64_t now = 0x123456789ull;
+    timer_wheel_init(&wheel, now);
+
+    timer_wheel_entry_init(&entries[0]);
+    timer_wheel_entry_init(&entries[1]);
+    timer_wheel_add(&wheel, &entries[0], now + 0x100000000ull);
+    timer_wheel_add(&wheel, &entries[1], now + 10);
+
+    uint64_t deadline;
+    ASSERT(timer_wheel_next_deadline(&wheel, &deadline));
+    ASSERT_EQ(deadline, now + 10);
+
+    // Jumping far ahead expires both, earliest first
+    ASSERT_EQ(timer_wheel_expire(&wheel, now + 0x200000000ull), &entries[1]);
+    ASSERT_EQ(timer_wheel_expire(&wheel, now + 0x200000000ull), &entries[0]);
+    ASSERT_NULL(timer_wheel_expire(&wheel, now + 0x200000000ull));
+})
+
+TEST_CREATE(test_timer_wheel_remove, {
+    timer_wheel_init(&wheel, 0);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        timer_wheel_entry_init(&entries[i]);
+        // All in the same slot
+        timer_wheel_add(&wheel, &entries[i], 5000);
+    }
+
+    ASSERT(timer_wheel_remove(&wheel, &entries[1]));
+    ASSERT(!timer_wheel_remove(&wheel, &entries[1]));
+    ASSERT(timer_wheel_remove(&wheel, &entries[0]));
+
+    ASSERT_EQ(timer_wheel_expire(&wheel, 5000), &entries[2]);
+    ASSERT_NULL(timer_wheel_expire(&wheel, 5000));
+
+    uint64_t deadline;
+    ASSERT(!timer_wheel_next_deadline(&wheel, &deadline));
+})
+
+TEST_CREATE(test_timer_wheel_add_expired, {
+    timer_wheel_init(&wheel, 1000);
+
+    timer_wheel_entry_init(&entries[0]);
+    timer_wheel_add(&wheel, &entries[0], 10);
+
+    ASSERT_EQ(timer_wheel_expire(&wheel, 1000), &entries[0]);
+})
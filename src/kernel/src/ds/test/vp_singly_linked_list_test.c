@@ -7,11 +7,11 @@ TEST_CREATE(test_create_ll, {
 
     uint32_t num = 10;
 
-    for (uint32_t i = 0; i < num; i++) { vpsll_push(lst, (void *)i); }
+    for (uint32_t i = 0; i < num; i++) { vpsll_push(lst, (void *)(uintptr_t)i); }
 
     ASSERT_EQ(vpsll_length(lst), num);
 
-    for (int32_t i = num - 1; i >= 0; i--) { ASSERT_EQ((int32_t)vpsll_pop(lst), i); }
+    for (int32_t i = num - 1; i >= 0; i--) { ASSERT_EQ((int32_t)(uintptr_t)vpsll_pop(lst), i); }
 
     vpsll_free(lst, NULL);
 })
@@ -22,7 +22,7 @@ TEST_CREATE(test_iter_ll, {
 
     uint32_t num = 10;
 
-    for (uint32_t i = 0; i < num; i++) { vpsll_push(lst, (void *)i); }
+    for (uint32_t i = 0; i < num; i++) { vpsll_push(lst, (void *)(uintptr_t)i); }
 
     ASSERT_EQ(vpsll_length(lst), num);
 
@@ -39,7 +39,7 @@ TEST_CREATE(test_get_ll, {
 
     uint32_t num = 10;
 
-    for (uint32_t i = 0; i < num; i++) { vpsll_push(lst, (void *)i); }
+    for (uint32_t i = 0; i < num; i++) { vpsll_push(lst, (void *)(uintptr_t)i); }
 
     ASSERT_EQ(vpsll_length(lst), num);
 
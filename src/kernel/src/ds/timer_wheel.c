@@ -0,0 +1,134 @@
+#include <stdio.h>
+#include <string.h>
+#include <timer_wheel.h>
+
+// Index of the highest set bit, value must not be 0
+static inline uint32_t highest_bit(uint64_t value) {
+    const uint32_t high = (uint32_t)(value >> 32u);
+    if (high != 0) { return 63u - __builtin_clz(high); }
+    return 31u - __builtin_clz((uint32_t)value);
+}
+
+// The earliest time an entry in the slot can expire
+static uint64_t slot_start(const struct TimerWheel * wheel, uint32_t level, uint32_t slot) {
+    const uint32_t shift = level * TIMER_WHEEL_LEVEL_BITS;
+    const uint32_t group_end = shift + TIMER_WHEEL_LEVEL_BITS;
+    const uint64_t higher_groups = group_end >= 64 ? 0 : ~((1ull << group_end) - 1);
+
+    return (wheel->now & higher_groups) | ((uint64_t)slot << shift);
+}
+
+// Finds the slot that expires first. Returns false if the wheel is empty.
+static bool earliest_slot(const struct TimerWheel * wheel, uint32_t * level, uint32_t * slot) {
+    for (uint32_t l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        if (wheel->occupied[l] != 0) {
+            *level = l;
+            *slot = __builtin_ctz(wheel->occupied[l]);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void insert(struct TimerWheel * wheel, struct TimerWheelEntry * entry) {
+    uint32_t level, slot;
+
+    if (entry->deadline <= wheel->now) {
+        // Expired entries go to the slot of now, which is the first one to be looked at
+        level = 0;
+        slot = wheel->now & (TIMER_WHEEL_SLOTS - 1);
+    } else {
+        level = highest_bit(entry->deadline ^ wheel->now) / TIMER_WHEEL_LEVEL_BITS;
+        slot = (entry->deadline >> (level * TIMER_WHEEL_LEVEL_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+    }
+
+    struct TimerWheelEntry ** const head = &wheel->slots[level][slot];
+    entry->next = *head;
+    if (*head != NULL) { (*head)->pprev = &entry->next; }
+    *head = entry;
+    entry->pprev = head;
+
+    entry->level = level;
+    entry->slot = slot;
+    wheel->occupied[level] |= 1u << slot;
+}
+
+void timer_wheel_init(struct TimerWheel * wheel, uint64_t now) {
+    memset(wheel, 0, sizeof(struct TimerWheel));
+    wheel->now = now;
+}
+
+void timer_wheel_entry_init(struct TimerWheelEntry * entry) {
+    memset(entry, 0, sizeof(struct TimerWheelEntry));
+}
+
+void timer_wheel_add(struct TimerWheel * wheel, struct TimerWheelEntry * entry, uint64_t deadline) {
+    assert(!timer_wheel_pending(entry));
+
+    entry->deadline = deadline;
+    insert(wheel, entry);
+}
+
+bool timer_wheel_remove(struct TimerWheel * wheel, struct TimerWheelEntry * entry) {
+    if (!timer_wheel_pending(entry)) { return false; }
+
+    *entry->pprev = entry->next;
+    if (entry->next != NULL) { entry->next->pprev = entry->pprev; }
+
+    if (wheel->slots[entry->level][entry->slot] == NULL) {
+        wheel->occupied[entry->level] &= ~(1u << entry->slot);
+    }
+
+    entry->next = NULL;
+    entry->pprev = NULL;
+
+    return true;
+}
+
+bool timer_wheel_next_deadline(const struct TimerWheel * wheel, uint64_t * deadline) {
+    uint32_t level, slot;
+    if (!earliest_slot(wheel, &level, &slot)) { return false; }
+
+    // Only the slot of now on level 0 and the slots of higher levels can hold different deadlines,
+    // these are usually short.
+    const struct TimerWheelEntry * entry = wheel->slots[level][slot];
+    uint64_t earliest = entry->deadline;
+    for (entry = entry->next; entry != NULL; entry = entry->next) {
+        if (entry->deadline < earliest) { earliest = entry->deadline; }
+    }
+
+    *deadline = earliest;
+    return true;
+}
+
+struct TimerWheelEntry * timer_wheel_expire(struct TimerWheel * wheel, uint64_t now) {
+    uint32_t level, slot;
+
+    while (earliest_slot(wheel, &level, &slot)) {
+        const uint64_t start = slot_start(wheel, level, slot);
+        if (start > now) { break; }
+
+        wheel->now = start;
+
+        struct TimerWheelEntry * entry = wheel->slots[level][slot];
+        if (level == 0) {
+            timer_wheel_remove(wheel, entry);
+            return entry;
+        }
+
+        // Time reached a slot on a higher level, move its entries down
+        wheel->slots[level][slot] = NULL;
+        wheel->occupied[level] &= ~(1u << slot);
+
+        while (entry != NULL) {
+            struct TimerWheelEntry * const next = entry->next;
+            insert(wheel, entry);
+            entry = next;
+        }
+    }
+
+    // Nothing expires before now. All entries stay on their level when now is moved (they still
+    // share the higher groups with now), so this is safe.
+    if (now > wheel->now) { wheel->now = now; }
+    return NULL;
+}
@@ -45,3 +45,67 @@ void create_dir(Vfs * vfs, Path * p, VfsErr * err) {
 // size_t write_file(File * f, uint8_t * buf, size_t length, VfsErr * err);
 // void seek_file(File * f, size_t pos, VfsErr * err);
 // void close_file(File * f, VfsErr * err);
+
+size_t readv_file(File * f, const IoVec * iov, size_t iovcnt, VfsErr * err) {
+    if (f->operations->readv != NULL) { return f->operations->readv(f, iov, iovcnt, err); }
+
+    size_t total = 0;
+    for (size_t i = 0; i < iovcnt; i++) {
+        VfsErr ourErr = OK;
+        size_t n = f->operations->read(f, iov[i].base, iov[i].length, &ourErr);
+        total += n;
+
+        if (ourErr != OK) {
+            if (err != NULL && *err == OK) { *err = ourErr; }
+            break;
+        }
+        if (n < iov[i].length) { break; }
+    }
+
+    return total;
+}
+
+size_t writev_file(File * f, const IoVec * iov, size_t iovcnt, VfsErr * err) {
+    if (f->operations->writev != NULL) { return f->operations->writev(f, iov, iovcnt, err); }
+
+    size_t total = 0;
+    for (size_t i = 0; i < iovcnt; i++) {
+        VfsErr ourErr = OK;
+        size_t n = f->operations->write(f, iov[i].base, iov[i].length, &ourErr);
+        total += n;
+
+        if (ourErr != OK) {
+            if (err != NULL && *err == OK) { *err = ourErr; }
+            break;
+        }
+        if (n < iov[i].length) { break; }
+    }
+
+    return total;
+}
+
+size_t preadv_file(File * f, const IoVec * iov, size_t iovcnt, size_t offset, VfsErr * err) {
+    if (f->operations->preadv != NULL) {
+        return f->operations->preadv(f, iov, iovcnt, offset, err);
+    }
+
+    size_t position = f->file_position;
+    f->file_position = offset;
+    size_t total = readv_file(f, iov, iovcnt, err);
+    f->file_position = position;
+
+    return total;
+}
+
+size_t pwritev_file(File * f, const IoVec * iov, size_t iovcnt, size_t offset, VfsErr * err) {
+    if (f->operations->pwritev != NULL) {
+        return f->operations->pwritev(f, iov, iovcnt, offset, err);
+    }
+
+    size_t position = f->file_position;
+    f->file_position = offset;
+    size_t total = writev_file(f, iov, iovcnt, err);
+    f->file_position = position;
+
+    return total;
+}
@@ -15,6 +15,12 @@ typedef struct File {
     const struct FsOperations * operations;
 } File;
 
+// A buffer for vectored io. Has the same layout as `struct iovec` in userspace.
+typedef struct IoVec {
+    uint8_t * base;
+    size_t length;
+} IoVec;
+
 void create_file(Path * p, enum VfsErr * err);
 void create_dir(struct Vfs * vfs, Path * p, enum VfsErr * err);
 
@@ -29,5 +35,13 @@ size_t write_file(File * f, uint8_t * buf, size_t length, enum VfsErr * err);
 void seek_file(File * f, size_t pos, enum VfsErr * err);
 void close_file(File * f, enum VfsErr * err);
 
+// Vectored io. These use the readv/writev/preadv/pwritev operations of the filesystem if it has
+// them, and otherwise fall back to calling read/write for every buffer. A short read or write
+// stops the transfer. The p versions work at offset and leave the file position untouched.
+size_t readv_file(File * f, const IoVec * iov, size_t iovcnt, enum VfsErr * err);
+size_t writev_file(File * f, const IoVec * iov, size_t iovcnt, enum VfsErr * err);
+size_t preadv_file(File * f, const IoVec * iov, size_t iovcnt, size_t offset, enum VfsErr * err);
+size_t pwritev_file(File * f, const IoVec * iov, size_t iovcnt, size_t offset, enum VfsErr * err);
+
 
 #endif
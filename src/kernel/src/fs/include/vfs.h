@@ -35,6 +35,16 @@ typedef struct FsOperations {
     size_t (*write)(File * fp, uint8_t * buf, size_t count, enum VfsErr * err);
     void (*close)(File * fp, enum VfsErr * err);
 
+    // Vectored io (optional). When NULL, the generic versions in file.c loop over read/write.
+    size_t (*readv)(File * fp, const IoVec * iov, size_t iovcnt, enum VfsErr * err);
+    size_t (*writev)(File * fp, const IoVec * iov, size_t iovcnt, enum VfsErr * err);
+    size_t (*preadv)(File * fp, const IoVec * iov, size_t iovcnt, size_t offset, enum VfsErr * err);
+    size_t (*pwritev)(File * fp,
+                      const IoVec * iov,
+                      size_t iovcnt,
+                      size_t offset,
+                      enum VfsErr * err);
+
 } FsOperations;
 
 typedef struct FsIdentifier {
@@ -168,7 +168,10 @@ bool path_exists(struct Vfs * vfs, Path * path) {
 }
 
 void strip_chars_from_end(Path * p) {
-    while (u8a_get(p, p->length - 1) == '.' || u8a_get(p, p->length - 1) == '/') { u8a_pop(p); }
+    while (p->length > 0 &&
+           (u8a_get(p, p->length - 1) == '.' || u8a_get(p, p->length - 1) == '/')) {
+        u8a_pop(p);
+    }
 }
 
 void path_filename(Path * p) {
@@ -181,11 +184,14 @@ void path_filename(Path * p) {
     }
 
     // strip characters from the back
-    while (u8a_get(p, p->length - 1) == '.' || u8a_get(p, p->length - 1) == '/') { p->length--; }
+    while (p->length > 0 &&
+           (u8a_get(p, p->length - 1) == '.' || u8a_get(p, p->length - 1) == '/')) {
+        p->length--;
+    }
 
     // Find first '/' from the back
-    isize_t filename_start = p->length - 1;
-    while (u8a_get(p, filename_start) != '/' && filename_start > -1) { --filename_start; }
+    isize_t filename_start = (isize_t)p->length - 1;
+    while (filename_start > -1 && u8a_get(p, filename_start) != '/') { --filename_start; }
     filename_start++;
 
     size_t filename_length = p->length - filename_start;
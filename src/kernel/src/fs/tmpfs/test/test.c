@@ -116,3 +116,90 @@ TEST_CREATE(test_listdir, {
 
     vfs_free(test_vfs);
 })
+
+static IoVec iovec(const char * base, size_t length) {
+    return (IoVec){(uint8_t *)base, length};
+}
+
+TEST_CREATE(test_vectored_rw_file, {
+    Vfs * test_vfs = vfs_create();
+    tmpfs_init(test_vfs);
+
+    DirEntry * root = create_tmpfs_root(test_vfs)->base.direntry;
+    DirEntry * newfile = create_direntry(qstr_from_null_terminated_string("test"), root);
+
+    VfsErr err = OK;
+    root->inode->fs_identifier->operations->create_file(root, newfile, &err);
+    File * file = newfile->inode->fs_identifier->operations->open(newfile->inode, &err);
+    ASSERT_EQ(err, OK);
+
+    IoVec out[3];
+    out[0] = iovec("vectored ", 9);
+    out[1] = iovec("io ", 3);
+    out[2] = iovec("works", 6);
+    ASSERT_EQ(writev_file(file, out, 3, &err), 18);
+    ASSERT_EQ(err, OK);
+    ASSERT_EQ(file->file_position, 18);
+
+    // Read it back in differently sized pieces, without moving the file position
+    char first[4];
+    char second[14];
+    IoVec in[2];
+    in[0] = iovec(first, sizeof(first));
+    in[1] = iovec(second, sizeof(second));
+    ASSERT_EQ(preadv_file(file, in, 2, 0, &err), 18);
+    ASSERT_EQ(err, OK);
+    ASSERT_EQ(file->file_position, 18);
+    ASSERT_EQ(strncmp(first, "vect", 4), 0);
+    ASSERT_EQ(strcmp(second, "ored io works"), 0);
+
+    // Overwrite in the middle, the rest of the file stays
+    IoVec patch[1];
+    patch[0] = iovec("IO", 2);
+    ASSERT_EQ(pwritev_file(file, patch, 1, 9, &err), 2);
+    ASSERT_EQ(file->file_position, 18);
+
+    // A short read stops at the end of the file
+    file->file_position = 9;
+    ASSERT_EQ(readv_file(file, in, 2, &err), 9);
+    ASSERT_EQ(strncmp(first, "IO w", 4), 0);
+
+    file->operations->close(file, &err);
+    ASSERT_EQ(err, OK);
+
+    vfs_free(test_vfs);
+})
+
+TEST_CREATE(test_append_grows_geometrically, {
+    Vfs * test_vfs = vfs_create();
+    tmpfs_init(test_vfs);
+
+    DirEntry * root = create_tmpfs_root(test_vfs)->base.direntry;
+    DirEntry * newfile = create_direntry(qstr_from_null_terminated_string("test"), root);
+
+    VfsErr err = OK;
+    root->inode->fs_identifier->operations->create_file(root, newfile, &err);
+    File * file = newfile->inode->fs_identifier->operations->open(newfile->inode, &err);
+    ASSERT_EQ(err, OK);
+
+    U8ArrayList * data = ((TmpfsInode *)newfile->inode)->data.filedata;
+    uint32_t resizes = 0;
+    uint32_t capacity = data->capacity;
+
+    // 1000 appends of 3 bytes, the buffer is only reallocated when it doubles
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(file->operations->write(file, (uint8_t *)"abc", 3, &err), 3);
+        ASSERT_GTEQ(data->capacity, data->length);
+        if (data->capacity != capacity) {
+            ASSERT_GTEQ(data->capacity, capacity * 2);
+            capacity = data->capacity;
+            resizes++;
+        }
+    }
+    ASSERT_EQ(data->length, 3000);
+    ASSERT_LTEQ(resizes, 8);
+    ASSERT_EQ(data->array[2999], 'c');
+
+    file->operations->close(file, &err);
+    vfs_free(test_vfs);
+})
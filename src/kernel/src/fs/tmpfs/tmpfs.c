@@ -129,31 +129,61 @@ size_t tmpfs_read_file(File * fp, uint8_t * buf, size_t count, enum VfsErr * err
     TmpfsInode * inode = (TmpfsInode *)fp->dentry->inode;
     U8ArrayList * array = inode->data.filedata;
 
+    if (fp->file_position >= array->length) { return 0; }
+
     uint8_t * bpos = array->array + fp->file_position;
-    uint8_t * last = memcpy(buf, bpos, min(count, array->length - fp->file_position));
+    const size_t numb = min(count, array->length - fp->file_position);
+    memcpy(buf, bpos, numb);
 
-    size_t numb = last - buf;
     fp->file_position += numb;
 
     return numb;
 }
 
+// Makes sure the file can hold `end` bytes and extends its length to it. The buffer at least
+// doubles when it grows, so appending n bytes in small writes copies O(n) bytes in total.
+static void tmpfs_extend_file(U8ArrayList * array, size_t end) {
+    if (end > array->capacity) {
+        const size_t doubled = max(array->capacity * 2, (size_t)TMPFS_DEFAULT_FILE_ALLOC_SIZE);
+        u8a_resize(array, max(doubled, end));
+    }
+
+    // Writing past the end leaves a hole of zeroes
+    if (array->length < end) {
+        memset(array->array + array->length, 0, end - array->length);
+        array->length = end;
+    }
+}
 
 size_t tmpfs_write_file(File * fp, uint8_t * buf, size_t count, enum VfsErr * err) {
     TmpfsInode * inode = (TmpfsInode *)fp->dentry->inode;
     U8ArrayList * array = inode->data.filedata;
 
-    u8a_resize(array, array->capacity + count);
+    tmpfs_extend_file(array, fp->file_position + count);
 
     memcpy(array->array + fp->file_position, buf, count);
     fp->file_position += count;
 
-    // Set the length of the array to be as long as what was already in it plus what we wrote to it.
-    array->length = fp->file_position;
-
     return count;
 }
 
+size_t tmpfs_writev_file(File * fp, const IoVec * iov, size_t iovcnt, enum VfsErr * err) {
+    TmpfsInode * inode = (TmpfsInode *)fp->dentry->inode;
+    U8ArrayList * array = inode->data.filedata;
+
+    // Grow the file once for all buffers together
+    size_t total = 0;
+    for (size_t i = 0; i < iovcnt; i++) { total += iov[i].length; }
+    tmpfs_extend_file(array, fp->file_position + total);
+
+    for (size_t i = 0; i < iovcnt; i++) {
+        memcpy(array->array + fp->file_position, iov[i].base, iov[i].length);
+        fp->file_position += iov[i].length;
+    }
+
+    return total;
+}
+
 void tmpfs_remove_file(DirEntry * entry, enum VfsErr * err) {}
 
 VPArrayList * tmpfs_list_dir(DirEntry * entry, enum VfsErr * err) {
@@ -185,6 +215,7 @@ const FsOperations tmpfs_fs_ops = {
     .close = tmpfs_close_file,
     .read = tmpfs_read_file,
     .write = tmpfs_write_file,
+    .writev = tmpfs_writev_file,
 };
 
 const FsIdentifier tmpfs_id = {
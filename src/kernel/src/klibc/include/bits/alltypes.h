@@ -1,6 +1,12 @@
-#define _Addr  int
+// The kernel is 32 bit. Host builds (see host/README.md) may be 64 bit.
+#if __SIZEOF_POINTER__ == 8
+    #define _Addr long
+    #define _Reg  long
+#else
+    #define _Addr int
+    #define _Reg  int
+#endif
 #define _Int64 long long
-#define _Reg   int
 
 #if defined(__NEED_va_list) && !defined(__DEFINED_va_list)
 typedef __builtin_va_list va_list;
@@ -12,9 +12,18 @@ typedef uint32_t uint_fast32_t;
 #define UINT_FAST16_MAX UINT32_MAX
 #define UINT_FAST32_MAX UINT32_MAX
 
-#define INTPTR_MIN  INT32_MIN
-#define INTPTR_MAX  INT32_MAX
-#define UINTPTR_MAX UINT32_MAX
-#define PTRDIFF_MIN INT32_MIN
-#define PTRDIFF_MAX INT32_MAX
-#define SIZE_MAX    UINT32_MAX
+#if __SIZEOF_POINTER__ == 8
+    #define INTPTR_MIN  INT64_MIN
+    #define INTPTR_MAX  INT64_MAX
+    #define UINTPTR_MAX UINT64_MAX
+    #define PTRDIFF_MIN INT64_MIN
+    #define PTRDIFF_MAX INT64_MAX
+    #define SIZE_MAX    UINT64_MAX
+#else
+    #define INTPTR_MIN  INT32_MIN
+    #define INTPTR_MAX  INT32_MAX
+    #define UINTPTR_MAX UINT32_MAX
+    #define PTRDIFF_MIN INT32_MIN
+    #define PTRDIFF_MAX INT32_MAX
+    #define SIZE_MAX    UINT32_MAX
+#endif
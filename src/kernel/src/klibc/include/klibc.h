@@ -26,6 +26,7 @@
 #ifndef __KLIBC_H__
 #define __KLIBC_H__
 
+#include <klog.h>
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -76,22 +77,25 @@ unsigned int rand();
 #define ALL_UNUSED(...)         ALL_UNUSED_IMPL(VA_NUM_ARGS(__VA_ARGS__))(__VA_ARGS__)
 
 
-/// Log level is defined in the Makefile
+/// Log level is defined in the Makefile. It sets which levels are compiled in, klog_level which
+/// of those are recorded at runtime. TRACE, DEBUG and INFO go through the binary log (see klog.h),
+/// WARN and FATAL are printed right away.
 
 #if LOG_LEVEL > 3
-    #define TRACE(format, ...) kprintf("\e[90m[TRACE] " format "\e[0m\n", ##__VA_ARGS__)
+    #define TRACE(format, ...) KLOG(KLOG_TRACE, "\e[90m[TRACE] " format "\e[0m\n", ##__VA_ARGS__)
 #else
     #define TRACE(...) ALL_UNUSED(__VA_ARGS__)
 #endif
 
 #if LOG_LEVEL > 2
-    #define DEBUG(format, ...) \
-        kprintf("[DEBUG] \e[92m%s:%i\e[0m " format "\n", __FILE__, __LINE__, ##__VA_ARGS__)
+    #define DEBUG(format, ...)     \
+        KLOG_CONST(KLOG_DEBUG, 1u, \
+                   "[DEBUG] \e[92m%s:%i\e[0m " format "\n", __FILE__, __LINE__, ##__VA_ARGS__)
 #else
     #define DEBUG(...) ALL_UNUSED(__VA_ARGS__)
 #endif
 #if LOG_LEVEL > 1
-    #define INFO(format, ...) kprintf("\e[96m[INFO]\e[0m " format "\n", ##__VA_ARGS__)
+    #define INFO(format, ...) KLOG(KLOG_INFO, "\e[96m[INFO]\e[0m " format "\n", ##__VA_ARGS__)
 #else
     #define INFO(...) ALL_UNUSED(__VA_ARGS__)
 #endif
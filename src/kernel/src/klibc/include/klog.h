@@ -0,0 +1,133 @@
+#ifndef KLOG_H
+#define KLOG_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/// In-memory binary kernel log.
+///
+/// Logging a message doesn't format it. It stores a timestamp, the level, a pointer to the format
+/// string and the raw 32 bit arguments in a fixed size record of a ring buffer, which takes tens
+/// of cycles and never waits for the uart, so it can be used from hot paths and interrupt
+/// handlers. Records are formatted later by a consumer: the console drain (a softirq, and every
+/// kprintf so direct output stays in order), [klog_dump], or a debugger reading `klog_ring`.
+///
+/// Producers reserve a record by atomically incrementing the head, so they never block each other
+/// and an interrupt can log while it interrupted another logger. When the ring is full the oldest
+/// records are overwritten. Every record carries a sequence number, which consumers use to detect
+/// that a record is still being written or was overwritten while they read it.
+///
+/// Strings (%s) are copied into the record, everything else is stored as is, so pointers given to
+/// other conversions must still be valid when formatting. Strings that never change, like the file
+/// name DEBUG logs, can be marked with [KLOG_CONST]; they are stored as pointers, the same as the
+/// format string. 64 bit arguments (%llu) take two of the eight argument words.
+
+/// Levels, lower is more important. Compatible with LOG_LEVEL.
+#define KLOG_FATAL 0
+#define KLOG_WARN  1
+#define KLOG_INFO  2
+#define KLOG_DEBUG 3
+#define KLOG_TRACE 4
+
+#define KLOG_RECORDS      128  // Must be a power of 2
+#define KLOG_MAX_ARGS     8
+#define KLOG_STRING_SPACE 76
+
+/// A record as stored in the ring. 128 bytes.
+struct KlogRecord {
+    // Index in the log + 1, or 0 while the record is being written
+    uint32_t sequence;
+    uint8_t level;
+    uint8_t nwords;
+    // Bit i is set if word i is an offset into strings instead of the value itself
+    uint8_t string_mask;
+    uint8_t reserved;
+    // CNTPCT at the time of logging
+    uint64_t timestamp;
+    const char * format;
+    uint32_t args[KLOG_MAX_ARGS];
+    char strings[KLOG_STRING_SPACE];
+};
+
+struct KlogRing {
+    // Index of the next record to write. Only ever increases.
+    uint32_t head;
+    struct KlogRecord records[KLOG_RECORDS];
+};
+
+extern struct KlogRing klog_ring;
+
+/// Messages above this level are dropped. Starts at LOG_LEVEL.
+extern volatile uint32_t klog_level;
+
+/// A place in the code that logs. Knows which arguments of its format string are strings or 64
+/// bit, so that only has to be found once.
+struct KlogSite {
+    const char * format;
+    uint8_t level;
+    // Bit i is set if argument i is a string
+    uint8_t string_mask;
+    // Bit i is set if argument i is 64 bit
+    uint8_t wide_mask;
+    // Bit i is set if argument i is a string that stays valid, which is not copied
+    uint8_t const_mask;
+    bool parsed;
+};
+
+// Number of arguments in a call, zero to nine.
+#define KLOG_NARGS(...) KLOG_NARGS_IMPL(_, ##__VA_ARGS__, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define KLOG_NARGS_IMPL(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, N, ...) N
+
+/// Logs a message with the given level, if the level is enabled at runtime.
+#define KLOG(lvl, fmt, ...) KLOG_CONST(lvl, 0, fmt, ##__VA_ARGS__)
+
+/// Same as KLOG. The string arguments in mask (bit i for argument i) must stay valid, like string
+/// literals, and are stored as pointers instead of being copied into the record.
+#define KLOG_CONST(lvl, mask, fmt, ...)                                                         \
+    do {                                                                                        \
+        _Static_assert(KLOG_NARGS(__VA_ARGS__) <= KLOG_MAX_ARGS, "Too many arguments");         \
+        static struct KlogSite __klog_site = {.format = fmt, .level = lvl, .const_mask = mask}; \
+        if ((lvl) <= klog_level) {                                                              \
+            klog_write(&__klog_site, KLOG_NARGS(__VA_ARGS__), ##__VA_ARGS__);                   \
+        }                                                                                       \
+    } while (0)
+
+/// Registers the console drain.
+void klog_init();
+
+/// Stores a record. Use the KLOG macro (or TRACE/DEBUG/INFO) instead.
+void klog_write(struct KlogSite * site, uint32_t nargs, ...);
+
+/// Sets the most verbose level that is still logged.
+void klog_set_level(uint32_t level);
+
+/// Enables or disables printing records to the console. While disabled, messages are only kept in
+/// the ring.
+void klog_set_console(bool enabled);
+
+/// Index of the next record that will be written.
+uint32_t klog_head();
+
+/// Index of the oldest record that is still in the ring.
+uint32_t klog_oldest();
+
+/// Copies the record at *position to record and advances position. Records that were overwritten
+/// before they could be read are skipped and added to *lost. Returns false when there is no
+/// complete record at *position (yet).
+bool klog_read(uint32_t * position, struct KlogRecord * record, uint32_t * lost);
+
+/// Formats a record that was returned by klog_read. Returns the length of the message.
+uint32_t klog_format(char * buf, int buflen, struct KlogRecord * record);
+
+/// Prints all records that were not printed yet. Does nothing if another drain is running.
+void klog_drain();
+
+/// Prints every record that is still in the ring, with timestamps.
+void klog_dump();
+
+/// Writes the same as klog_dump to a file on the host (see semihosting.h). Returns false if the
+/// file couldn't be written.
+bool klog_dump_to_host(const char * path);
+
+#endif
@@ -35,17 +35,17 @@ typedef uint16_t uint_least16_t;
 typedef uint32_t uint_least32_t;
 typedef uint64_t uint_least64_t;
 
-#define MACHINE_WORDSIZE 32
+#define MACHINE_WORDSIZE (__SIZEOF_POINTER__ * 8)
 
 #if MACHINE_WORDSIZE == 32
 typedef uint32_t size_t;
 typedef int32_t isize_t;
 #else
     #if MACHINE_WORDSIZE == 64
-        #error \
-            "TODO: we declare some pointers as uint32_t meaning that this mode is not currently supported."
-typedef uint64_t size_t;
-typedef int64_t isize_t;
+// Only for the host build. Some kernel code keeps pointers in a uint32_t, which works there
+// because the host build maps the kernel heap below 4 GiB.
+typedef unsigned long size_t;
+typedef long isize_t;
     #else
         #error "WORDSIZE not supported"
     #endif
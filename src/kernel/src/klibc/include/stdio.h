@@ -12,23 +12,29 @@
 #include <stdarg.h>
 
 /**
- * Note: os_printf is restricted to printing only 256 characters.
- * Supported format string conversions:
- * X: upper-case hexadecimal print.
- * x: lower-case hexadecimal print.
- * d: signed integer.
- * u: unsigned integer.
- * c: ASCII character.
- * s: string.
- * %: the percent sign itself.
+ * printf style formatting. kprintf prints at most 255 characters.
  *
- * Supported options:
- * 0: zero-pad the result (applies to X,x,d,u). For example:
- *    os_printf("'%05d %05d %05u'\n", 15, -15, -15);
- *    prints '00015 -0015 4294967281'
+ * Conversions: d, i, u, x, X, c, s, p (0x and 8 hex digits) and %.
+ * Flags: - (left align), + and space (sign), # (0x prefix) and 0 (zero padding).
+ * Width and precision can be numbers or *. The precision is the minimum number of digits for
+ * numbers and the maximum length for strings.
+ * Length modifiers: hh, h, l, ll, j, z and t. ll and j are 64 bit.
+ *
+ * The output is always terminated and never longer than buflen (including the terminator). Like
+ * snprintf, the functions return the length the complete output would have had, so a result of
+ * buflen or more means the output was truncated.
+ *
+ * For example:
+ *    os_snprintf(buf, sizeof(buf), "'%05d %-5u %#x %llu'", -15, 15, 255, 1ull << 40);
+ *    prints '-0015 15    0xff 1099511627776'
  */
-int os_vsnprintf(char * buf, int buflen, const char * str_buf, va_list args);
-int os_snprintf(char * buf, int buflen, const char * fmt_string, ...);
+int os_vsnprintf(char * buf, int buflen, const char * fmt, va_list args);
+int os_snprintf(char * buf, int buflen, const char * fmt, ...);
+
+/// Same as os_snprintf, but takes the arguments from an array of 32 bit words. 64 bit arguments
+/// take two words, the low word first. Used to format records of the binary log.
+int os_snprintf_words(char * buf, int buflen, const char * fmt, const uint32_t * words);
+
 int kprintf(const char * str_buf, ...);
 
 
@@ -7,13 +7,39 @@
 
 char * strcpy(char * dst, char * src);
 char * strncpy(char * dest, char * src, size_t n);
+
+/// String comparison and length work a word at a time where the alignment allows it. The
+/// comparisons return the difference of the first differing bytes (as unsigned char), so cast the
+/// result to int32_t to order strings.
 uint32_t strcmp(char * s1, char * s2);
 uint32_t strlen(char * str);
 uint32_t strncmp(char * s1, char * s2, size_t n);
+/// Length of str, but at most maxlen. Doesn't read past maxlen bytes.
+size_t strnlen(const char * str, size_t maxlen);
+
+/// First byte equal to (unsigned char)c in the n bytes at src, or NULL.
+void * memchr(const void * src, int c, size_t n);
+/// Compares n bytes. Returns the difference of the first differing bytes, or 0.
+int memcmp(const void * s1, const void * s2, size_t n);
 
-void * memcpy(void * dest, void * src, size_t count);
+/// memcpy, memset and memmove are optimized assembly (see memcpy.s). They return dest.
+void * memcpy(void * dest, const void * src, size_t count);
 void * memset(void * dest, uint32_t val, size_t count);
 uint16_t * memsetw(uint16_t * dest, uint16_t val, size_t count);
+/// Like memcpy, but the buffers may overlap.
 void * memmove(void * dest, const void * src, size_t n);
 
+/// Copies and fills of a small size that is known at compile time (often a sizeof) are left to the
+/// compiler, which can turn them into a few loads and stores instead of a call.
+#define MEM_INLINE_MAX 64
+
+#define memcpy(dest, src, n)                                \
+    (__builtin_constant_p(n) && (n) <= MEM_INLINE_MAX        \
+         ? __builtin_memcpy(dest, src, n)                    \
+         : memcpy(dest, src, n))
+#define memset(dest, val, n)                                \
+    (__builtin_constant_p(n) && (n) <= MEM_INLINE_MAX        \
+         ? __builtin_memset(dest, val, n)                    \
+         : memset(dest, val, n))
+
 #endif
@@ -85,7 +85,10 @@ int _assert_fail(char * _file, unsigned int _line, char * _func) {
  the end of String s.
  */
 char * __strchrnul(char * s, char c) {
-    os_size_t *w, k;
+    // The words alias the characters of the string
+    typedef os_size_t __attribute__((__may_alias__)) word_t;
+    word_t * w;
+    os_size_t k;
 
     if (!c) return (char *)s + strlen(s);
 
@@ -117,55 +120,38 @@ char * os_strtok(char * s, char * sep) {
     return s;
 }
 
+// A set of bytes, one bit per value
+#define BYTESET_WORDS (256 / 32)
+#define BYTESET_ADD(set, c)      ((set)[(uint8_t)(c) / 32] |= 1u << ((uint8_t)(c) % 32))
+#define BYTESET_CONTAINS(set, c) ((set)[(uint8_t)(c) / 32] & (1u << ((uint8_t)(c) % 32)))
+
 /* Returns the length of the initial segment of s that only includes
  the characters in c.
  */
 os_size_t os_strspn(char * s, char * accept) {
-    char c = s[0];  // The character in s being checked
-    int length = 0;
-
-    // Check each character in s
-    while (c != 0) {
-        bool ok = false;
+    uint32_t set[BYTESET_WORDS] = {0};
+    for (; *accept; accept++) { BYTESET_ADD(set, *accept); }
 
-        // Check against each character in accept
-        int i;
-        for (i = 0; i < strlen(accept); i++) {
-            if (c == accept[i]) { ok = true; }
-        }
-
-        if (ok == true) {
-            // If c matched any character in accept, continue
-            length++;
-            c = s[length];
-        } else {
-            // If did not match any character in accept, we are done
-            return length;
-        }
-    }
-    return length;
+    // The terminator is never in the set
+    char * c = s;
+    while (BYTESET_CONTAINS(set, *c)) { c++; }
+    return c - s;
 }
 
 /* Returns the length of the initial segment of s that does not contain
  any characters in string c.
  */
 os_size_t os_strcspn(char * s, char * reject) {
-    char c = s[0];  // The character in s being checked
-    int length = 0;
-
-    // Check each character in s
-    while (c != 0) {
-        // Check against each character in reject
-        int i;
-        for (i = 0; i < strlen(reject); i++) {
-            if (c == reject[i]) { return length; }
-        }
+    if (!reject[0] || !reject[1]) { return __strchrnul(s, reject[0]) - s; }
 
-        // If c did not match any reject characters, continue
-        length++;
-        c = s[length];
-    }
-    return length;
+    uint32_t set[BYTESET_WORDS] = {0};
+    for (; *reject; reject++) { BYTESET_ADD(set, *reject); }
+    // Stop at the terminator too
+    BYTESET_ADD(set, '\0');
+
+    char * c = s;
+    while (!BYTESET_CONTAINS(set, *c)) { c++; }
+    return c - s;
 }
 
 // Return string converted to int form, or 0 if not applicable
@@ -0,0 +1,256 @@
+#include <chipset.h>
+#include <irq.h>
+#include <klog.h>
+#include <ktime.h>
+#include <semihosting.h>
+#include <stdio.h>
+#include <string.h>
+
+struct KlogRing klog_ring;
+volatile uint32_t klog_level = LOG_LEVEL;
+
+static bool console_enabled = true;
+// Next record the console drain prints
+static uint32_t console_position = 0;
+static uint32_t console_lost = 0;
+static bool draining = false;
+
+static void klog_drain_softirq(void * ctx) {
+    klog_drain();
+}
+
+void klog_init() {
+    softirq_register(SOFTIRQ_LOG, klog_drain_softirq, NULL);
+}
+
+// Finds the arguments of the format string that are strings or 64 bit.
+static void klog_parse_site(struct KlogSite * site) {
+    uint8_t string_mask = 0;
+    uint8_t wide_mask = 0;
+    uint32_t arg = 0;
+
+    for (const char * c = site->format; *c != '\0'; c++) {
+        if (*c != '%') { continue; }
+        c++;
+        if (*c == '%') { continue; }
+
+        // Skip flags, width and precision. A * takes an argument of its own.
+        while ((*c >= '0' && *c <= '9') || *c == '-' || *c == '+' || *c == ' ' || *c == '#' ||
+               *c == '.' || *c == '*') {
+            if (*c == '*') { arg++; }
+            c++;
+        }
+
+        bool wide = false;
+        if ((c[0] == 'l' && c[1] == 'l') || c[0] == 'j') { wide = true; }
+        while (*c == 'l' || *c == 'h' || *c == 'z' || *c == 'j' || *c == 't') { c++; }
+        if (*c == '\0') { break; }
+
+        if (arg < KLOG_MAX_ARGS) {
+            if (*c == 's') { string_mask |= 1u << arg; }
+            if (wide) { wide_mask |= 1u << arg; }
+        }
+        arg++;
+    }
+
+    // Constant strings are stored like any other pointer, %s formats them from where they are
+    site->string_mask = string_mask & ~site->const_mask;
+    site->wide_mask = wide_mask;
+    site->parsed = true;
+}
+
+// Copies a string argument into the string space of a record. Returns its offset.
+static uint32_t klog_copy_string(struct KlogRecord * record, uint32_t * used, const char * str) {
+    if (str == NULL) { str = "(null)"; }
+
+    // The last byte of the space is always a terminator, which is where strings that don't fit
+    // at all point to.
+    const uint32_t start = *used;
+    uint32_t i = start;
+    while (i < KLOG_STRING_SPACE - 1 && *str != '\0') { record->strings[i++] = *str++; }
+    if (i < KLOG_STRING_SPACE - 1) { record->strings[i++] = '\0'; }
+
+    *used = i;
+    return start;
+}
+
+void klog_write(struct KlogSite * site, uint32_t nargs, ...) {
+    if (!site->parsed) { klog_parse_site(site); }
+
+    const uint32_t index = __atomic_fetch_add(&klog_ring.head, 1, __ATOMIC_RELAXED);
+    struct KlogRecord * const record = &klog_ring.records[index & (KLOG_RECORDS - 1)];
+
+    // Readers that see 0 know the record is not complete
+    __atomic_store_n(&record->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    record->timestamp = ktime_get_counts();
+    record->level = site->level;
+    record->format = site->format;
+    record->strings[KLOG_STRING_SPACE - 1] = '\0';
+
+    va_list args;
+    va_start(args, nargs);
+    uint32_t words = 0;
+    uint32_t string_mask = 0;
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < nargs; i++) {
+        if (site->wide_mask & (1u << i)) {
+            if (words + 2 > KLOG_MAX_ARGS) { break; }
+            const uint64_t value = va_arg(args, uint64_t);
+            record->args[words++] = (uint32_t)value;
+            record->args[words++] = (uint32_t)(value >> 32u);
+        } else if (words == KLOG_MAX_ARGS) {
+            break;
+        } else if (site->string_mask & (1u << i)) {
+            string_mask |= 1u << words;
+            record->args[words++] = klog_copy_string(record, &used, va_arg(args, const char *));
+        } else {
+            record->args[words++] = va_arg(args, uint32_t);
+        }
+    }
+    va_end(args);
+    record->nwords = words;
+    record->string_mask = string_mask;
+
+    __atomic_store_n(&record->sequence, index + 1, __ATOMIC_RELEASE);
+
+    if (console_enabled) { softirq_raise(SOFTIRQ_LOG); }
+}
+
+void klog_set_level(uint32_t level) {
+    klog_level = level;
+}
+
+void klog_set_console(bool enabled) {
+    // Don't print what was logged while the console was off
+    if (enabled && !console_enabled) {
+        console_position = klog_head();
+        console_lost = 0;
+    }
+    console_enabled = enabled;
+}
+
+uint32_t klog_head() {
+    return __atomic_load_n(&klog_ring.head, __ATOMIC_ACQUIRE);
+}
+
+uint32_t klog_oldest() {
+    const uint32_t head = klog_head();
+    return head < KLOG_RECORDS ? 0 : head - KLOG_RECORDS;
+}
+
+bool klog_read(uint32_t * position, struct KlogRecord * record, uint32_t * lost) {
+    while (true) {
+        const uint32_t head = klog_head();
+        if (*position == head) { return false; }
+
+        if (head - *position > KLOG_RECORDS) {
+            *lost += head - KLOG_RECORDS - *position;
+            *position = head - KLOG_RECORDS;
+        }
+
+        struct KlogRecord * const slot = &klog_ring.records[*position & (KLOG_RECORDS - 1)];
+        const uint32_t expected = *position + 1;
+        const uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+        // Reserved but not completely written yet, by a logger we interrupted.
+        if (sequence == 0 || (int32_t)(sequence - expected) < 0) { return false; }
+
+        if (sequence == expected) {
+            memcpy(record, slot, sizeof(struct KlogRecord));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+            // Still the same record, so the copy is consistent
+            if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == expected) {
+                (*position)++;
+                return true;
+            }
+        }
+
+        // Overwritten by a newer record
+        (*lost)++;
+        (*position)++;
+    }
+}
+
+uint32_t klog_format(char * buf, int buflen, struct KlogRecord * record) {
+    // Room for a format that asks for more than was stored, which then gets zeros
+    uint32_t words[2 * KLOG_MAX_ARGS];
+    for (uint32_t i = 0; i < 2 * KLOG_MAX_ARGS; i++) {
+        if (i >= record->nwords) {
+            words[i] = 0;
+        } else if (record->string_mask & (1u << i)) {
+            words[i] = (uint32_t)&record->strings[record->args[i]];
+        } else {
+            words[i] = record->args[i];
+        }
+    }
+
+    const int length = os_snprintf_words(buf, buflen, record->format, words);
+    return length < buflen ? length : buflen - 1;
+}
+
+void klog_drain() {
+    if (!console_enabled) { return; }
+    if (__atomic_exchange_n(&draining, true, __ATOMIC_ACQUIRE)) { return; }
+
+    struct KlogRecord record;
+    char buf[256];
+
+    while (klog_read(&console_position, &record, &console_lost)) {
+        if (console_lost != 0) {
+            os_snprintf(
+                buf, sizeof(buf), "\e[38;5;208m[klog] %u messages lost\e[0m\n", console_lost);
+            chipset.uart_write(buf, strlen(buf), 0);
+            console_lost = 0;
+        }
+
+        const uint32_t length = klog_format(buf, sizeof(buf), &record);
+        chipset.uart_write(buf, length, 0);
+    }
+
+    __atomic_store_n(&draining, false, __ATOMIC_RELEASE);
+}
+
+// Formats a record for a dump, with the time it was logged in front.
+static uint32_t klog_format_timestamped(char * buf, int buflen, struct KlogRecord * record) {
+    const uint64_t us = ktime_counts_to_ns(record->timestamp) / 1000u;
+    const int prefix = os_snprintf(
+        buf, buflen, "[%u.%06u] ", (uint32_t)(us / 1000000u), (uint32_t)(us % 1000000u));
+    if (prefix >= buflen - 1) { return buflen - 1; }
+    return prefix + klog_format(buf + prefix, buflen - prefix, record);
+}
+
+void klog_dump() {
+    uint32_t position = klog_oldest();
+    uint32_t lost = 0;
+    struct KlogRecord record;
+    char buf[256];
+
+    kprintf("klog: records %u to %u\n", position, klog_head());
+    while (klog_read(&position, &record, &lost)) {
+        const uint32_t length = klog_format_timestamped(buf, sizeof(buf), &record);
+        chipset.uart_write(buf, length, 0);
+    }
+    if (lost != 0) { kprintf("klog: %u records were overwritten while dumping\n", lost); }
+}
+
+bool klog_dump_to_host(const char * path) {
+    const int handle = semihosting_open(path, SEMIHOSTING_OPEN_WRITE);
+    if (handle < 0) { return false; }
+
+    uint32_t position = klog_oldest();
+    uint32_t lost = 0;
+    struct KlogRecord record;
+    char buf[256];
+    bool written = true;
+
+    while (klog_read(&position, &record, &lost)) {
+        const uint32_t length = klog_format_timestamped(buf, sizeof(buf), &record);
+        written = written && semihosting_write(handle, buf, length);
+    }
+
+    semihosting_close(handle);
+    return written;
+}
@@ -0,0 +1,229 @@
+// memcpy, memset and memmove. See string.h for the C interface.
+//
+// Copies align the destination first, so that the bulk of the work can be done with 32 byte
+// LDM/STM bursts, with PLD prefetching the source ahead. When the source can't be aligned at the
+// same time, aligned words are loaded anyway and shifted into place, so the loop still only does
+// aligned word accesses. Only the last few bytes are copied one by one.
+
+.text
+
+// Distance in bytes the source is prefetched ahead of the copy
+.equ PREFETCH_DISTANCE, 96
+
+// void * memcpy(void * dest, const void * src, size_t n)
+.global memcpy
+memcpy:
+    // r0 is the return value, ip is the destination pointer
+    mov ip, r0
+    cmp r2, #8
+    blo memcpy_small
+
+    push {r4-r11, lr}
+
+memcpy_align_dest:
+    tst ip, #3
+    beq memcpy_dest_aligned
+    ldrb r3, [r1], #1
+    strb r3, [ip], #1
+    sub r2, r2, #1
+    b memcpy_align_dest
+
+memcpy_dest_aligned:
+    ands r3, r1, #3
+    bne memcpy_shifted
+
+    subs r2, r2, #32
+    blo memcpy_words_start
+memcpy_bursts:
+    pld [r1, #PREFETCH_DISTANCE]
+    ldmia r1!, {r3-r10}
+    stmia ip!, {r3-r10}
+    subs r2, r2, #32
+    bhs memcpy_bursts
+memcpy_words_start:
+    add r2, r2, #32
+
+memcpy_words:
+    cmp r2, #4
+    blo memcpy_tail
+    ldr r3, [r1], #4
+    str r3, [ip], #4
+    sub r2, r2, #4
+    b memcpy_words
+
+memcpy_tail:
+    pop {r4-r11, lr}
+memcpy_small:
+    cmp r2, #0
+    bxeq lr
+    ldrb r3, [r1], #1
+    strb r3, [ip], #1
+    sub r2, r2, #1
+    b memcpy_small
+
+// The source is r3 (1 to 3) bytes past a word boundary. Every destination word is made of the end
+// of one source word and the start of the next one (little endian):
+//   out = (previous >> (8 * r3)) | (next << (32 - 8 * r3))
+memcpy_shifted:
+    bic r1, r1, #3
+    mov r11, r3, lsl #3       // right shift for the previous word
+    rsb r10, r11, #32         // left shift for the next word
+    ldr lr, [r1], #4          // previous word
+
+    subs r2, r2, #16
+    blo memcpy_shifted_words_start
+memcpy_shifted_blocks:
+    pld [r1, #PREFETCH_DISTANCE]
+    ldmia r1!, {r4-r7}
+    mov r8, lr, lsr r11
+    orr r8, r8, r4, lsl r10
+    mov r9, r4, lsr r11
+    orr r9, r9, r5, lsl r10
+    mov r4, r5, lsr r11
+    orr r4, r4, r6, lsl r10
+    mov r5, r6, lsr r11
+    orr r5, r5, r7, lsl r10
+    mov lr, r7
+    stmia ip!, {r8, r9}
+    stmia ip!, {r4, r5}
+    subs r2, r2, #16
+    bhs memcpy_shifted_blocks
+memcpy_shifted_words_start:
+    add r2, r2, #16
+
+memcpy_shifted_words:
+    cmp r2, #4
+    blo memcpy_shifted_done
+    ldr r4, [r1], #4
+    mov r8, lr, lsr r11
+    orr r8, r8, r4, lsl r10
+    mov lr, r4
+    str r8, [ip], #4
+    sub r2, r2, #4
+    b memcpy_shifted_words
+
+memcpy_shifted_done:
+    // The unused bytes of the previous word are where the rest starts
+    sub r1, r1, #4
+    add r1, r1, r3
+    b memcpy_tail
+
+
+// void * memset(void * dest, uint32_t value, size_t n)
+.global memset
+memset:
+    mov ip, r0
+    and r1, r1, #0xff
+    cmp r2, #8
+    blo memset_small
+
+    push {r4-r8, lr}
+    orr r1, r1, r1, lsl #8
+    orr r1, r1, r1, lsl #16
+
+memset_align:
+    tst ip, #3
+    beq memset_aligned
+    strb r1, [ip], #1
+    sub r2, r2, #1
+    b memset_align
+
+memset_aligned:
+    mov r3, r1
+    mov r4, r1
+    mov r5, r1
+    mov r6, r1
+    mov r7, r1
+    mov r8, r1
+    mov lr, r1
+
+    subs r2, r2, #32
+    blo memset_words_start
+memset_bursts:
+    stmia ip!, {r1, r3-r8, lr}
+    subs r2, r2, #32
+    bhs memset_bursts
+memset_words_start:
+    add r2, r2, #32
+
+memset_words:
+    cmp r2, #4
+    blo memset_tail
+    str r1, [ip], #4
+    sub r2, r2, #4
+    b memset_words
+
+memset_tail:
+    pop {r4-r8, lr}
+memset_small:
+    cmp r2, #0
+    bxeq lr
+    strb r1, [ip], #1
+    sub r2, r2, #1
+    b memset_small
+
+
+// void * memmove(void * dest, const void * src, size_t n)
+// memcpy copies forwards, reading every block before writing it, which is also correct when the
+// destination is below the source. Otherwise the copy goes backwards from the end.
+.global memmove
+memmove:
+    cmp r0, r1
+    bxeq lr
+    sub r3, r0, r1
+    cmp r3, r2
+    blo memmove_backwards     // dest - src < n (unsigned) means dest is inside the source
+    b memcpy
+
+memmove_backwards:
+    cmp r2, #0
+    bxeq lr
+    add ip, r0, r2
+    add r1, r1, r2
+    push {r4-r10, lr}
+
+    // Words only work if both ends can be aligned at the same time
+    eor r3, ip, r1
+    tst r3, #3
+    bne memmove_backwards_bytes
+
+memmove_backwards_align:
+    tst ip, #3
+    beq memmove_backwards_aligned
+    cmp r2, #0
+    beq memmove_backwards_done
+    ldrb r3, [r1, #-1]!
+    strb r3, [ip, #-1]!
+    sub r2, r2, #1
+    b memmove_backwards_align
+
+memmove_backwards_aligned:
+    subs r2, r2, #32
+    blo memmove_backwards_words_start
+memmove_backwards_bursts:
+    pld [r1, #-PREFETCH_DISTANCE]
+    ldmdb r1!, {r3-r10}
+    stmdb ip!, {r3-r10}
+    subs r2, r2, #32
+    bhs memmove_backwards_bursts
+memmove_backwards_words_start:
+    add r2, r2, #32
+
+memmove_backwards_words:
+    cmp r2, #4
+    blo memmove_backwards_bytes
+    ldr r3, [r1, #-4]!
+    str r3, [ip, #-4]!
+    sub r2, r2, #4
+    b memmove_backwards_words
+
+memmove_backwards_bytes:
+    cmp r2, #0
+    beq memmove_backwards_done
+    ldrb r3, [r1, #-1]!
+    strb r3, [ip, #-1]!
+    sub r2, r2, #1
+    b memmove_backwards_bytes
+
+memmove_backwards_done:
+    pop {r4-r10, pc}
@@ -1,161 +1,389 @@
 #include <chipset.h>
+#include <klog.h>
 #include <stdio.h>
 #include <string.h>
 
-static char lower_case_digits[16] = "0123456789abcdef";
-static char upper_case_digits[16] = "0123456789ABCDEF";
-
-// base is between 2 and 16, inclusive
-int print_int(char * buf,
-              int buflen,
-              int val,
-              int base,
-              int is_unsigned,
-              int padding,
-              char pad_char,
-              int is_uppercase) {
-    int max_len = buflen;
-    int orig_max_len = max_len;
-    int negate = 0;
-    if (val < 0 && !is_unsigned) {
-        val = -val;
-        negate = 1;
+// ARMv6 has no divide instruction, so every `/` is a call into libgcc. Numbers are converted
+// without any: decimal two digits at a time with a multiplication by the reciprocal of 100,
+// hexadecimal with shifts.
+
+static const char lower_case_digits[16] = "0123456789abcdef";
+static const char upper_case_digits[16] = "0123456789ABCDEF";
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+#define FLAG_LEFT  (1u << 0)  // -
+#define FLAG_PLUS  (1u << 1)  // +
+#define FLAG_SPACE (1u << 2)  // ' '
+#define FLAG_ALT   (1u << 3)  // #
+#define FLAG_ZERO  (1u << 4)  // 0
+
+// Enough for the 20 digits of a 64 bit number
+#define NUMBER_BUFFER_SIZE 24
+
+struct PrintfOutput {
+    char * buf;
+    size_t size;
+    // Length of the complete output, which can be more than what fits
+    size_t length;
+};
+
+// Arguments come from a va_list, or from an array of words (see os_snprintf_words)
+struct PrintfArgs {
+    va_list * va;
+    const uint32_t * words;
+};
+
+struct PrintfSpec {
+    uint32_t flags;
+    int width;
+    // -1 if not given
+    int precision;
+    // Size of the argument in bytes
+    uint32_t size;
+};
+
+static inline void out_char(struct PrintfOutput * out, char c) {
+    if (out->length + 1 < out->size) { out->buf[out->length] = c; }
+    out->length++;
+}
+
+static void out_repeat(struct PrintfOutput * out, char c, int count) {
+    for (int i = 0; i < count; i++) { out_char(out, c); }
+}
+
+static void out_string(struct PrintfOutput * out, const char * s, size_t length) {
+    if (out->length + 1 < out->size) {
+        size_t room = out->size - 1 - out->length;
+        size_t n = length < room ? length : room;
+        for (size_t i = 0; i < n; i++) { out->buf[out->length + i] = s[i]; }
     }
-    unsigned int temp = val;
-
-    if (max_len == 0) return orig_max_len - max_len;
-    if (negate) {
-        *buf = '-';
-        buf++;
-        max_len--;
-        if (max_len == 0) return orig_max_len - max_len;
+    out->length += length;
+}
+
+static uint32_t arg_u32(struct PrintfArgs * args) {
+    if (args->words != NULL) { return *args->words++; }
+    return va_arg(*args->va, uint32_t);
+}
+
+static const void * arg_pointer(struct PrintfArgs * args) {
+    if (args->words != NULL) { return (const void *)(uintptr_t)*args->words++; }
+    return va_arg(*args->va, const void *);
+}
+
+static uint64_t arg_u64(struct PrintfArgs * args) {
+    if (args->words != NULL) {
+        const uint64_t low = *args->words++;
+        const uint64_t high = *args->words++;
+        return (high << 32u) | low;
     }
+    return va_arg(*args->va, uint64_t);
+}
 
-    char tmp_buf[64];
-    int ndigits = 0;
-    while (temp != 0) {
-        if (is_uppercase) {
-            tmp_buf[ndigits] = upper_case_digits[temp % base];
-        } else {
-            tmp_buf[ndigits] = lower_case_digits[temp % base];
-        }
-        temp = temp / base;
-        ndigits++;
+// High 64 bits of a 64x64 bit multiplication, from 32x32 bit ones
+static inline uint64_t mul_high64(uint64_t a, uint64_t b) {
+    const uint32_t a_low = a;
+    const uint32_t a_high = a >> 32u;
+    const uint32_t b_low = b;
+    const uint32_t b_high = b >> 32u;
+
+    const uint64_t low_low = (uint64_t)a_low * b_low;
+    const uint64_t high_low = (uint64_t)a_high * b_low;
+    const uint64_t low_high = (uint64_t)a_low * b_high;
+    const uint64_t high_high = (uint64_t)a_high * b_high;
+
+    const uint64_t cross = (low_low >> 32u) + (uint32_t)high_low + (uint32_t)low_high;
+    return high_high + (high_low >> 32u) + (low_high >> 32u) + (cross >> 32u);
+}
+
+// Exact for every 32 bit value
+static inline uint32_t div100(uint32_t value) {
+    return ((uint64_t)value * 0x51eb851fu) >> 37u;
+}
+
+// Exact for every 64 bit value
+static inline uint64_t div100_64(uint64_t value) {
+    return mul_high64(value >> 2u, 0x28f5c28f5c28f5c3ull) >> 2u;
+}
+
+static inline char * put_pair(char * end, uint32_t pair) {
+    end -= 2;
+    end[0] = digit_pairs[2 * pair];
+    end[1] = digit_pairs[2 * pair + 1];
+    return end;
+}
+
+// Writes the digits of value so they end at end. Returns where they start.
+static char * format_decimal(char * end, uint64_t value) {
+    while (value >> 32u) {
+        const uint64_t quotient = div100_64(value);
+        end = put_pair(end, (uint32_t)(value - quotient * 100u));
+        value = quotient;
     }
 
-    // Zero-pad the output
-    int i;
-    if (padding > 0) {
-        for (i = 0; i < padding - ndigits - negate; i++) {
-            *buf = pad_char;
-            buf++;
-            max_len--;
-            if (max_len == 0) return orig_max_len;
-        }
+    uint32_t value32 = value;
+    while (value32 >= 100) {
+        const uint32_t quotient = div100(value32);
+        end = put_pair(end, value32 - quotient * 100u);
+        value32 = quotient;
     }
 
-    // Output the digits
-    for (i = ndigits - 1; i >= 0; i--) {
-        *buf = tmp_buf[i];
-        buf++;
-        max_len--;
-        if (max_len == 0) return orig_max_len;
+    if (value32 >= 10) { return put_pair(end, value32); }
+    *--end = '0' + value32;
+    return end;
+}
+
+static char * format_hex(char * end, uint64_t value, bool uppercase) {
+    const char * digits = uppercase ? upper_case_digits : lower_case_digits;
+    do {
+        *--end = digits[value & 0xf];
+        value >>= 4u;
+    } while (value != 0);
+    return end;
+}
+
+static void format_number(struct PrintfOutput * out,
+                          const struct PrintfSpec * spec,
+                          uint64_t value,
+                          bool negative,
+                          const char * prefix,
+                          bool hex,
+                          bool uppercase) {
+    char number[NUMBER_BUFFER_SIZE];
+    char * const end = number + NUMBER_BUFFER_SIZE;
+    char * start = end;
+
+    // An explicit precision of 0 prints no digits for 0
+    if (value != 0 || spec->precision != 0) {
+        start = hex ? format_hex(end, value, uppercase) : format_decimal(end, value);
     }
-    if (ndigits == 0 && padding <= 0) {
-        *buf = '0';
-        buf++;
-        max_len--;
-        if (max_len == 0) return orig_max_len;
+    const int ndigits = end - start;
+
+    char sign[3] = {0};
+    int nsign = 0;
+    if (negative) {
+        sign[nsign++] = '-';
+    } else if (prefix != NULL) {
+        sign[nsign++] = prefix[0];
+        sign[nsign++] = prefix[1];
+    } else if (spec->flags & FLAG_PLUS) {
+        sign[nsign++] = '+';
+    } else if (spec->flags & FLAG_SPACE) {
+        sign[nsign++] = ' ';
     }
 
-    return orig_max_len - max_len;
+    int zeros = spec->precision > ndigits ? spec->precision - ndigits : 0;
+    if ((spec->flags & FLAG_ZERO) && !(spec->flags & FLAG_LEFT) && spec->precision < 0) {
+        const int fill = spec->width - nsign - ndigits;
+        if (fill > zeros) { zeros = fill; }
+    }
+    const int padding = spec->width - nsign - zeros - ndigits;
+
+    if (!(spec->flags & FLAG_LEFT)) { out_repeat(out, ' ', padding); }
+    out_string(out, sign, nsign);
+    out_repeat(out, '0', zeros);
+    out_string(out, start, ndigits);
+    if (spec->flags & FLAG_LEFT) { out_repeat(out, ' ', padding); }
+}
+
+static void format_string(struct PrintfOutput * out,
+                          const struct PrintfSpec * spec,
+                          const char * s) {
+    if (s == NULL) { s = "(null)"; }
+
+    // Don't look further than the precision, the string doesn't need to be terminated then
+    int length = 0;
+    while ((spec->precision < 0 || length < spec->precision) && s[length] != '\0') { length++; }
+
+    const int padding = spec->width - length;
+    if (!(spec->flags & FLAG_LEFT)) { out_repeat(out, ' ', padding); }
+    out_string(out, s, length);
+    if (spec->flags & FLAG_LEFT) { out_repeat(out, ' ', padding); }
 }
 
-// args must already have been started
-// TODO: properly stop at buflen. Otherwise there is a buffer overflow.
-int os_vsnprintf(char * buf, int buflen, const char * str_buf, va_list args) {
-    if (buflen == 0) return 0;
-    buflen--;
-    if (buflen == 0) {
-        buf[0] = 0;
-        return 1;
+static uint64_t arg_unsigned(struct PrintfArgs * args, uint32_t size) {
+    if (size == 8) { return arg_u64(args); }
+
+    const uint32_t value = arg_u32(args);
+    if (size == 1) { return (uint8_t)value; }
+    if (size == 2) { return (uint16_t)value; }
+    return value;
+}
+
+static int64_t arg_signed(struct PrintfArgs * args, uint32_t size) {
+    if (size == 8) { return (int64_t)arg_u64(args); }
+
+    const uint32_t value = arg_u32(args);
+    if (size == 1) { return (int8_t)value; }
+    if (size == 2) { return (int16_t)value; }
+    return (int32_t)value;
+}
+
+static int read_number(const char ** format) {
+    int value = 0;
+    while (**format >= '0' && **format <= '9') {
+        value = value * 10 + (**format - '0');
+        (*format)++;
     }
-    int nwritten = 0;
-    int t_arg;
-    char * str_arg;
-    int padding = -1;
-    char pad_char = 0;
-    while (*str_buf != '\0') {
-        int n = 0;
-        if (*str_buf == '%') {
-            str_buf++;
-        // This label is where we go after we've read an option.
-        reread_switch:;
-            switch (*str_buf) {
-                case '0':
-                    // Zero-padding... Read all the numbers.
-                    // Then restart the switch statement.
-                    padding = 0;
-                    pad_char = '0';
-                    while (*str_buf <= '9' && *str_buf >= '0') {
-                        padding *= 10;
-                        padding += *str_buf - '0';
-                        str_buf++;
-                    }
-                    goto reread_switch;
-                    break;
-                case 'X':
-                    t_arg = va_arg(args, int);
-                    n = print_int(buf, buflen, t_arg, 16, 1, padding, pad_char, 1);
-                    break;
-                case 'x':
-                    t_arg = va_arg(args, int);
-                    n = print_int(buf, buflen, t_arg, 16, 1, padding, pad_char, 0);
-                    break;
-                case 'd':
-                case 'i':
-                    t_arg = va_arg(args, int);
-                    n = print_int(buf, buflen, t_arg, 10, 0, padding, pad_char, 0);
-                    break;
-                case 'u':
-                    t_arg = va_arg(args, int);
-                    n = print_int(buf, buflen, t_arg, 10, 1, padding, pad_char, 0);
-                    break;
-                case 'c':
-                    t_arg = va_arg(args, int);
-                    *buf = t_arg;
-                    n = 1;
-                    break;
-                case 's':
-                    str_arg = va_arg(args, char *);
-                    strncpy(buf, str_arg, buflen);
-                    n = strlen(str_arg);
-                    if (n > buflen) { n = buflen; }
-                    break;
-                case '%':
-                    *buf = '%';
-                    n = 1;
-                    break;
+    return value;
+}
+
+static int format(char * buf, int buflen, const char * fmt, struct PrintfArgs * args) {
+    struct PrintfOutput out = {
+        .buf = buf,
+        .size = buflen > 0 ? buflen : 0,
+        .length = 0,
+    };
+
+    while (*fmt != '\0') {
+        // Copy everything up to the next conversion at once
+        const char * literal = fmt;
+        while (*fmt != '\0' && *fmt != '%') { fmt++; }
+        out_string(&out, literal, fmt - literal);
+        if (*fmt == '\0') { break; }
+
+        const char * conversion_start = fmt;
+        fmt++;
+
+        struct PrintfSpec spec = {
+            .flags = 0,
+            .width = 0,
+            .precision = -1,
+            .size = 4,
+        };
+
+        while (true) {
+            if (*fmt == '-') {
+                spec.flags |= FLAG_LEFT;
+            } else if (*fmt == '+') {
+                spec.flags |= FLAG_PLUS;
+            } else if (*fmt == ' ') {
+                spec.flags |= FLAG_SPACE;
+            } else if (*fmt == '#') {
+                spec.flags |= FLAG_ALT;
+            } else if (*fmt == '0') {
+                spec.flags |= FLAG_ZERO;
+            } else {
+                break;
             }
-            // Reset all the options
-            padding = -1;
+            fmt++;
+        }
+
+        if (*fmt == '*') {
+            spec.width = (int)arg_u32(args);
+            if (spec.width < 0) {
+                spec.flags |= FLAG_LEFT;
+                spec.width = -spec.width;
+            }
+            fmt++;
         } else {
-            *buf = *str_buf;
-            n = 1;
+            spec.width = read_number(&fmt);
+        }
+
+        if (*fmt == '.') {
+            fmt++;
+            if (*fmt == '*') {
+                spec.precision = (int)arg_u32(args);
+                if (spec.precision < 0) { spec.precision = -1; }
+                fmt++;
+            } else {
+                spec.precision = read_number(&fmt);
+            }
         }
-        buf += n;
-        buflen -= n;
-        nwritten += n;
-        if (buflen <= 0) {
-            // Return!
-            break;
+
+        if (fmt[0] == 'h' && fmt[1] == 'h') {
+            spec.size = 1;
+            fmt += 2;
+        } else if (fmt[0] == 'l' && fmt[1] == 'l') {
+            spec.size = 8;
+            fmt += 2;
+        } else if (*fmt == 'h') {
+            spec.size = 2;
+            fmt++;
+        } else if (*fmt == 'j') {
+            spec.size = sizeof(uint64_t);
+            fmt++;
+        } else if (*fmt == 'l' || *fmt == 'z' || *fmt == 't') {
+            spec.size = sizeof(size_t);
+            fmt++;
+        }
+
+        switch (*fmt) {
+            case 'd':
+            case 'i': {
+                const int64_t value = arg_signed(args, spec.size);
+                const uint64_t magnitude = value < 0 ? -(uint64_t)value : (uint64_t)value;
+                format_number(&out, &spec, magnitude, value < 0, NULL, false, false);
+                break;
+            }
+            case 'u':
+                format_number(
+                    &out, &spec, arg_unsigned(args, spec.size), false, NULL, false, false);
+                break;
+            case 'x':
+            case 'X': {
+                const uint64_t value = arg_unsigned(args, spec.size);
+                const bool upper = *fmt == 'X';
+                const char * prefix = (spec.flags & FLAG_ALT) && value != 0 ? (upper ? "0X" : "0x")
+                                                                            : NULL;
+                format_number(&out, &spec, value, false, prefix, true, upper);
+                break;
+            }
+            case 'p':
+                // All 8 digits, so addresses line up
+                spec.precision = 2 * sizeof(void *);
+                format_number(
+                    &out, &spec, (size_t)arg_pointer(args), false, "0x", true, false);
+                break;
+            case 'c': {
+                const char c = (char)arg_u32(args);
+                if (!(spec.flags & FLAG_LEFT)) { out_repeat(&out, ' ', spec.width - 1); }
+                out_char(&out, c);
+                if (spec.flags & FLAG_LEFT) { out_repeat(&out, ' ', spec.width - 1); }
+                break;
+            }
+            case 's':
+                format_string(&out, &spec, arg_pointer(args));
+                break;
+            case '%':
+                out_char(&out, '%');
+                break;
+            case '\0':
+                // A lone % at the end
+                out_string(&out, conversion_start, fmt - conversion_start);
+                continue;
+            default:
+                // Unknown conversions are printed as they are
+                out_string(&out, conversion_start, fmt + 1 - conversion_start);
+                break;
         }
-        str_buf++;
+        fmt++;
     }
-    buf[0] = 0;
-    nwritten++;
 
-    return nwritten;
+    if (out.size > 0) { buf[out.length < out.size ? out.length : out.size - 1] = '\0'; }
+    return out.length;
+}
+
+int os_vsnprintf(char * buf, int buflen, const char * fmt, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    struct PrintfArgs printf_args = {
+        .va = &copy,
+        .words = NULL,
+    };
+    const int length = format(buf, buflen, fmt, &printf_args);
+    va_end(copy);
+    return length;
 }
 
 int os_snprintf(char * buf, int buflen, const char * fmt, ...) {
@@ -166,19 +394,28 @@ int os_snprintf(char * buf, int buflen, const char * fmt, ...) {
     return n;
 }
 
+int os_snprintf_words(char * buf, int buflen, const char * fmt, const uint32_t * words) {
+    struct PrintfArgs printf_args = {
+        .va = NULL,
+        .words = words,
+    };
+    return format(buf, buflen, fmt, &printf_args);
+}
+
 void puts(const char * s) {
-    while (*s != '\0') {
-        chipset.uart_putc(*s, 0);
-        s++;
-    }
+    chipset.uart_write(s, strlen((char *)s), 0);
 }
 
 int kprintf(const char * str_buf, ...) {
+    // Log records from before this message come first
+    klog_drain();
+
     va_list args;
     va_start(args, str_buf);
     char buf[256];
-    int n = os_vsnprintf(buf, 255, str_buf, args);
+    int n = os_vsnprintf(buf, sizeof(buf), str_buf, args);
     va_end(args);
-    puts(buf);
+
+    chipset.uart_write(buf, n < (int)sizeof(buf) ? n : (int)sizeof(buf) - 1, 0);
     return n;
 }
@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <string.h>
 
 char * strcpy(char * dst, char * src) {
@@ -34,31 +35,137 @@ char * strcatc(char * dst, char src) {
     return dst;
 }
 
+// Word at a time helpers. HASZERO(x) is non-zero if any byte of x is zero. Aligned word loads
+// never cross a page, so reading the rest of the word a string ends in is safe.
+#define WORD       sizeof(uint32_t)
+#define ONES       0x01010101u
+#define HIGHS      0x80808080u
+#define HASZERO(x) (((x)-ONES) & (~(x)) & HIGHS)
+
+// May alias the bytes of the strings
+typedef uint32_t __attribute__((__may_alias__)) word_t;
+
+static inline bool word_aligned(const void * p) {
+    return ((uintptr_t)p & (WORD - 1)) == 0;
+}
+
+// Strings that start at the same offset in a word can be compared a word at a time, until the
+// words differ or contain the end. Otherwise they are compared byte by byte.
 uint32_t strcmp(char * s1, char * s2) {
-    for (uint32_t i = 0;; i++) {
-        if (s1[i] != s2[i]) { return s1[i] < s2[i] ? -1 : 1; }
+    const uint8_t * a = (const uint8_t *)s1;
+    const uint8_t * b = (const uint8_t *)s2;
 
-        if (s1[i] == '\0') { return 0; }
+    if ((((uintptr_t)a ^ (uintptr_t)b) & (WORD - 1)) == 0) {
+        for (; !word_aligned(a); a++, b++) {
+            if (*a != *b || *a == '\0') { return *a - *b; }
+        }
+        const word_t * wa = (const word_t *)a;
+        const word_t * wb = (const word_t *)b;
+        while (*wa == *wb && !HASZERO(*wa)) {
+            wa++;
+            wb++;
+        }
+        a = (const uint8_t *)wa;
+        b = (const uint8_t *)wb;
     }
-}
 
+    while (*a == *b && *a != '\0') {
+        a++;
+        b++;
+    }
+    return *a - *b;
+}
 
 uint32_t strncmp(char * s1, char * s2, size_t n) {
-    while (n && *s1 && (*s1 == *s2)) {
-        ++s1;
-        ++s2;
-        --n;
+    const uint8_t * a = (const uint8_t *)s1;
+    const uint8_t * b = (const uint8_t *)s2;
+
+    if ((((uintptr_t)a ^ (uintptr_t)b) & (WORD - 1)) == 0) {
+        for (; n != 0 && !word_aligned(a); a++, b++, n--) {
+            if (*a != *b || *a == '\0') { return *a - *b; }
+        }
+        const word_t * wa = (const word_t *)a;
+        const word_t * wb = (const word_t *)b;
+        while (n >= WORD && *wa == *wb && !HASZERO(*wa)) {
+            wa++;
+            wb++;
+            n -= WORD;
+        }
+        a = (const uint8_t *)wa;
+        b = (const uint8_t *)wb;
     }
-    if (n == 0) {
-        return 0;
-    } else {
-        return (*(uint8_t *)s1 - *(uint8_t *)s2);
+
+    for (; n != 0; a++, b++, n--) {
+        if (*a != *b || *a == '\0') { return *a - *b; }
     }
+    return 0;
 }
 
 uint32_t strlen(char * str) {
-    for (uint32_t i = 0;; i++) {
-        if (str[i] == '\0') { return i; }
+    const char * s = str;
+    for (; !word_aligned(s); s++) {
+        if (*s == '\0') { return s - str; }
+    }
+
+    const word_t * w = (const word_t *)s;
+    while (!HASZERO(*w)) { w++; }
+
+    for (s = (const char *)w; *s != '\0'; s++)
+        ;
+    return s - str;
+}
+
+size_t strnlen(const char * str, size_t maxlen) {
+    const char * end = memchr(str, '\0', maxlen);
+    return end == NULL ? maxlen : (size_t)(end - str);
+}
+
+void * memchr(const void * src, int c, size_t n) {
+    const uint8_t * s = src;
+    const uint8_t byte = (uint8_t)c;
+
+    for (; n != 0 && !word_aligned(s); s++, n--) {
+        if (*s == byte) { return (void *)s; }
+    }
+
+    if (n >= WORD) {
+        // A byte equal to c is a zero byte after the xor
+        const uint32_t k = ONES * byte;
+        const word_t * w = (const word_t *)s;
+        while (n >= WORD && !HASZERO(*w ^ k)) {
+            w++;
+            n -= WORD;
+        }
+        s = (const uint8_t *)w;
+    }
+
+    for (; n != 0; s++, n--) {
+        if (*s == byte) { return (void *)s; }
+    }
+    return NULL;
+}
+
+int memcmp(const void * s1, const void * s2, size_t n) {
+    const uint8_t * a = s1;
+    const uint8_t * b = s2;
+
+    if ((((uintptr_t)a ^ (uintptr_t)b) & (WORD - 1)) == 0) {
+        for (; n != 0 && !word_aligned(a); a++, b++, n--) {
+            if (*a != *b) { return *a - *b; }
+        }
+        const word_t * wa = (const word_t *)a;
+        const word_t * wb = (const word_t *)b;
+        while (n >= WORD && *wa == *wb) {
+            wa++;
+            wb++;
+            n -= WORD;
+        }
+        a = (const uint8_t *)wa;
+        b = (const uint8_t *)wb;
+    }
+
+    for (; n != 0; a++, b++, n--) {
+        if (*a != *b) { return *a - *b; }
     }
     return 0;
 }
@@ -0,0 +1,153 @@
+#include <bench.h>
+#include <klog.h>
+#include <string.h>
+#include <test.h>
+
+#define BENCH_KLOG_ITERATIONS 1000
+
+TEST_CREATE(test_klog_record, {
+    klog_set_console(false);
+    uint32_t position = klog_head();
+
+    char name[8];
+    strcpy(name, "hello");
+    KLOG(KLOG_INFO, "value %u %s 0x%x", 42, name, 0xbeef);
+    // Strings are copied, so the record doesn't depend on the buffer anymore
+    strcpy(name, "world");
+
+    struct KlogRecord record;
+    uint32_t lost = 0;
+    ASSERT(klog_read(&position, &record, &lost));
+    ASSERT_EQ(lost, 0);
+    ASSERT_EQ(record.level, KLOG_INFO);
+    ASSERT_EQ(record.nwords, 3);
+
+    char buf[64];
+    klog_format(buf, sizeof(buf), &record);
+    ASSERT_EQ(strcmp(buf, "value 42 hello 0xbeef"), 0);
+
+    // Nothing more to read
+    ASSERT(!klog_read(&position, &record, &lost));
+
+    klog_set_console(true);
+})
+
+TEST_CREATE(test_klog_64bit, {
+    klog_set_console(false);
+    uint32_t position = klog_head();
+
+    KLOG(KLOG_INFO, "%u %llx %s %llu", 1, 0x123456789abcdefull, "str", 10000000000ull);
+
+    struct KlogRecord record;
+    uint32_t lost = 0;
+    ASSERT(klog_read(&position, &record, &lost));
+    ASSERT_EQ(record.nwords, 6);
+
+    char buf[64];
+    klog_format(buf, sizeof(buf), &record);
+    ASSERT_EQ(strcmp(buf, "1 123456789abcdef str 10000000000"), 0);
+
+    klog_set_console(true);
+})
+
+TEST_CREATE(test_klog_runtime_level, {
+    klog_set_console(false);
+    const uint32_t level = klog_level;
+
+    klog_set_level(KLOG_WARN);
+    uint32_t head = klog_head();
+    KLOG(KLOG_DEBUG, "dropped");
+    INFO("dropped too");
+    ASSERT_EQ(klog_head(), head);
+
+    klog_set_level(KLOG_DEBUG);
+    KLOG(KLOG_DEBUG, "recorded");
+    ASSERT_EQ(klog_head(), head + 1);
+
+    klog_set_level(level);
+    klog_set_console(true);
+})
+
+TEST_CREATE(test_klog_overwrite, {
+    klog_set_console(false);
+    uint32_t position = klog_head();
+
+    for (uint32_t i = 0; i < KLOG_RECORDS + 10; i++) { KLOG(KLOG_INFO, "message %u", i); }
+
+    // The oldest 10 were overwritten
+    struct KlogRecord record;
+    uint32_t lost = 0;
+    ASSERT(klog_read(&position, &record, &lost));
+    ASSERT_EQ(lost, 10);
+    ASSERT_EQ(record.args[0], 10);
+
+    uint32_t count = 1;
+    while (klog_read(&position, &record, &lost)) { count++; }
+    ASSERT_EQ(count, KLOG_RECORDS);
+    ASSERT_EQ(record.args[0], KLOG_RECORDS + 9);
+
+    klog_set_console(true);
+})
+
+TEST_CREATE(test_klog_long_strings, {
+    klog_set_console(false);
+    uint32_t position = klog_head();
+
+    const char * long_string =
+        "a string that is a lot longer than the space for strings in a record, so it is cut";
+    KLOG(KLOG_INFO, "%s|%s", long_string, "second");
+
+    struct KlogRecord record;
+    uint32_t lost = 0;
+    ASSERT(klog_read(&position, &record, &lost));
+
+    char buf[128];
+    const uint32_t length = klog_format(buf, sizeof(buf), &record);
+    ASSERT_EQ(length, KLOG_STRING_SPACE);
+    ASSERT_EQ(strncmp(buf, (char *)long_string, KLOG_STRING_SPACE - 1), 0);
+    ASSERT_EQ(buf[KLOG_STRING_SPACE - 1], '|');
+
+    klog_set_console(true);
+})
+
+TEST_CREATE(test_klog_const_strings, {
+    klog_set_console(false);
+    uint32_t position = klog_head();
+
+    KLOG_CONST(KLOG_INFO, 1u, "%s:%i %s", __FILE__, 7, "copied");
+
+    struct KlogRecord record;
+    uint32_t lost = 0;
+    ASSERT(klog_read(&position, &record, &lost));
+    // The first string is kept as a pointer and takes no string space, only the second is copied
+    ASSERT_EQ(record.args[0], (uint32_t)__FILE__);
+    ASSERT_EQ(record.string_mask, 1u << 2);
+    ASSERT_EQ(record.args[2], 0);
+
+    char buf[128];
+    char expected[128];
+    klog_format(buf, sizeof(buf), &record);
+    os_snprintf(expected, sizeof(expected), "%s:7 copied", __FILE__);
+    ASSERT_EQ(strcmp(buf, expected), 0);
+
+    klog_set_console(true);
+})
+
+TEST_CREATE(bench_klog_vs_snprintf, {
+    klog_set_console(false);
+    char buf[256];
+
+    uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_KLOG_ITERATIONS; i++) {
+        KLOG(KLOG_INFO, "bench message %u 0x%x", i, i * 3);
+    }
+    bench_report("klog record", bench_counter() - start, BENCH_KLOG_ITERATIONS);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_KLOG_ITERATIONS; i++) {
+        os_snprintf(buf, sizeof(buf), "bench message %u 0x%x", i, i * 3);
+    }
+    bench_report("snprintf only", bench_counter() - start, BENCH_KLOG_ITERATIONS);
+
+    klog_set_console(true);
+})
@@ -0,0 +1,155 @@
+#include <bench.h>
+#include <stdlib.h>
+#include <string.h>
+#include <test.h>
+
+#define MEM_TEST_BUFFER     512
+#define BENCH_MEM_SIZE      (64 * 1024)
+#define BENCH_MEM_REPEATS   16
+
+static uint8_t mem_source[MEM_TEST_BUFFER];
+static uint8_t mem_dest[MEM_TEST_BUFFER];
+static uint8_t mem_expected[MEM_TEST_BUFFER];
+
+static void mem_fill_pattern(uint8_t * buf, size_t n, uint32_t seed) {
+    for (size_t i = 0; i < n; i++) { buf[i] = (uint8_t)(seed + i * 7 + (i >> 3)); }
+}
+
+// The byte loop the optimized routines replaced, as reference and for the benchmarks
+static void byte_copy(uint8_t * dest, const uint8_t * src, size_t n) {
+    for (size_t i = 0; i < n; i++) { dest[i] = src[i]; }
+}
+
+static bool mem_equal(const uint8_t * a, const uint8_t * b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != b[i]) { return false; }
+    }
+    return true;
+}
+
+TEST_CREATE(test_memcpy_alignments, {
+    mem_fill_pattern(mem_source, MEM_TEST_BUFFER, 1);
+
+    // Every combination of source and destination alignment, with sizes around the block sizes
+    for (size_t n = 0; n < 140; n++) {
+        for (size_t src_offset = 0; src_offset < 4; src_offset++) {
+            for (size_t dest_offset = 0; dest_offset < 4; dest_offset++) {
+                mem_fill_pattern(mem_dest, MEM_TEST_BUFFER, 99);
+                mem_fill_pattern(mem_expected, MEM_TEST_BUFFER, 99);
+                byte_copy(mem_expected + dest_offset, mem_source + src_offset, n);
+
+                void * result = memcpy(mem_dest + dest_offset, mem_source + src_offset, n);
+                ASSERT_EQ(result, mem_dest + dest_offset);
+                ASSERT(mem_equal(mem_dest, mem_expected, MEM_TEST_BUFFER));
+            }
+        }
+    }
+})
+
+TEST_CREATE(test_memset_alignments, {
+    for (size_t n = 0; n < 100; n++) {
+        for (size_t offset = 0; offset < 4; offset++) {
+            mem_fill_pattern(mem_dest, MEM_TEST_BUFFER, 5);
+            mem_fill_pattern(mem_expected, MEM_TEST_BUFFER, 5);
+            for (size_t i = 0; i < n; i++) { mem_expected[offset + i] = 0xa5; }
+
+            // Only the low byte of the value counts
+            void * result = memset(mem_dest + offset, 0x1a5, n);
+            ASSERT_EQ(result, mem_dest + offset);
+            ASSERT(mem_equal(mem_dest, mem_expected, MEM_TEST_BUFFER));
+        }
+    }
+})
+
+static const int mem_move_deltas[] = {-37, -32, -5, -4, -1, 1, 3, 4, 5, 32, 37};
+
+TEST_CREATE(test_memmove_overlap, {
+    for (size_t d = 0; d < sizeof(mem_move_deltas) / sizeof(mem_move_deltas[0]); d++) {
+        for (size_t n = 0; n < 150; n += 7) {
+            for (size_t offset = 0; offset < 4; offset++) {
+                uint8_t * src = mem_dest + 200 + offset;
+                uint8_t * dest = src + mem_move_deltas[d];
+
+                mem_fill_pattern(mem_dest, MEM_TEST_BUFFER, 3);
+                mem_fill_pattern(mem_expected, MEM_TEST_BUFFER, 3);
+                // The reference goes through a separate buffer
+                byte_copy(mem_source, src, n);
+                byte_copy(mem_expected + (dest - mem_dest), mem_source, n);
+
+                ASSERT_EQ(memmove(dest, src, n), dest);
+                ASSERT(mem_equal(mem_dest, mem_expected, MEM_TEST_BUFFER));
+            }
+        }
+    }
+})
+
+TEST_CREATE(test_memmove_large, {
+    // Used to copy through a buffer on the stack, which overflowed for sizes like this
+    const size_t n = 48 * 1024;
+    uint8_t * buf = kmalloc(n + 64);
+    mem_fill_pattern(buf, n + 64, 11);
+
+    memmove(buf + 64, buf, n);
+    for (size_t i = 0; i < n; i++) {
+        if (buf[64 + i] != (uint8_t)(11 + i * 7 + (i >> 3))) {
+            kfree(buf);
+            ASSERT(false);
+        }
+    }
+
+    kfree(buf);
+})
+
+struct MemTestStruct {
+    uint32_t a;
+    uint16_t b;
+    uint8_t c[9];
+};
+
+TEST_CREATE(test_mem_constant_size, {
+    // Sizes known at compile time go through the compiler's inline expansion
+    struct MemTestStruct x;
+    struct MemTestStruct y;
+    memset(&x, 0x11, sizeof(x));
+    memcpy(&y, &x, sizeof(x));
+    ASSERT_EQ(y.a, 0x11111111);
+    ASSERT_EQ(y.b, 0x1111);
+    ASSERT_EQ(y.c[8], 0x11);
+})
+
+static void bench_mem_report(const char * name, uint64_t ticks) {
+    bench_report(name, ticks, BENCH_MEM_REPEATS);
+
+    const uint64_t bytes = (uint64_t)BENCH_MEM_SIZE * BENCH_MEM_REPEATS;
+    const uint32_t mib_per_s = ticks == 0 ? 0 : (bytes * bench_counter_frequency() / ticks) >> 20u;
+    kprintf("[BENCH] %s: %u MiB/s\n", name, mib_per_s);
+}
+
+TEST_CREATE(bench_mem_bandwidth, {
+    uint8_t * src = kmalloc(BENCH_MEM_SIZE + 8);
+    uint8_t * dest = kmalloc(BENCH_MEM_SIZE + 8);
+    mem_fill_pattern(src, BENCH_MEM_SIZE + 8, 0);
+
+    uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_MEM_REPEATS; i++) { byte_copy(dest, src, BENCH_MEM_SIZE); }
+    bench_mem_report("byte loop copy 64KiB", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_MEM_REPEATS; i++) { memcpy(dest, src, BENCH_MEM_SIZE); }
+    bench_mem_report("memcpy 64KiB aligned", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_MEM_REPEATS; i++) { memcpy(dest, src + 1, BENCH_MEM_SIZE); }
+    bench_mem_report("memcpy 64KiB misaligned", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_MEM_REPEATS; i++) { memmove(src + 4, src, BENCH_MEM_SIZE); }
+    bench_mem_report("memmove 64KiB backwards", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_MEM_REPEATS; i++) { memset(dest, 0, BENCH_MEM_SIZE); }
+    bench_mem_report("memset 64KiB", bench_counter() - start);
+
+    kfree(src);
+    kfree(dest);
+})
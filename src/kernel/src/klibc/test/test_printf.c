@@ -0,0 +1,147 @@
+#include <bench.h>
+#include <stdio.h>
+#include <string.h>
+#include <test.h>
+
+#define BENCH_PRINTF_ITERATIONS 1000
+
+// Checks that formatting gives the expected string and length
+#define ASSERT_FORMAT(expected, ...)                             \
+    {                                                            \
+        char buf[96];                                            \
+        const int n = os_snprintf(buf, sizeof(buf), __VA_ARGS__); \
+        ASSERT_EQ(strcmp(buf, expected), 0);                     \
+        ASSERT_EQ(n, (int)strlen(expected));                     \
+    }
+
+TEST_CREATE(test_printf_integers, {
+    ASSERT_FORMAT("0 -1 4294967295", "%d %d %u", 0, -1, 0xffffffffu);
+    ASSERT_FORMAT("-2147483648", "%d", 0x80000000u);
+    ASSERT_FORMAT("-0015 15    0xff", "%05d %-5u %#x", -15, 15, 255);
+    ASSERT_FORMAT("beef BEEF 00001234", "%x %X %08x", 0xbeef, 0xbeef, 0x1234);
+    ASSERT_FORMAT("   00042|-00042  |", "%8.5d|%-8.5d|", 42, -42);
+    ASSERT_FORMAT("+5  5|", "%+d % d|", 5, 5);
+    ASSERT_FORMAT("|    |", "|%4.0d|", 0);
+    ASSERT_FORMAT("44 4464", "%hhu %hd", 300, 70000);
+    ASSERT_FORMAT("    7|7    |", "%*d|%-*d|", 5, 7, 5, 7);
+})
+
+TEST_CREATE(test_printf_64bit, {
+    ASSERT_FORMAT("18446744073709551615", "%llu", 0xffffffffffffffffull);
+    ASSERT_FORMAT("-9223372036854775808", "%lld", 0x8000000000000000ull);
+    ASSERT_FORMAT("123456789abcdef", "%llx", 0x123456789abcdefull);
+    ASSERT_FORMAT("1 10000000000 2", "%d %llu %d", 1, 10000000000ull, 2);
+    ASSERT_FORMAT("00000012345678901234", "%020llu", 12345678901234ull);
+})
+
+TEST_CREATE(test_printf_strings_pointers, {
+    ASSERT_FORMAT("abc|       abc|abc       |", "%s|%10s|%-10s|", "abc", "abc", "abc");
+    ASSERT_FORMAT("abc|        ab", "%.3s|%10.2s", "abcdef", "abcdef");
+    ASSERT_FORMAT("(null)", "%s", NULL);
+    ASSERT_FORMAT("a    b|c  |", "%c%5c|%-3c|", 'a', 'b', 'c');
+    ASSERT_FORMAT("0x00001234 123 100%", "%p %zu 100%%", (void *)0x1234, (size_t)123);
+
+    // Precision limits how far a string is read, so it doesn't need a terminator
+    char unterminated[3];
+    unterminated[0] = 'x';
+    unterminated[1] = 'y';
+    unterminated[2] = 'z';
+    ASSERT_FORMAT("xy", "%.2s", unterminated);
+})
+
+TEST_CREATE(test_printf_truncation, {
+    char buf[16];
+    memset(buf, '#', sizeof(buf));
+
+    // Returns the full length, writes at most 8 bytes including the terminator
+    ASSERT_EQ(os_snprintf(buf, 8, "%s=%d", "value", -12345), 12);
+    ASSERT_EQ(strcmp(buf, "value=-"), 0);
+    ASSERT_EQ(buf[8], '#');
+
+    ASSERT_EQ(os_snprintf(buf, 1, "abc"), 3);
+    ASSERT_EQ(buf[0], '\0');
+    ASSERT_EQ(buf[1], 'a');
+
+    // Nothing is written without room
+    buf[0] = '#';
+    ASSERT_EQ(os_snprintf(buf, 0, "abc"), 3);
+    ASSERT_EQ(buf[0], '#');
+})
+
+TEST_CREATE(test_printf_words, {
+    uint32_t words[4];
+    words[0] = 7;
+    words[1] = 0x89abcdef;
+    words[2] = 0x01234567;
+    words[3] = (uint32_t) "str";
+
+    char buf[64];
+    os_snprintf_words(buf, sizeof(buf), "%u %llx %s", words);
+    ASSERT_EQ(strcmp(buf, "7 123456789abcdef str"), 0);
+})
+
+// The implementation this one replaced, to compare against. It divides once per digit.
+static int old_print_int(char * buf, int buflen, int val, int base, int is_unsigned) {
+    static const char digits[16] = "0123456789abcdef";
+    int max_len = buflen;
+    int negate = 0;
+    if (val < 0 && !is_unsigned) {
+        val = -val;
+        negate = 1;
+    }
+    unsigned int temp = val;
+
+    if (negate) {
+        *buf++ = '-';
+        max_len--;
+    }
+
+    char tmp_buf[64];
+    int ndigits = 0;
+    while (temp != 0) {
+        tmp_buf[ndigits++] = digits[temp % base];
+        temp = temp / base;
+    }
+
+    for (int i = ndigits - 1; i >= 0 && max_len > 0; i--) {
+        *buf++ = tmp_buf[i];
+        max_len--;
+    }
+    if (ndigits == 0) {
+        *buf = '0';
+        max_len--;
+    }
+    return buflen - max_len;
+}
+
+TEST_CREATE(bench_printf_decimal, {
+    char buf[64];
+
+    uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PRINTF_ITERATIONS; i++) {
+        old_print_int(buf, sizeof(buf), 3000000000u + i * 7919u, 10, 1);
+    }
+    bench_report("old print_int %u (10 digits)", bench_counter() - start, BENCH_PRINTF_ITERATIONS);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PRINTF_ITERATIONS; i++) {
+        os_snprintf(buf, sizeof(buf), "%u", 3000000000u + i * 7919u);
+    }
+    bench_report("os_snprintf %u (10 digits)", bench_counter() - start, BENCH_PRINTF_ITERATIONS);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PRINTF_ITERATIONS; i++) {
+        os_snprintf(buf, sizeof(buf), "%llu", 10000000000000000000ull + i);
+    }
+    bench_report("os_snprintf %llu (20 digits)", bench_counter() - start, BENCH_PRINTF_ITERATIONS);
+})
+
+TEST_CREATE(bench_printf_message, {
+    char buf[128];
+
+    const uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_PRINTF_ITERATIONS; i++) {
+        os_snprintf(buf, sizeof(buf), "[INFO] %s: %d bytes at 0x%08x", "alloc", i * 13, i << 12);
+    }
+    bench_report("os_snprintf log message", bench_counter() - start, BENCH_PRINTF_ITERATIONS);
+})
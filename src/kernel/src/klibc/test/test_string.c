@@ -0,0 +1,210 @@
+#include <bench.h>
+#include <klibc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <test.h>
+
+#define STRING_TEST_BUFFER   96
+#define BENCH_STRING_SIZE    4096
+#define BENCH_STRING_REPEATS 64
+
+static char string_a[STRING_TEST_BUFFER];
+static char string_b[STRING_TEST_BUFFER];
+
+// The byte loops the word at a time versions replaced, as reference and for the benchmarks
+static uint32_t byte_strlen(const char * str) {
+    uint32_t i = 0;
+    while (str[i] != '\0') { i++; }
+    return i;
+}
+
+static int32_t byte_strcmp(const char * s1, const char * s2) {
+    for (uint32_t i = 0;; i++) {
+        if (s1[i] != s2[i]) { return (uint8_t)s1[i] < (uint8_t)s2[i] ? -1 : 1; }
+        if (s1[i] == '\0') { return 0; }
+    }
+}
+
+static int32_t byte_strncmp(const char * s1, const char * s2, size_t n) {
+    while (n && *s1 && (*s1 == *s2)) {
+        ++s1;
+        ++s2;
+        --n;
+    }
+    return n == 0 ? 0 : *(uint8_t *)s1 - *(uint8_t *)s2;
+}
+
+static os_size_t byte_strspn(const char * s, const char * accept) {
+    os_size_t length = 0;
+    while (s[length] != '\0') {
+        bool ok = false;
+        for (uint32_t i = 0; i < byte_strlen(accept); i++) {
+            if (s[length] == accept[i]) { ok = true; }
+        }
+        if (!ok) { break; }
+        length++;
+    }
+    return length;
+}
+
+static int32_t sign(int32_t x) {
+    return (x > 0) - (x < 0);
+}
+
+// Fills with a few different letters, so that equal runs and differences both happen
+static void string_fill(char * buf, uint32_t offset, uint32_t length, uint32_t seed) {
+    for (uint32_t i = 0; i < STRING_TEST_BUFFER; i++) { buf[i] = 'x'; }
+    for (uint32_t i = 0; i < length; i++) { buf[offset + i] = 'a' + (seed + i * 3) % 5; }
+    buf[offset + length] = '\0';
+}
+
+TEST_CREATE(test_strlen_alignments, {
+    for (uint32_t offset = 0; offset < 8; offset++) {
+        for (uint32_t length = 0; length < 40; length++) {
+            string_fill(string_a, offset, length, offset);
+            ASSERT_EQ(strlen(string_a + offset), length);
+            ASSERT_EQ(strnlen(string_a + offset, length + 3), length);
+            ASSERT_EQ(strnlen(string_a + offset, length / 2), length / 2);
+        }
+    }
+
+    // Bytes with the high bit set are not the end
+    char high[] = "\x80\xff\x81";
+    ASSERT_EQ(strlen(high), 3);
+})
+
+TEST_CREATE(test_strcmp_alignments, {
+    for (uint32_t offset_a = 0; offset_a < 4; offset_a++) {
+        for (uint32_t offset_b = 0; offset_b < 4; offset_b++) {
+            for (uint32_t length = 0; length < 24; length++) {
+                string_fill(string_a, offset_a, length, 0);
+                string_fill(string_b, offset_b, length, 0);
+                char * a = string_a + offset_a;
+                char * b = string_b + offset_b;
+                ASSERT_EQ(strcmp(a, b), 0);
+                ASSERT_EQ(strncmp(a, b, length + 5), 0);
+
+                // A difference at every position, above and below, including past the end of a
+                for (uint32_t diff = 0; diff <= length; diff++) {
+                    const char saved = b[diff];
+                    b[diff] = (char)0xe0;
+                    ASSERT_EQ(sign((int32_t)strcmp(a, b)), -1);
+                    ASSERT_EQ(sign((int32_t)strcmp(b, a)), 1);
+                    ASSERT_EQ(sign((int32_t)strncmp(a, b, length + 1)), -1);
+                    ASSERT_EQ(strncmp(a, b, diff), 0);
+                    b[diff] = saved;
+                }
+            }
+        }
+    }
+})
+
+TEST_CREATE(test_memchr_memcmp, {
+    for (uint32_t offset = 0; offset < 8; offset++) {
+        for (uint32_t n = 0; n < 40; n++) {
+            string_fill(string_a, offset, n, 1);
+            string_fill(string_b, offset, n, 1);
+            char * a = string_a + offset;
+            ASSERT_EQ(memcmp(a, string_b + offset, n), 0);
+
+            // Only the first match counts, and nothing past n
+            for (uint32_t i = 0; i < n; i++) {
+                const char saved = a[i];
+                a[i] = 'z';
+                ASSERT_EQ(memchr(a, 'z', n), a + i);
+                ASSERT_EQ(memchr(a, 'z', i), NULL);
+                ASSERT_EQ(sign(memcmp(a, string_b + offset, n)), 1);
+                ASSERT_EQ(memcmp(a, string_b + offset, i), 0);
+                a[i] = saved;
+            }
+            ASSERT_EQ(memchr(a, 'q', n), NULL);
+        }
+    }
+
+    // Compared as unsigned bytes, and c is converted to unsigned char
+    ASSERT_EQ(sign(memcmp("\x80", "\x7f", 1)), 1);
+    char high[] = "ab\xf0";
+    ASSERT_EQ(memchr(high, 0x1f0, 3), high + 2);
+})
+
+TEST_CREATE(test_strspn_strcspn, {
+    ASSERT_EQ(os_strspn("aabbcx", "abc"), 5);
+    ASSERT_EQ(os_strspn("xabc", "abc"), 0);
+    ASSERT_EQ(os_strspn("abc", ""), 0);
+    ASSERT_EQ(os_strspn("\xf0\xf1z", "\xf1\xf0"), 2);
+    ASSERT_EQ(os_strcspn("abc/def", "/"), 3);
+    ASSERT_EQ(os_strcspn("abc/def:", ":/"), 3);
+    ASSERT_EQ(os_strcspn("abcdef", "xyz"), 6);
+    ASSERT_EQ(os_strcspn("abc", ""), 3);
+
+    char tokens[] = "/usr//local/bin";
+    ASSERT_EQ(strcmp(os_strtok(tokens, "/"), "usr"), 0);
+    ASSERT_EQ(strcmp(os_strtok(NULL, "/"), "local"), 0);
+    ASSERT_EQ(strcmp(os_strtok(NULL, "/"), "bin"), 0);
+    ASSERT_EQ(os_strtok(NULL, "/"), NULL);
+})
+
+static void bench_string_report(const char * name, uint64_t ticks) {
+    bench_report(name, ticks, BENCH_STRING_REPEATS);
+}
+
+TEST_CREATE(bench_string, {
+    char * a = kmalloc(BENCH_STRING_SIZE + 1);
+    char * b = kmalloc(BENCH_STRING_SIZE + 1);
+    for (uint32_t i = 0; i < BENCH_STRING_SIZE; i++) { a[i] = b[i] = 'a' + i % 26; }
+    a[BENCH_STRING_SIZE] = b[BENCH_STRING_SIZE] = '\0';
+    volatile uint32_t sink = 0;
+
+    uint64_t start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS; i++) { sink += byte_strlen(a); }
+    bench_string_report("byte loop strlen 4KiB", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS; i++) { sink += strlen(a); }
+    bench_string_report("strlen 4KiB", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS; i++) { sink += byte_strcmp(a, b); }
+    bench_string_report("byte loop strcmp 4KiB", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS; i++) { sink += strcmp(a, b); }
+    bench_string_report("strcmp 4KiB", bench_counter() - start);
+
+    // Path lookup compares short names against every directory entry
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS * 64; i++) {
+        sink += byte_strncmp(a, b, 24);
+    }
+    bench_report("byte loop strncmp 24 bytes", bench_counter() - start, BENCH_STRING_REPEATS * 64);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS * 64; i++) { sink += strncmp(a, b, 24); }
+    bench_report("strncmp 24 bytes", bench_counter() - start, BENCH_STRING_REPEATS * 64);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS; i++) {
+        sink += (uintptr_t)memchr(a, '\0', BENCH_STRING_SIZE + 1);
+    }
+    bench_string_report("memchr 4KiB", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS; i++) {
+        sink += memcmp(a, b, BENCH_STRING_SIZE);
+    }
+    bench_string_report("memcmp 4KiB", bench_counter() - start);
+
+    const char * alphabet = "abcdefghijklmnopqrstuvwxyz";
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS; i++) { sink += byte_strspn(a, alphabet); }
+    bench_string_report("quadratic strspn 4KiB", bench_counter() - start);
+
+    start = bench_counter();
+    for (uint32_t i = 0; i < BENCH_STRING_REPEATS; i++) {
+        sink += os_strspn(a, (char *)alphabet);
+    }
+    bench_string_report("bitmap strspn 4KiB", bench_counter() - start);
+
+    kfree(a);
+    kfree(b);
+})
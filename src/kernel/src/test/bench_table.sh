@@ -0,0 +1,29 @@
+#!/bin/bash
+# Joins the benchmark results of a debug and a release build (see BENCH_RESULTS_FILE in bench.h)
+# into a markdown table. `make bench_compare` runs both builds and calls this.
+#
+# usage: bench_table.sh <-O0 results> <-O2 results>
+
+if [ $# -ne 2 ]; then
+    echo "usage: $0 <-O0 results> <-O2 results>" >&2
+    exit 1
+fi
+
+awk -F, '
+    # Lines are <name>,<ticks/op>,<ns/op>,<iterations>
+    FNR == NR {
+        if (!($1 in debug)) { order[count++] = $1 }
+        debug[$1] = $3
+        next
+    }
+    { release[$1] = $3 }
+    END {
+        print "| Benchmark | -O0 ns/op | -O2 ns/op | Speedup |"
+        print "| --- | ---: | ---: | ---: |"
+        for (i = 0; i < count; i++) {
+            name = order[i]
+            if (!(name in release)) { continue }
+            speedup = release[name] > 0 ? sprintf("%.2fx", debug[name] / release[name]) : "-"
+            printf "| %s | %s | %s | %s |\n", name, debug[name], release[name], speedup
+        }
+    }' "$1" "$2"
@@ -3,6 +3,11 @@
 # it will make a list of tests and write this to test.c
 # the makefile will run this file automatically while building,
 # so all tests are automatically executed.
+#
+# usage: generate_tests.sh SEED [OUTPUT [PATTERN [DIRECTORY...]]]
+# OUTPUT defaults to test.c next to this script, PATTERN (a regex, default everything) selects
+# tests by name and the DIRECTORIES (default the current one) are searched for tests.
+# The host build (../../host) uses the optional arguments.
 
 # https://www.gnu.org/software/coreutils/manual/html_node/Random-sources.html
 get_seeded_random()
@@ -15,9 +20,13 @@ get_seeded_random()
 }
 
 DIR="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+OUTPUT=${2:-"$DIR/test.c"}
+PATTERN=${3:-"."}
+SEARCHDIRS=("${@:4}")
+if [ ${#SEARCHDIRS[@]} -eq 0 ]; then SEARCHDIRS=("."); fi
 
 # clear the file
-echo -n "" > "$DIR/test.c"
+echo -n "" > "$OUTPUT"
 
 echo "
 // DO NOT EDIT
@@ -31,31 +40,33 @@ echo "
 
 size_t global_counter = 0;
 
-" >> "$DIR/test.c"
+" >> "$OUTPUT"
 
 echo "Seed used for test order randomization: $1"
 #TESTFNS=$(grep -hr --include "*.c" -oP "(?<=TEST_CREATE\()(.*)(?=,)")
-TESTFNS=$(grep -hr --include "*.c" -vP "^\s*\/\/.+" | grep -oP "(?<=TEST_CREATE\()(.*)(?=,)" | sort -R --random-source=<(get_seeded_random $1))
+TESTFNS=$(grep -hr --include "*.c" -vP "^\s*\/\/.+" "${SEARCHDIRS[@]}" | grep -oP "(?<=TEST_CREATE\()(.*)(?=,)" | grep -P "$PATTERN" | sort -R --random-source=<(get_seeded_random $1))
 
 for FNNAME in $TESTFNS
 do
-  echo "int test_$FNNAME();" >> "$DIR/test.c"
+  echo "int test_$FNNAME();" >> "$OUTPUT"
 done
 
-echo "void test_main(){" >> "$DIR/test.c"
+echo "
+static const struct TestCase tests[] = {" >> "$OUTPUT"
 
 len=0
 for FNNAME in $TESTFNS
 do
-  echo "    if (!test_$FNNAME()) {return;}" >> "$DIR/test.c"
+  echo "    {\"$FNNAME\", test_$FNNAME}," >> "$OUTPUT"
   ((len++))
 done
 
+# test_run prints a line per test and the summary
+echo "};
 
-# shellcheck disable=SC2028
-echo "
-  kprintf(\"TESTS COMPLETE. Passed %i tests\n\", $len);
-  SemihostingCall(ApplicationExit);
+void test_main(){
+    if (!test_run(tests, $len)) {return;}
+    SemihostingCall(ApplicationExit);
 }
 #endif
-" >> "$DIR/test.c"
+" >> "$OUTPUT"
@@ -0,0 +1,72 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <barrier.h>
+#include <semihosting.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/// Helpers for micro benchmarks. Benchmarks are regular tests (named bench_*) which time a loop
+/// with the physical counter of the ARM generic timer and print the result with [bench_report].
+/// Note that under qemu the numbers are only useful to compare implementations with each other.
+
+#ifdef __arm__
+/// Reads CNTPCT
+static inline uint64_t bench_counter() {
+    uint32_t low, high;
+    isb();
+    asm volatile("mrrc p15, 0, %0, %1, c14" : "=r"(low), "=r"(high));
+    return ((uint64_t)high << 32u) | low;
+}
+
+/// Reads CNTFRQ, the frequency of the counter in Hz
+static inline uint32_t bench_counter_frequency() {
+    uint32_t freq;
+    asm volatile("mrc p15, 0, %0, c14, c0, 0" : "=r"(freq));
+    return freq;
+}
+#else
+// The host build (see host/README.md) counts nanoseconds of a monotonic clock
+uint64_t bench_counter();
+uint32_t bench_counter_frequency();
+#endif
+
+/// Results are also appended to this file on the host, as `<name>,<ticks/op>,<ns/op>,<iterations>`
+/// lines, when the kernel is built with SEMIHOSTING_CONSOLE.
+#define BENCH_RESULTS_FILE "build/bench_results.csv"
+
+/// Prints the time per iteration of a benchmark as
+/// `[BENCH] <name>: <ticks per op> ticks/op, <ns per op> ns/op (<iterations> iterations)`
+static inline void bench_report(const char * name, uint64_t ticks, uint32_t iterations) {
+    // Benchmarks are short, so the 32 bit part is enough and no 64 bit division is needed.
+    const uint32_t total = (uint32_t)ticks;
+    const uint32_t ticks_per_us = bench_counter_frequency() / 1000000u;
+
+    // hundredths of a tick per iteration
+    const uint32_t centiticks =
+        (total / iterations) * 100u + ((total % iterations) * 100u) / iterations;
+    const uint32_t ns = ticks_per_us == 0 ? 0 : (centiticks * 10u) / ticks_per_us;
+
+    kprintf("[BENCH] %s: %u.%02u ticks/op, %u ns/op (%u iterations)\n",
+            name,
+            centiticks / 100u,
+            centiticks % 100u,
+            ns,
+            iterations);
+
+#ifdef SEMIHOSTING_CONSOLE
+    char line[128];
+    const int length = os_snprintf(line,
+                                   sizeof(line),
+                                   "%s,%u.%02u,%u,%u\n",
+                                   name,
+                                   centiticks / 100u,
+                                   centiticks % 100u,
+                                   ns,
+                                   iterations);
+    semihosting_append(
+        BENCH_RESULTS_FILE, line, length < (int)sizeof(line) ? length : (int)sizeof(line) - 1);
+#endif
+}
+
+#endif
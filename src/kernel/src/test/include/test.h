@@ -7,6 +7,7 @@
 
 #include <allocator.h>
 #include <mem_alloc.h>
+#include <stdbool.h>
 #include <stdio.h>
 
 // Only compile test definitions if enabled
@@ -155,4 +156,19 @@ __attribute__((__common__)) size_t global_counter;
 
 void test_main();
 
+/// A test, as listed by generate_tests.sh
+struct TestCase {
+    const char * name;
+    int (*run)();
+};
+
+/// Runs tests in order until one fails. The `tests=` boot parameter selects which ones, for example
+/// `tests=path_,hm` runs the tests whose name contains `path_` or `hm` (`make test TESTS=path_,hm`).
+/// After every test it prints `[RESULT] name=<name> result=<PASSED|FAILED> ticks=<counter ticks>
+/// us=<microseconds> heap_peak=<bytes>` on one line, where heap_peak is the most heap memory the
+/// test had allocated at once (0 without MEM_DEBUG).
+/// At the end it prints `[SUMMARY] passed=<n> failed=<n> skipped=<n> us=<microseconds>`.
+/// Returns whether every selected test passed.
+bool test_run(const struct TestCase * tests, size_t count);
+
 #endif
@@ -0,0 +1,86 @@
+#include <bench.h>
+#include <bootargs.h>
+#include <stdio.h>
+#include <string.h>
+#include <test.h>
+
+#ifdef ENABLE_TESTS
+
+// Whether pattern (length bytes, not null terminated) occurs in name
+static bool name_contains(const char * name, const char * pattern, size_t length) {
+    for (; *name != '\0'; name++) {
+        if (strnlen(name, length) == length && memcmp(name, pattern, length) == 0) { return true; }
+    }
+    return false;
+}
+
+// Whether a test is selected by the value of the tests= parameter, a comma separated list of parts
+// of names. Without the parameter every test is.
+static bool test_selected(const char * name, const char * filter, size_t filter_length) {
+    if (filter == NULL) { return true; }
+
+    const char * end = filter + filter_length;
+    while (filter < end) {
+        const char * comma = memchr(filter, ',', end - filter);
+        const char * entry_end = comma == NULL ? end : comma;
+        if (entry_end != filter && name_contains(name, filter, entry_end - filter)) { return true; }
+        filter = entry_end + 1;
+    }
+    return false;
+}
+
+static uint64_t ticks_to_us(uint64_t ticks) {
+    const uint32_t ticks_per_us = bench_counter_frequency() / 1000000u;
+    return ticks_per_us == 0 ? 0 : ticks / ticks_per_us;
+}
+
+bool test_run(const struct TestCase * tests, size_t count) {
+    size_t filter_length = 0;
+    const char * filter = bootargs_get("tests", &filter_length);
+
+    uint32_t passed = 0;
+    uint32_t skipped = 0;
+    uint64_t total_ticks = 0;
+    bool ok = true;
+
+    for (size_t i = 0; i < count && ok; i++) {
+        if (!test_selected(tests[i].name, filter, filter_length)) {
+            skipped++;
+            continue;
+        }
+
+        uint32_t heap_peak = 0;
+    #ifdef MEM_DEBUG
+        heap_t * heap = mem_get_allocator();
+        const size_t heap_before = heap->bytes_allocated;
+        heap->bytes_allocated_peak = heap_before;
+    #endif
+
+        const uint64_t start = bench_counter();
+        ok = tests[i].run();
+        const uint64_t ticks = bench_counter() - start;
+        total_ticks += ticks;
+
+    #ifdef MEM_DEBUG
+        heap_peak = heap->bytes_allocated_peak - heap_before;
+    #endif
+
+        if (ok) { passed++; }
+        kprintf("[RESULT] name=%s result=%s ticks=%llu us=%llu heap_peak=%u\n",
+                tests[i].name,
+                ok ? "PASSED" : "FAILED",
+                ticks,
+                ticks_to_us(ticks),
+                heap_peak);
+    }
+
+    kprintf("[SUMMARY] passed=%u failed=%u skipped=%u us=%llu\n",
+            passed,
+            ok ? 0 : 1,
+            skipped,
+            ticks_to_us(total_ticks));
+    if (ok) { kprintf("TESTS COMPLETE. Passed %i tests\n", passed); }
+    return ok;
+}
+
+#endif
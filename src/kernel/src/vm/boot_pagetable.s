@@ -0,0 +1,74 @@
+// The static part of the kernel L1 pagetable, generated by the assembler at build time.
+//
+// The linker script places the .boot_pagetable section in the physically addressed boot region,
+// aligned to 16 KiB. startup.s only has to load its address into TTBR0/TTBR1 and enable the MMU.
+// vm2_start later removes the identity map and trims the linear map to the size of the board's
+// memory; everything else here stays as is.
+//
+// Layout of the L1 table (one entry per MiB):
+//     0x00000000              identity map of the first MiB (startup.s runs from here)
+//     0x80000000-0xBFFFFFFF   linear map of physical 0x00000000-0x3FFFFFFF
+//     0xFFF00000              coarse pagetable holding the high vector page (0xFFFF0000)
+
+// Section entry: type 2, kernel read/write with the access flag set
+.equ SECTION_KERNEL_RW, 0x402
+// Coarse pagetable entry: type 1, domain 0
+.equ COARSE_PAGETABLE, 0x1
+// Small page entry: type 2 (executable), kernel read/write with the access flag set
+.equ SMALLPAGE_KERNEL_RWX, 0x12
+
+.equ L1_ENTRIES, 4096
+.equ L2_ENTRIES, 256
+
+.equ LINEAR_MAP_VIRTUAL, 0x80000000
+.equ LINEAR_MAP_SIZE_MIB, 1024
+.equ VECTOR_VIRTUAL, 0xFFFF0000
+
+// Emits `count` section entries mapping consecutive MiBs, starting at physical address `base`.
+.macro SECTIONS base, count
+    .set section_address, \base
+    .rept \count
+    .long section_address + SECTION_KERNEL_RW
+    .set section_address, section_address + 0x100000
+    .endr
+.endm
+
+.section .boot_pagetable, "aw"
+
+.align 14
+.global __BOOT_L1_PAGETABLE
+__BOOT_L1_PAGETABLE:
+    // Identity map
+    SECTIONS 0, 1
+    .fill (LINEAR_MAP_VIRTUAL >> 20) - 1, 4, 0
+
+    // Linear map
+    SECTIONS 0, LINEAR_MAP_SIZE_MIB
+    .fill (VECTOR_VIRTUAL >> 20) - (LINEAR_MAP_VIRTUAL >> 20) - LINEAR_MAP_SIZE_MIB, 4, 0
+
+    // Vector page
+    .long __BOOT_VECTOR_L2_PAGETABLE + COARSE_PAGETABLE
+__BOOT_L1_PAGETABLE_END:
+
+// The page the vector table is copied into by init_vector_table.
+.align 12
+.global __BOOT_VECTOR_PAGE
+__BOOT_VECTOR_PAGE:
+    .fill 4096, 1, 0
+
+// L2 pagetable covering 0xFFF00000-0xFFFFFFFF
+.align 10
+.global __BOOT_VECTOR_L2_PAGETABLE
+__BOOT_VECTOR_L2_PAGETABLE:
+    .fill (VECTOR_VIRTUAL >> 12) & 0xff, 4, 0
+    .long __BOOT_VECTOR_PAGE + SMALLPAGE_KERNEL_RWX
+    .fill L2_ENTRIES - ((VECTOR_VIRTUAL >> 12) & 0xff) - 1, 4, 0
+__BOOT_VECTOR_L2_PAGETABLE_END:
+
+// Catch layout mistakes at build time
+.if (__BOOT_L1_PAGETABLE_END - __BOOT_L1_PAGETABLE) != L1_ENTRIES * 4
+.error "The boot L1 pagetable must be exactly 16 KiB"
+.endif
+.if (__BOOT_VECTOR_L2_PAGETABLE_END - __BOOT_VECTOR_L2_PAGETABLE) != L2_ENTRIES * 4
+.error "The boot L2 pagetable must be exactly 1 KiB"
+.endif
@@ -1,17 +1,37 @@
 #ifndef MMIO_H
 #define MMIO_H
 
+#include <barrier.h>
+#include <stdint.h>
 
-#define mmio_read(address) (*((volatile uint32_t *)(address)))
+/// Access to memory mapped device registers.
+///
+/// The relaxed accessors are a single volatile 32 bit load or store, which the compiler neither
+/// removes, merges nor reorders with other volatile accesses. The hardware keeps accesses to the
+/// same peripheral in order, so a sequence of relaxed accesses to one device is fine.
+///
+/// mmio_read and mmio_write are also ordered with respect to normal memory and to other
+/// peripherals (the BCM2835 manual asks for a barrier when switching between peripherals):
+/// mmio_write waits for earlier memory accesses, for instance to a buffer the device is about to
+/// read, and memory accesses after mmio_read wait for the read.
+
+#define mmio_read_relaxed(address) (*(volatile uint32_t *)(address))
+#define mmio_write_relaxed(address, value) \
+    (*(volatile uint32_t *)(address) = (uint32_t)(value))
+
+#define mmio_read(address)         mmio_read_ordered((volatile uint32_t *)(address))
 #define mmio_write(address, value) \
-    mmio_write_internal((volatile uint32_t *)(address), (volatile uint32_t)(value))
+    mmio_write_ordered((volatile uint32_t *)(address), (uint32_t)(value))
+
+static inline uint32_t mmio_read_ordered(volatile uint32_t * address) {
+    const uint32_t value = *address;
+    dmb();
+    return value;
+}
 
-// Do the mmio write in assembly to remove any chance of gcc optimizing the call away. *yes* even if
-// it was marked volatile already. Hence the 4 hours it took us to make timer.c work......
-static inline void mmio_write_internal(volatile uint32_t * address, volatile uint32_t value) {
-    asm volatile("ldr r1, %1\n"
-                 "str r1, %0\n" ::"m"(*address),
-                 "m"(value));
+static inline void mmio_write_ordered(volatile uint32_t * address, uint32_t value) {
+    dmb();
+    *address = value;
 }
 
 #endif
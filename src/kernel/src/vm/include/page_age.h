@@ -0,0 +1,72 @@
+#ifndef PAGE_AGE_H
+#define PAGE_AGE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <vm2.h>
+
+/// Page aging based on the hardware access flag.
+///
+/// Every user page is kept on one of two LRU lists of its address space: active or inactive.
+/// A periodic scan clears the access flag of every page and then checks it again on the next scan.
+/// A page that was accessed in between is moved to the head of the active list, a page that
+/// wasn't is moved to the inactive list. The tail of the inactive list therefore holds the coldest
+/// pages, which are the ones any future reclaim or swap policy should pick first.
+///
+/// The number of active pages is the working set of the address space: the pages that were used
+/// in the last scan interval.
+
+#define PAGE_AGE_SCAN_INTERVAL_MS 1000
+
+struct vas2;
+
+/// A single page on one of the LRU lists.
+struct AgedPage {
+    size_t virtual;
+    union L2PagetableEntry * pte;
+    bool active;
+
+    struct AgedPage * next;
+    struct AgedPage * prev;
+};
+
+/// The active and inactive lists of a single address space. The heads of the lists are the most
+/// recently used pages.
+struct PageLRU {
+    struct AgedPage * active_head;
+    struct AgedPage * active_tail;
+    struct AgedPage * inactive_head;
+    struct AgedPage * inactive_tail;
+    size_t nr_active;
+    size_t nr_inactive;
+
+    /// Links in the list of all address spaces the scanner visits.
+    struct vas2 * next_vas;
+    struct vas2 * prev_vas;
+};
+
+/// Starts the periodic scanner. Address spaces can be registered before or after this is called.
+void page_aging_init();
+
+/// Adds an address space to the set of address spaces that are scanned.
+void page_age_register(struct vas2 * vas);
+
+/// Removes an address space from the scanner and frees all of its page tracking information.
+void page_age_unregister(struct vas2 * vas);
+
+/// Starts tracking a page which was just mapped in a registered address space.
+/// New pages start at the head of the active list.
+void page_age_track(struct vas2 * vas, size_t virtual);
+
+/// Samples and clears the access flags of all pages in an address space and updates its lists.
+/// Called periodically by the scanner but can be called directly, interrupts are disabled while the
+/// lists are rebuilt.
+void page_age_scan(struct vas2 * vas);
+
+/// The estimated working set of an address space in bytes.
+size_t page_age_working_set_size(struct vas2 * vas);
+
+/// The least recently used page of an address space (or NULL if it has no pages).
+struct AgedPage * page_age_coldest(struct vas2 * vas);
+
+#endif
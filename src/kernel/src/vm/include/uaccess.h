@@ -0,0 +1,70 @@
+#ifndef UACCESS_H
+#define UACCESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <vm2.h>
+
+/// Safe access to user memory from the kernel.
+///
+/// The copy routines are written in assembly ([uaccess.s](../uaccess.s)) and every instruction in
+/// them that touches a user address is listed in the exception table (the `__ex_table` section).
+/// When such an instruction faults, [data_abort_handler] looks the faulting pc up with
+/// [search_exception_table] and resumes at a fixup instead of crashing the kernel. This means no
+/// pagetable walk is needed up front: the fast path is just a copy.
+
+/// Everything below this address belongs to user space.
+#define USER_SPACE_END KERNEL_VIRTUAL_OFFSET
+
+/// An entry in the exception table. `insn` is the address of an instruction that may fault on a
+/// user address, `fixup` is where execution continues when it does.
+struct ExceptionTableEntry {
+    size_t insn;
+    size_t fixup;
+};
+
+/// Returns the fixup address for a faulting instruction, or 0 if the instruction is not allowed to
+/// fault.
+size_t search_exception_table(size_t address);
+
+/// Checks that the range [addr, addr + size) lies completely in user space. This does *not* check
+/// that the memory is mapped, the copy routines take care of that.
+static inline bool access_ok(const void * addr, size_t size) {
+    size_t start = (size_t)addr;
+    return start + size >= start && start + size <= USER_SPACE_END;
+}
+
+// Unchecked versions, implemented in uaccess.s. Use the functions below instead.
+size_t __copy_from_user(void * to, const void * from, size_t n);
+size_t __copy_to_user(void * to, const void * from, size_t n);
+long __strncpy_from_user(char * dst, const char * src, size_t count);
+
+/// Copies n bytes from user space to the kernel. Returns the number of bytes that could *not* be
+/// copied, so 0 means success.
+static inline size_t copy_from_user(void * to, const void * from, size_t n) {
+    if (!access_ok(from, n)) { return n; }
+    return __copy_from_user(to, from, n);
+}
+
+/// Copies n bytes from the kernel to user space. Returns the number of bytes that could *not* be
+/// copied, so 0 means success.
+static inline size_t copy_to_user(void * to, const void * from, size_t n) {
+    if (!access_ok(to, n)) { return n; }
+    return __copy_to_user(to, from, n);
+}
+
+/// Copies a null terminated string of at most count bytes from user space into dst (including the
+/// terminator if it fits). Returns the length of the string, count if no terminator was found
+/// within count bytes, or -1 if the string is not (completely) readable.
+static inline long strncpy_from_user(char * dst, const char * src, size_t count) {
+    if (!access_ok(src, 1)) { return -1; }
+
+    // Never read past the end of user space, even if count would allow it.
+    size_t available = USER_SPACE_END - (size_t)src;
+    long res = __strncpy_from_user(dst, src, count < available ? count : available);
+
+    if (res >= 0 && (size_t)res == available && available < count) { return -1; }
+    return res;
+}
+
+#endif
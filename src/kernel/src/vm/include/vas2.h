@@ -2,6 +2,7 @@
 #define VAS_2_H
 
 #include <asid_allocator.h>
+#include <page_age.h>
 #include <vm2.h>
 #include <vp_array_list.h>
 
@@ -12,6 +13,8 @@ struct vas2 {
     struct L1PageTable * l1PageTable;
     VPArrayList * l2tables;
     VPArrayList * pages;
+    /// Access history of the pages, see [page_age.h]
+    struct PageLRU lru;
 };
 
 
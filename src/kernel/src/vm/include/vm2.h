@@ -1,6 +1,7 @@
 #ifndef VM_H
 #define VM_H
 
+#include <barrier.h>
 #include <constants.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -13,7 +14,7 @@ enum Access {
 
     // Everything below this is accessible for the kernel and the user.
 
-    UserRO,  // kernel rw, user ro
+    UserRO,  // kernel ro, user ro (the access flag model has no kernel rw, user ro)
     UserRW,  // kernel rw, user rw
 };
 
@@ -278,6 +279,29 @@ typedef union L2PagetableEntry {
     } __attribute__((packed)) smallpage;
 } L2PagetableEntry;
 
+/// The MMU runs with the access flag enabled (SCTLR.AFE). This turns bit 0 of the access
+/// permissions of every entry into the access flag. Touching a page whose access flag is clear
+/// causes an access flag fault, which the abort handlers resolve by setting the flag again (see
+/// [vm2_handle_access_flag_fault]). Clearing the flag and checking it later tells whether a page
+/// was used in the meantime, which is what [page_age.h] is built on.
+/// The remaining permission bits (accessExtended and bit 1 of accessPermissions) mean:
+///     APX AP[1]   Kernel:     User:
+///     0   0       Read/Write  No access
+///     0   1       Read/Write  Read/Write
+///     1   0       Read only   No access
+///     1   1       Read only   Read only
+#define L1_SECTION_ACCESS_FLAG (1u << 10u)
+#define L2_ACCESS_FLAG         (1u << 4u)
+
+/// Fault status codes (DFSR/IFSR) of access flag faults
+#define FSR_ACCESS_FLAG_SECTION 0x3
+#define FSR_ACCESS_FLAG_PAGE    0x6
+/// Extracts the fault status from a DFSR/IFSR value (FS[4] lives in bit 10)
+#define FSR_STATUS(fsr) (((fsr)&0xfu) | (((fsr) >> 6u) & 0x10u))
+
+/// A 4KiB page of physical memory, see pmm.h
+struct Page;
+
 /// The representation of an L1Pagetable
 struct L1PageTable {
     L1PagetableEntry entries[0x800];
@@ -319,6 +343,16 @@ void * vm2_allocate_page(struct L1PageTable * l1pt,
                          struct PagePermission perms,
                          struct L2PageTable ** created_l2pt);
 
+/// Same as [vm2_allocate_page], but maps a page that already exists (given by its kernel virtual
+/// address), for example one that is shared between processes. Returns false if the address can't
+/// be mapped with a small page.
+bool vm2_map_page(struct L1PageTable * l1pt,
+                  size_t virtual,
+                  struct Page * page,
+                  bool remap,
+                  struct PagePermission perms,
+                  struct L2PageTable ** created_l2pt);
+
 /// Frees a 4KiB page at a virtual address. The address does not need to be aligned. If the address
 /// is not aligned, the aligned 4KiB page the address lies in is freed.
 /// TODO: Does not yet free l2 pagetables when they become empty after enough pages are freed. For
@@ -328,9 +362,20 @@ void * vm2_allocate_page(struct L1PageTable * l1pt,
 /// Automatically unmaps the page from the l1pt it was in.
 void vm2_free_page(struct L1PageTable * l1pt, size_t virtual);
 
+/// Returns the L2 entry which maps a virtual address, or NULL if the address is not mapped through
+/// an L2 pagetable.
+union L2PagetableEntry * vm2_get_l2_entry(struct L1PageTable * l1pt, size_t virtual);
+
+/// Sets the access flag of the page or section a faulting address lies in. Called from the abort
+/// handlers on an access flag fault. Returns false if the address isn't mapped at all.
+bool vm2_handle_access_flag_fault(size_t virtual);
+
 /// Should be called after updating a pagetable.
 void vm2_flush_caches();
 
+/// Invalidates the TLB entry of a single page. The ASID is ignored for global (kernel) pages.
+void vm2_flush_tlb_entry(size_t virtual, uint8_t asid);
+
 /// Flushes the caches associated with an ASID.
 void vm2_flush_caches_of_ASID(uint8_t id);
 
@@ -345,6 +390,10 @@ extern struct L1PageTable * kernell1PageTable;
 extern const size_t __KERNEL_BASE[];
 extern const size_t __KERNEL_TOP[];
 extern const size_t __KERNEL_VIRTUAL_OFFSET[];
+/// The build time generated kernel L1 pagetable (from boot_pagetable.s). The boot symbol is its
+/// physical address, the kernel symbol its virtual address.
+extern const size_t __BOOT_L1_PAGETABLE[];
+extern const size_t __KERNEL_L1_PAGETABLE[];
 
 /// Above 2Gigs is the virtual kernel area, this also includes all Virtual Memory constructs, and
 /// the kernel stack.
@@ -368,17 +417,22 @@ extern const size_t __KERNEL_VIRTUAL_OFFSET[];
 /// From this address down, mmio devices are mapped in the kernel's virtual address space.
 #define KERNEL_MMIO_BASE ((4 * Gibibyte) - (1 * Mebibyte))
 
-/// Address space for the kernel heap, grows towards the mmio
-#define KERNEL_HEAP_BASE (3 * Gibibyte)
+/// Size of the linear map of physical memory at KERNEL_VIRTUAL_OFFSET (see boot_pagetable.s)
+#define KERNEL_LINEAR_MAP_SIZE (1 * Gibibyte)
+
+/// Address space for the kernel heap, grows towards the mmio. The host build moves it, see
+/// host/README.md.
+#ifndef KERNEL_HEAP_BASE
+    #define KERNEL_HEAP_BASE (3 * Gibibyte)
+#endif
 
 #define KERNEL_PHYSICAL_START (KERNEL_VIRTUAL_START - KERNEL_VIRTUAL_OFFSET)
 #define KERNEL_PHYSICAL_END   (KERNEL_VIRTUAL_END - KERNEL_VIRTUAL_OFFSET)
 
-/// The L1 pagetable starts at 0x4000 and is itself 0x4000 bytes long. (0x1000 entries of 4 bytes).
-/// The kernel starts at 0x8000 which is exactly at the end of the pagetable. (What a coincidence
-/// *gasp*)
-#define PhysicalL1PagetableLocation 0x4000
-#define VirtualL1PagetableLocation  (KERNEL_VIRTUAL_OFFSET + PhysicalL1PagetableLocation)
+/// The kernel L1 pagetable is generated at build time (see boot_pagetable.s) and linked into the
+/// boot region, right after the boot code. It is 0x4000 bytes long (0x1000 entries of 4 bytes).
+#define PhysicalL1PagetableLocation ((size_t)__BOOT_L1_PAGETABLE)
+#define VirtualL1PagetableLocation  ((size_t)__KERNEL_L1_PAGETABLE)
 
 #define PAGE_SIZE (4 * Kibibyte)
 
@@ -394,6 +448,6 @@ extern const size_t __KERNEL_VIRTUAL_OFFSET[];
 /// all outstanding explicit memory transactions complete before any following instructions begin.
 /// This ensures that data in memory is up to date before the processor executes any more
 /// instructions.
-#define DATA_SYNC_BARRIER() asm volatile("eor r0, r0, r0\nmcr p15, 0, r0, c7, c10, 4");
+#define DATA_SYNC_BARRIER() dsb();
 
 #endif
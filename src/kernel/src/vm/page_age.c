@@ -0,0 +1,146 @@
+#include <chipset.h>
+#include <interrupt.h>
+#include <page_age.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vas2.h>
+
+// All registered address spaces, linked through their PageLRU.
+static struct vas2 * registered_vases = NULL;
+
+// Linked list helpers. Heads are the most recently used end of a list.
+static void push_head(struct AgedPage ** head, struct AgedPage ** tail, struct AgedPage * page) {
+    page->prev = NULL;
+    page->next = *head;
+    if (*head != NULL) {
+        (*head)->prev = page;
+    } else {
+        *tail = page;
+    }
+    *head = page;
+}
+
+static void free_list(struct AgedPage * page) {
+    while (page != NULL) {
+        struct AgedPage * next = page->next;
+        kfree(page);
+        page = next;
+    }
+}
+
+// Reads and clears the access flag of a page. The TLB entry is flushed so the next access walks
+// the pagetable again and faults.
+static bool test_and_clear_young(struct vas2 * vas, struct AgedPage * page) {
+    if (!(page->pte->entry & L2_ACCESS_FLAG)) { return false; }
+
+    page->pte->entry &= ~L2_ACCESS_FLAG;
+    vm2_flush_tlb_entry(page->virtual, vas->tlbDescriptor.asid);
+    return true;
+}
+
+static void page_age_scan_all() {
+    for (struct vas2 * vas = registered_vases; vas != NULL; vas = vas->lru.next_vas) {
+        page_age_scan(vas);
+    }
+}
+
+void page_aging_init() {
+    // The exact interval doesn't matter, so let the scan share an interrupt with other timers
+    chipset.schedule_timer_with_slack(
+        page_age_scan_all, PAGE_AGE_SCAN_INTERVAL_MS, PAGE_AGE_SCAN_INTERVAL_MS / 10, true);
+}
+
+void page_age_register(struct vas2 * vas) {
+    vas->lru = (struct PageLRU){0};
+
+    // The scanner runs from the timer interrupt, keep it away while the list changes.
+    int cpsr = disable_interrupt_save(IRQ);
+
+    vas->lru.next_vas = registered_vases;
+    if (registered_vases != NULL) { registered_vases->lru.prev_vas = vas; }
+    registered_vases = vas;
+
+    restore_proc_status(cpsr);
+}
+
+void page_age_unregister(struct vas2 * vas) {
+    int cpsr = disable_interrupt_save(IRQ);
+
+    if (vas->lru.next_vas != NULL) { vas->lru.next_vas->lru.prev_vas = vas->lru.prev_vas; }
+    if (vas->lru.prev_vas != NULL) {
+        vas->lru.prev_vas->lru.next_vas = vas->lru.next_vas;
+    } else {
+        registered_vases = vas->lru.next_vas;
+    }
+
+    restore_proc_status(cpsr);
+
+    free_list(vas->lru.active_head);
+    free_list(vas->lru.inactive_head);
+    vas->lru = (struct PageLRU){0};
+}
+
+void page_age_track(struct vas2 * vas, size_t virtual) {
+    struct AgedPage * page = kmalloc(sizeof(struct AgedPage));
+
+    *page = (struct AgedPage){
+        .virtual = virtual,
+        .pte = vm2_get_l2_entry(vas->l1PageTable, virtual),
+        .active = true,
+    };
+
+    int cpsr = disable_interrupt_save(IRQ);
+    push_head(&vas->lru.active_head, &vas->lru.active_tail, page);
+    vas->lru.nr_active++;
+    restore_proc_status(cpsr);
+}
+
+void page_age_scan(struct vas2 * vas) {
+    struct PageLRU * lru = &vas->lru;
+
+    // The lists are taken apart and rebuilt. When this is called directly, the scanner runs from
+    // the timer interrupt and must not see them halfway.
+    int cpsr = disable_interrupt_save(IRQ);
+
+    struct AgedPage * old_active = lru->active_head;
+    struct AgedPage * old_inactive = lru->inactive_head;
+
+    *lru = (struct PageLRU){
+        .next_vas = lru->next_vas,
+        .prev_vas = lru->prev_vas,
+    };
+
+    // Rebuild both lists. The old inactive pages go first, so pages that were demoted in this
+    // scan end up closer to the head of the inactive list than pages that were already cold.
+    struct AgedPage * lists[] = {old_inactive, old_active};
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++) {
+        struct AgedPage * page = lists[i];
+
+        while (page != NULL) {
+            struct AgedPage * next = page->next;
+
+            if (test_and_clear_young(vas, page)) {
+                page->active = true;
+                push_head(&lru->active_head, &lru->active_tail, page);
+                lru->nr_active++;
+            } else {
+                page->active = false;
+                push_head(&lru->inactive_head, &lru->inactive_tail, page);
+                lru->nr_inactive++;
+            }
+
+            page = next;
+        }
+    }
+
+    restore_proc_status(cpsr);
+}
+
+size_t page_age_working_set_size(struct vas2 * vas) {
+    return vas->lru.nr_active * PAGE_SIZE;
+}
+
+struct AgedPage * page_age_coldest(struct vas2 * vas) {
+    if (vas->lru.inactive_tail != NULL) { return vas->lru.inactive_tail; }
+    return vas->lru.active_tail;
+}
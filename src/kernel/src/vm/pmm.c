@@ -1,6 +1,7 @@
 #include <constants.h>
 #include <hardwareinfo.h>
 #include <pmm.h>
+#include <simd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -241,7 +242,7 @@ struct Page * pmm_allocate_page() {
             push_to_ll(&physicalMemoryManager.allocated, sliceinfo);
         }
 
-        memset(newpage, 0, sizeof(struct Page));
+        page_clear(newpage);
         return newpage;
     } else {
         struct MemorySliceInfo * sliceinfo = pop_from_ll(&physicalMemoryManager.unused);
@@ -254,7 +255,7 @@ struct Page * pmm_allocate_page() {
         push_to_ll(&physicalMemoryManager.pagePartialFree, sliceinfo);
 
         struct Page * newpage = &sliceinfo->slice->page[0];
-        memset(newpage, 0, sizeof(struct Page));
+        page_clear(newpage);
         return newpage;
     }
 }
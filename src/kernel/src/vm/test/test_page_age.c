@@ -0,0 +1,64 @@
+#include <page_age.h>
+#include <test.h>
+#include <uaccess.h>
+#include <vas2.h>
+
+#define AGE_TEST_PAGE  0x10000
+#define AGE_TEST_PAGES 4
+
+static struct vas2 * setup_aged_vas() {
+    struct vas2 * vas = create_vas();
+    for (size_t i = 0; i < AGE_TEST_PAGES; i++) {
+        allocate_page(vas, AGE_TEST_PAGE + i * PAGE_SIZE, false);
+    }
+    switch_to_vas(vas);
+    return vas;
+}
+
+static void teardown_aged_vas(struct vas2 * vas) {
+    vm2_set_user_pagetable(NULL);
+    vm2_flush_caches();
+    free_vas(vas);
+}
+
+TEST_CREATE(test_page_age_new_pages_active, {
+    struct vas2 * vas = setup_aged_vas();
+
+    ASSERT_EQ(page_age_working_set_size(vas), AGE_TEST_PAGES * PAGE_SIZE);
+    ASSERT_EQ(vas->lru.nr_inactive, 0);
+
+    teardown_aged_vas(vas);
+})
+
+TEST_CREATE(test_page_age_idle_pages_age, {
+    struct vas2 * vas = setup_aged_vas();
+
+    // The first scan clears the flags set at allocation, the second sees no accesses.
+    page_age_scan(vas);
+    page_age_scan(vas);
+
+    ASSERT_EQ(page_age_working_set_size(vas), 0);
+    ASSERT_EQ(vas->lru.nr_inactive, AGE_TEST_PAGES);
+
+    teardown_aged_vas(vas);
+})
+
+TEST_CREATE(test_page_age_touched_page_active, {
+    struct vas2 * vas = setup_aged_vas();
+
+    page_age_scan(vas);
+    page_age_scan(vas);
+
+    // Touching the page causes an access flag fault, which sets the flag again.
+    size_t touched = AGE_TEST_PAGE + 2 * PAGE_SIZE;
+    char c = 'x';
+    ASSERT_EQ(copy_to_user((void *)touched, &c, 1), 0);
+
+    page_age_scan(vas);
+
+    ASSERT_EQ(page_age_working_set_size(vas), PAGE_SIZE);
+    ASSERT_EQ(vas->lru.active_head->virtual, touched);
+    ASSERT_NEQ(page_age_coldest(vas)->virtual, touched);
+
+    teardown_aged_vas(vas);
+})
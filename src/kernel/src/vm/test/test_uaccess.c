@@ -0,0 +1,76 @@
+#include <string.h>
+#include <test.h>
+#include <uaccess.h>
+#include <vas2.h>
+
+#define USER_TEST_PAGE     0x10000
+#define USER_UNMAPPED_PAGE 0x200000
+
+static struct vas2 * setup_user_vas() {
+    struct vas2 * vas = create_vas();
+    allocate_page(vas, USER_TEST_PAGE, false);
+    switch_to_vas(vas);
+    return vas;
+}
+
+static void teardown_user_vas(struct vas2 * vas) {
+    vm2_set_user_pagetable(NULL);
+    vm2_flush_caches();
+    free_vas(vas);
+}
+
+TEST_CREATE(test_copy_user_roundtrip, {
+    struct vas2 * vas = setup_user_vas();
+
+    // Odd length and offset, so the aligned, word and byte paths are all used.
+    char out[] = "copy to and from user space works!";
+    char in[sizeof(out)];
+    void * user = (void *)(USER_TEST_PAGE + 3);
+
+    ASSERT_EQ(copy_to_user(user, out, sizeof(out)), 0);
+    ASSERT_EQ(copy_from_user(in, user, sizeof(out)), 0);
+    ASSERT_EQ(strcmp(in, out), 0);
+
+    teardown_user_vas(vas);
+})
+
+TEST_CREATE(test_copy_user_unmapped, {
+    struct vas2 * vas = setup_user_vas();
+
+    char buf[64];
+    ASSERT_EQ(copy_from_user(buf, (void *)USER_UNMAPPED_PAGE, sizeof(buf)), sizeof(buf));
+    ASSERT_EQ(copy_to_user((void *)USER_UNMAPPED_PAGE, buf, sizeof(buf)), sizeof(buf));
+
+    // Running off the end of the mapped page copies what it can.
+    void * end = (void *)(USER_TEST_PAGE + PAGE_SIZE - 8);
+    ASSERT_NEQ(copy_from_user(buf, end, sizeof(buf)), 0);
+
+    teardown_user_vas(vas);
+})
+
+TEST_CREATE(test_copy_user_kernel_pointer, {
+    char buf[16];
+    char kernel_data[16] = "kernel secret";
+
+    ASSERT_EQ(copy_from_user(buf, kernel_data, sizeof(buf)), sizeof(buf));
+    ASSERT_EQ(copy_to_user(kernel_data, buf, sizeof(buf)), sizeof(buf));
+    ASSERT_EQ(strncpy_from_user(buf, kernel_data, sizeof(buf)), -1);
+})
+
+TEST_CREATE(test_strncpy_from_user, {
+    struct vas2 * vas = setup_user_vas();
+
+    char str[] = "hello";
+    char buf[16];
+    ASSERT_EQ(copy_to_user((void *)USER_TEST_PAGE, str, sizeof(str)), 0);
+
+    ASSERT_EQ(strncpy_from_user(buf, (void *)USER_TEST_PAGE, sizeof(buf)), 5);
+    ASSERT_EQ(strcmp(buf, str), 0);
+
+    // Truncated strings return count.
+    ASSERT_EQ(strncpy_from_user(buf, (void *)USER_TEST_PAGE, 3), 3);
+
+    ASSERT_EQ(strncpy_from_user(buf, (void *)USER_UNMAPPED_PAGE, sizeof(buf)), -1);
+
+    teardown_user_vas(vas);
+})
@@ -5,3 +5,15 @@ TEST_CREATE(test_size, {
     ASSERT_EQ(sizeof(L2PagetableEntry), 4);
     ASSERT_EQ(sizeof(L1PagetableEntry), 4);
 })
+
+TEST_CREATE(test_generated_kernel_pagetable, {
+    // The boot identity map is gone, the linear map starts at physical 0.
+    ASSERT_EQ(kernell1PageTable->entries[0].entry, 0);
+    ASSERT_EQ(kernell1PageTable->entries[KERNEL_VIRTUAL_OFFSET >> 20u].section.type, 2);
+    ASSERT_EQ(kernell1PageTable->entries[KERNEL_VIRTUAL_OFFSET >> 20u].section.base_address, 0);
+
+    // The vector page lives in a coarse pagetable.
+    union L2PagetableEntry * vectors = vm2_get_l2_entry(kernell1PageTable, HIGH_VECTOR_LOCATION);
+    ASSERT_NOT_NULL(vectors);
+    ASSERT_EQ(vectors->smallpage.type, 2);
+})
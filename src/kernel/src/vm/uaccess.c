@@ -0,0 +1,26 @@
+#include <uaccess.h>
+
+/// From the `kernel.ld` linker file. Bounds of the `__ex_table` section.
+extern const struct ExceptionTableEntry __EX_TABLE_START[];
+extern const struct ExceptionTableEntry __EX_TABLE_END[];
+
+// All entries come from uaccess.s and are emitted in the same order as the instructions, so the
+// table is sorted by instruction address and can be binary searched.
+size_t search_exception_table(size_t address) {
+    const struct ExceptionTableEntry * low = __EX_TABLE_START;
+    const struct ExceptionTableEntry * high = __EX_TABLE_END;
+
+    while (low < high) {
+        const struct ExceptionTableEntry * mid = low + (high - low) / 2;
+
+        if (mid->insn == address) {
+            return mid->fixup;
+        } else if (mid->insn < address) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return 0;
+}
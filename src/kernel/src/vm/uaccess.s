@@ -0,0 +1,145 @@
+// Copy routines for user memory. See uaccess.h for the C interface.
+//
+// Every instruction in here that touches a user address is wrapped in the USER macro. This records
+// the instruction together with a fixup label in the __ex_table section. When the instruction
+// faults, data_abort_handler resumes execution at the fixup, which returns an error instead of
+// crashing the kernel.
+//
+// The user side uses the unprivileged (T) loads and stores, so the MMU checks the permissions of
+// the page as if user mode made the access.
+
+// Registers an instruction that may fault on a user address.
+.macro USER fixup, insn:vararg
+9999:
+    \insn
+    .pushsection __ex_table, "a"
+    .align 2
+    .long 9999b, \fixup
+    .popsection
+.endm
+
+.text
+
+// size_t __copy_from_user(void * to, const void * from, size_t n)
+// Returns the number of bytes that were not copied.
+.global __copy_from_user
+__copy_from_user:
+    push {r4-r6, lr}
+
+    // Words can only be used when both pointers can be aligned at the same time
+    eor r3, r0, r1
+    tst r3, #3
+    bne copy_from_user_bytes
+
+copy_from_user_align:
+    tst r1, #3
+    beq copy_from_user_words
+    cmp r2, #0
+    beq copy_from_user_done
+    USER copy_from_user_fault, ldrbt r3, [r1], #1
+    strb r3, [r0], #1
+    sub r2, r2, #1
+    b copy_from_user_align
+
+copy_from_user_words:
+    // Copy 16 bytes per iteration. n is only decreased after the whole block was copied, so on a
+    // fault the result can be a few bytes too pessimistic, but never too optimistic.
+    cmp r2, #16
+    blo copy_from_user_bytes
+    USER copy_from_user_fault, ldrt r3, [r1], #4
+    USER copy_from_user_fault, ldrt r4, [r1], #4
+    USER copy_from_user_fault, ldrt r5, [r1], #4
+    USER copy_from_user_fault, ldrt r6, [r1], #4
+    stmia r0!, {r3-r6}
+    sub r2, r2, #16
+    b copy_from_user_words
+
+copy_from_user_bytes:
+    cmp r2, #0
+    beq copy_from_user_done
+    USER copy_from_user_fault, ldrbt r3, [r1], #1
+    strb r3, [r0], #1
+    sub r2, r2, #1
+    b copy_from_user_bytes
+
+copy_from_user_done:
+    mov r0, #0
+    pop {r4-r6, pc}
+
+copy_from_user_fault:
+    mov r0, r2
+    pop {r4-r6, pc}
+
+
+// size_t __copy_to_user(void * to, const void * from, size_t n)
+// Returns the number of bytes that were not copied.
+.global __copy_to_user
+__copy_to_user:
+    push {r4-r6, lr}
+
+    eor r3, r0, r1
+    tst r3, #3
+    bne copy_to_user_bytes
+
+copy_to_user_align:
+    tst r0, #3
+    beq copy_to_user_words
+    cmp r2, #0
+    beq copy_to_user_done
+    ldrb r3, [r1], #1
+    USER copy_to_user_fault, strbt r3, [r0], #1
+    sub r2, r2, #1
+    b copy_to_user_align
+
+copy_to_user_words:
+    cmp r2, #16
+    blo copy_to_user_bytes
+    ldmia r1!, {r3-r6}
+    USER copy_to_user_fault, strt r3, [r0], #4
+    USER copy_to_user_fault, strt r4, [r0], #4
+    USER copy_to_user_fault, strt r5, [r0], #4
+    USER copy_to_user_fault, strt r6, [r0], #4
+    sub r2, r2, #16
+    b copy_to_user_words
+
+copy_to_user_bytes:
+    cmp r2, #0
+    beq copy_to_user_done
+    ldrb r3, [r1], #1
+    USER copy_to_user_fault, strbt r3, [r0], #1
+    sub r2, r2, #1
+    b copy_to_user_bytes
+
+copy_to_user_done:
+    mov r0, #0
+    pop {r4-r6, pc}
+
+copy_to_user_fault:
+    mov r0, r2
+    pop {r4-r6, pc}
+
+
+// long __strncpy_from_user(char * dst, const char * src, size_t count)
+// Returns the length of the copied string, count if no terminator was found, or -1 on a fault.
+.global __strncpy_from_user
+__strncpy_from_user:
+    push {r4, lr}
+    mov r4, #0
+
+strncpy_from_user_loop:
+    cmp r4, r2
+    beq strncpy_from_user_done
+    USER strncpy_from_user_fault, ldrbt r3, [r1], #1
+    strb r3, [r0], #1
+    cmp r3, #0
+    beq strncpy_from_user_done
+    add r4, r4, #1
+    b strncpy_from_user_loop
+
+strncpy_from_user_done:
+    mov r0, r4
+    pop {r4, pc}
+
+strncpy_from_user_fault:
+    mvn r0, #0
+    pop {r4, pc}
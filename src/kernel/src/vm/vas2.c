@@ -1,3 +1,4 @@
+#include <ktime.h>
 #include <pmm.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,6 +18,22 @@ struct vas2 * create_vas() {
         .pages = vpa_create(VAS2_INITIAL_PAGE_LIST_CAPACITY),
     };
 
+    page_age_register(newvas);
+
+    // Every process can read the time without a syscall. The page is shared, so it is not in
+    // `pages` and is never freed.
+    if (ktime_page != NULL) {
+        struct L2PageTable * l2pt = NULL;
+        const struct PagePermission perms = {.access = UserRO, .executable = false};
+        vm2_map_page(newvas->l1PageTable,
+                     KTIME_PAGE_USER_ADDRESS,
+                     (struct Page *)ktime_page,
+                     false,
+                     perms,
+                     &l2pt);
+        if (l2pt != NULL) { vpa_push(newvas->l2tables, l2pt); }
+    }
+
     return newvas;
 }
 
@@ -31,6 +48,7 @@ void switch_to_vas(struct vas2 * vas) {
 }
 
 void free_vas(struct vas2 * vas) {
+    page_age_unregister(vas);
     vpa_free(vas->l2tables, (FreeFunc)pmm_free_l2_pagetable);
     vpa_free(vas->pages, (FreeFunc)pmm_free_page);
     pmm_free_l1_pagetable(vas->l1PageTable);
@@ -50,4 +68,5 @@ void allocate_page(struct vas2 * vas, size_t address, bool executable) {
     if (l2pt != NULL) { vpa_push(vas->l2tables, l2pt); }
 
     vpa_push(vas->pages, page);
+    page_age_track(vas, address & ~(PAGE_SIZE - 1));
 }
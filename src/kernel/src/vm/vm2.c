@@ -77,6 +77,12 @@ void vm2_flush_caches() {
                  "mcr p15, 0, %0, c7, c14, 0\n" ::"r"(0x0));
 }
 
+void vm2_flush_tlb_entry(size_t virtual, uint8_t asid) {
+    DATA_SYNC_BARRIER()
+    // Invalidate TLB entry by MVA (and ASID)
+    asm volatile("mcr p15, 0, %0, c8, c7, 1" ::"r"((virtual & ~0xfffu) | asid));
+}
+
 // http://infocenter.arm.com/help/topic/com.arm.doc.ddi0301h/DDI0301H_arm1176jzfs_r0p7_trm.pdf#page=219
 void vm2_flush_caches_of_ASID(uint8_t id) {
     asm volatile("mcr p15, 0, %0, c8, c7, 2"  // Invalidate TLB Entry on ASID Match
@@ -85,7 +91,9 @@ void vm2_flush_caches_of_ASID(uint8_t id) {
 
 void vm2_set_user_pagetable(struct L1PageTable * l1) {
     // http://infocenter.arm.com/help/topic/com.arm.doc.ddi0301h/DDI0301H_arm1176jzfs_r0p7_trm.pdf#page=360
-    asm volatile("MCR p15, 0, %0, c2, c0, 0\n" ::"r"(l1));  // Set Translation base address 0
+    // The MMU wants the physical address of the pagetable.
+    size_t physical = l1 == NULL ? 0 : VIRT2PHYS(l1);
+    asm volatile("MCR p15, 0, %0, c2, c0, 0\n" ::"r"(physical));  // Set Translation base address 0
 }
 
 // Starts the actual MMU after this function we live in Virtual Memory
@@ -103,30 +111,32 @@ void vm2_start(size_t detected_size) {
 	  available_RAM = detected_size;
     }
 
+    // The linear map in the generated pagetable covers at most a gigabyte.
+    if (available_RAM > KERNEL_LINEAR_MAP_SIZE) { available_RAM = KERNEL_LINEAR_MAP_SIZE; }
+
     INFO("Using memory size 0x%x", available_RAM);
 
-    /// Unmap the 1:1 mapped first megabyte which startup.s created to boot to a higher half kernel.
-    /// We don't need it anymore!
+    /// Unmap the 1:1 mapped first megabyte which startup.s booted from to get to a higher half
+    /// kernel. We don't need it anymore!
     kernell1PageTable->entries[0] = (L1PagetableEntry){0};
 
-    /// Map the entire gigabyte (or less on some boards, but never more) physical ram to virtual
-    /// 2GB-3GB. this includes the kernel, kernel stack, kernel pagetables, process pagetables, pmm
-    /// etc.
-    for (size_t i = 0; i < (size_t)available_RAM; i += Mebibyte) {
-        vm2_l1_map_physical_to_virtual(kernell1PageTable,
-                                       (union L1PagetableEntry){
-                                           .section.type = 2,
-                                           .section.accessPermissions = 1,
-                                           .section.base_address = l1pt_base_address(i),
-                                       },
-                                       KERNEL_VIRTUAL_OFFSET + i,
-                                       true);
+    /// The pagetable generated by boot_pagetable.s already maps a full gigabyte of physical ram to
+    /// virtual 2GB-3GB. this includes the kernel, kernel stack, kernel pagetables, process
+    /// pagetables, pmm etc. Only unmap the part that doesn't exist on this board.
+    for (size_t i = available_RAM; i < KERNEL_LINEAR_MAP_SIZE; i += Mebibyte) {
+        kernell1PageTable->entries[l1pt_index(KERNEL_VIRTUAL_OFFSET + i)] = (L1PagetableEntry){0};
     }
 
     pmm_init(KERNEL_PMM_BASE, KERNEL_VIRTUAL_OFFSET + detected_size);
 
     vm2_set_user_pagetable(NULL);
 
+    // Enable the access flag (SCTLR.AFE). All kernel mappings have it set already.
+    asm volatile("mrc p15, 0, r1, c1, c0, 0\n"
+                 "orr r1, %0\n"
+                 "mcr p15, 0, r1, c1, c0, 0\n" ::"r"(1u << 29u)
+                 : "r1");
+
     vm2_flush_caches();
 
     mmu_started = true;
@@ -153,11 +163,70 @@ void vm2_free_page(struct L1PageTable * l1pt, size_t virtual) {
     }
 }
 
+union L2PagetableEntry * vm2_get_l2_entry(struct L1PageTable * l1pt, size_t virtual) {
+    L1PagetableEntry * l1Entry = &l1pt->entries[l1pt_index(virtual)];
+    if (l1Entry->coarse.type != 1) { return NULL; }
+
+    return &find_l2pt(l1Entry)->entries[l2pt_index(virtual)];
+}
+
+bool vm2_handle_access_flag_fault(size_t virtual) {
+    struct L1PageTable * l1pt = kernell1PageTable;
+
+    if (virtual < KERNEL_VIRTUAL_OFFSET) {
+        // Read Translation Table Base Register 0, the pagetable of the current process
+        size_t ttbr0;
+        asm volatile("mrc p15, 0, %0, c2, c0, 0" : "=r"(ttbr0));
+        ttbr0 &= ~0x1fffu;
+        if (ttbr0 == 0) { return false; }
+
+        l1pt = (struct L1PageTable *)PHYS2VIRT(ttbr0);
+    }
+
+    L1PagetableEntry * l1Entry = &l1pt->entries[l1pt_index(virtual)];
+
+    switch (l1Entry->section.type) {
+        case 1: {
+            union L2PagetableEntry * l2Entry = &find_l2pt(l1Entry)->entries[l2pt_index(virtual)];
+            if (l2Entry->entry == 0) { return false; }
+            l2Entry->entry |= L2_ACCESS_FLAG;
+            break;
+        }
+        case 2:
+            l1Entry->entry |= L1_SECTION_ACCESS_FLAG;
+            break;
+        default:
+            return false;
+    }
+
+    // Entries that cause access flag faults are never put in the TLB, but make sure the walk sees
+    // the new entry.
+    DATA_SYNC_BARRIER()
+
+    return true;
+}
+
 void * vm2_allocate_page(struct L1PageTable * l1pt,
                          size_t virtual,
                          bool remap,
                          struct PagePermission perms,
                          struct L2PageTable ** created_l2pt) {
+    struct Page * page = pmm_allocate_page();
+
+    if (!vm2_map_page(l1pt, virtual, page, remap, perms, created_l2pt)) {
+        pmm_free_page(page);
+        return NULL;
+    }
+
+    return page;
+}
+
+bool vm2_map_page(struct L1PageTable * l1pt,
+                  size_t virtual,
+                  struct Page * page,
+                  bool remap,
+                  struct PagePermission perms,
+                  struct L2PageTable ** created_l2pt) {
     L1PagetableEntry * l1Entry = &l1pt->entries[l1pt_index(virtual)];
     struct L2PageTable * l2 = NULL;
 
@@ -178,7 +247,6 @@ void * vm2_allocate_page(struct L1PageTable * l1pt,
 
             /** Fallthrough **/
         case 1:;
-            struct Page * page = pmm_allocate_page();
             // There already is a coarse pagetable
             if (l2 == NULL) { l2 = find_l2pt(l1Entry); }
             union L2PagetableEntry * l2Entry = &l2->entries[l2pt_index(virtual)];
@@ -189,7 +257,8 @@ void * vm2_allocate_page(struct L1PageTable * l1pt,
                 TRACE("[MEM DEBUG] Remapping l2 page located at 0x%x", virtual);
             }
 
-            // Set up perms correctly
+            // Set up perms correctly. Bit 0 of accessPerms is the access flag, new pages start out
+            // as accessed.
             int accessPerms = 0;
             int accessExtended = 0;
             bool global = false;
@@ -206,8 +275,8 @@ void * vm2_allocate_page(struct L1PageTable * l1pt,
                     global = true;
                     break;
                 case UserRO:
-                    accessPerms = 0b10;
-                    accessExtended = 0;
+                    accessPerms = 0b11;
+                    accessExtended = 1;
                     global = false;
                     break;
                 case UserRW:
@@ -238,11 +307,11 @@ void * vm2_allocate_page(struct L1PageTable * l1pt,
             // make sure that if we didn't allocate a new pt, we set created_l2pt it to null
             if (created_l2pt != NULL && *created_l2pt != NULL) { *created_l2pt = NULL; }
 
-            return page;
+            return true;
         default:
             // This is a (super)section and we can't make it a coarse pagetable. Error.
             WARN("[MEM DEBUG] L1 Entry is a section or super section, can't map a page there");
-            return NULL;
+            return false;
     }
 }
 